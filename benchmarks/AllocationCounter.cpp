@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<std::size_t> allocationCount = 0;
+static std::atomic<std::size_t> allocatedBytes = 0;
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    // malloc(0) may return nullptr, while operator new must return a unique pointer.
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+AllocationCount getAllocationCount() {
+    return {allocationCount.load(std::memory_order_relaxed), allocatedBytes.load(std::memory_order_relaxed)};
+}
+
+void reportAllocations(benchmark::State& state, AllocationCount start) {
+    AllocationCount end = getAllocationCount();
+    state.counters["allocations"] = benchmark::Counter(
+        static_cast<double>(end.allocations - start.allocations),
+        benchmark::Counter::kAvgIterations
+    );
+    state.counters["allocated_bytes"] =
+        benchmark::Counter(static_cast<double>(end.bytes - start.bytes), benchmark::Counter::kAvgIterations);
+}
@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+
+/// Counts the allocations made with the global operator new, which is replaced in AllocationCounter.cpp for the whole
+/// benchmarks executable.
+struct AllocationCount {
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+};
+
+AllocationCount getAllocationCount();
+
+/// Reports the allocations made since `start` as the "allocations" and "allocated_bytes" counters, per iteration.
+void reportAllocations(benchmark::State& state, AllocationCount start);
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include <benchmark/benchmark.h>
+
+#include <boost/json.hpp>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Fixtures.h"
+#include "RedemptionTrace.h"
+#include "RewardRegistry.h"
+#include "TwitchRewardsApi.h"
+
+namespace json = boost::json;
+
+/// The frames of a recorded EventSub session, serialized like Twitch sends them.
+static std::vector<std::string> readEventsubFrames() {
+    std::vector<std::string> frames;
+    for (const json::value& frame : readJsonFixture("eventsub_frames.json").as_array()) {
+        frames.push_back(json::serialize(frame));
+    }
+    return frames;
+}
+
+/// What EventsubListener does for every frame that it reads: parsing the JSON, checking for a duplicate message,
+/// and turning a notification into the reward, the redemption id and the timestamp of a RewardRedemption.
+static void BM_EventsubFrameHandling(benchmark::State& state) {
+    std::vector<std::string> frames = readEventsubFrames();
+    std::size_t totalFrameSize = 0;
+    for (const std::string& frame : frames) {
+        totalFrameSize += frame.size();
+    }
+    RewardRegistry rewardRegistry;
+
+    for (auto _ : state) {
+        std::set<std::string> processedMessageIds;
+        for (const std::string& frame : frames) {
+            json::value message = json::parse(frame);
+            const json::value& metadata = message.at("metadata");
+            if (!processedMessageIds.insert(value_to<std::string>(metadata.at("message_id"))).second) {
+                continue;
+            }
+            if (metadata.at("message_type").as_string() != "notification") {
+                continue;
+            }
+            const json::value& event = message.at("payload").at("event");
+            std::shared_ptr<const Reward> reward =
+                rewardRegistry.internEventsubReward(TwitchRewardsApi::parseEventsubReward(event.at("reward")));
+            std::string redemptionId = value_to<std::string>(event.at("id"));
+            auto timestamp = RedemptionTrace::parseTimestamp(std::string(metadata.at("message_timestamp").as_string()));
+            benchmark::DoNotOptimize(reward);
+            benchmark::DoNotOptimize(redemptionId);
+            benchmark::DoNotOptimize(timestamp);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * frames.size());
+    state.SetBytesProcessed(state.iterations() * totalFrameSize);
+}
+BENCHMARK(BM_EventsubFrameHandling);
+
+static void BM_EventsubFrameJsonParse(benchmark::State& state) {
+    std::vector<std::string> frames = readEventsubFrames();
+    for (auto _ : state) {
+        for (const std::string& frame : frames) {
+            json::value message = json::parse(frame);
+            benchmark::DoNotOptimize(message);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * frames.size());
+}
+BENCHMARK(BM_EventsubFrameJsonParse);
+
+static void BM_RedemptionTimestampParse(benchmark::State& state) {
+    std::string timestamp = "2026-03-14T19:07:21.171067130Z";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(RedemptionTrace::parseTimestamp(timestamp));
+    }
+}
+BENCHMARK(BM_RedemptionTimestampParse);
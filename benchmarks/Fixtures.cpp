@@ -0,0 +1,21 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "Fixtures.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+std::string readFixture(const std::string& name) {
+    std::string path = std::string(BENCHMARK_FIXTURES_DIR) + "/" + name;
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Could not open the fixture " + path);
+    }
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+boost::json::value readJsonFixture(const std::string& name) {
+    return boost::json::parse(readFixture(name));
+}
@@ -0,0 +1,11 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <boost/json.hpp>
+#include <string>
+
+/// Reads a file from benchmarks/fixtures. The fixtures are payloads in the format that Twitch sends.
+std::string readFixture(const std::string& name);
+boost::json::value readJsonFixture(const std::string& name);
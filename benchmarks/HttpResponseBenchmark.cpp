@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include <benchmark/benchmark.h>
+
+#include <boost/json.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "AllocationCounter.h"
+#include "BoostAsio.h"
+#include "Fixtures.h"
+#include "JsonResponseBodyReader.h"
+
+namespace asio = boost::asio;
+namespace http = boost::beast::http;
+namespace json = boost::json;
+
+// These compare the allocations of reading a Helix response the way HttpClient used to (buffering the body in a
+// dynamic_body, copying it into a string and parsing it) with JsonResponseBodyReader, which HttpClient uses now.
+// The response is fed to the HTTP parser from memory, so only the parsing is measured, not the network.
+
+/// A custom rewards response with `rewardCount` rewards (Twitch allows up to 50), as HTTP/1.1 with Content-Length.
+static std::string makeRewardsResponse(std::int64_t rewardCount) {
+    json::value fixture = readJsonFixture("custom_rewards.json");
+    const json::array& fixtureRewards = fixture.at("data").as_array();
+    json::array rewards;
+    for (std::size_t i = 0; i < static_cast<std::size_t>(rewardCount); i++) {
+        rewards.push_back(fixtureRewards[i % fixtureRewards.size()]);
+    }
+    std::string body = json::serialize(json::object{{"data", std::move(rewards)}});
+    return "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+           "\r\n\r\n" + body;
+}
+
+/// Gives the parser as much of `input` as it takes, like http::read does with the bytes received from the socket.
+template <typename Parser>
+static void putInput(Parser& parser, std::string_view& input) {
+    boost::system::error_code errorCode;
+    std::size_t consumed = parser.put(asio::buffer(input.data(), input.size()), errorCode);
+    if (errorCode && errorCode != http::error::need_buffer) {
+        throw boost::system::system_error(errorCode);
+    }
+    input.remove_prefix(consumed);
+}
+
+static void BM_ReadJsonResponseBuffered(benchmark::State& state) {
+    std::string response = makeRewardsResponse(state.range(0));
+    AllocationCount start = getAllocationCount();
+    for (auto _ : state) {
+        std::string_view input = response;
+        http::response_parser<http::dynamic_body> parser;
+        parser.eager(true);
+        while (!parser.is_done()) {
+            putInput(parser, input);
+        }
+        std::string body = boost::beast::buffers_to_string(parser.get().body().data());
+        json::value responseJson = json::parse(body);
+        benchmark::DoNotOptimize(responseJson);
+    }
+    reportAllocations(state, start);
+    state.SetBytesProcessed(state.iterations() * response.size());
+}
+BENCHMARK(BM_ReadJsonResponseBuffered)->Arg(4)->Arg(50);
+
+static void BM_ReadJsonResponseStreaming(benchmark::State& state) {
+    std::string response = makeRewardsResponse(state.range(0));
+    AllocationCount start = getAllocationCount();
+    for (auto _ : state) {
+        std::string_view input = response;
+        JsonResponseBodyReader::Parser parser;
+        parser.eager(true);
+        while (!parser.is_header_done()) {
+            putInput(parser, input);
+        }
+        JsonResponseBodyReader bodyReader(parser, false);
+        while (!parser.is_done()) {
+            bodyReader.prepareChunk();
+            putInput(parser, input);
+            bodyReader.consumeChunk();
+        }
+        json::value responseJson = bodyReader.releaseJson();
+        benchmark::DoNotOptimize(responseJson);
+    }
+    reportAllocations(state, start);
+    state.SetBytesProcessed(state.iterations() * response.size());
+}
+BENCHMARK(BM_ReadJsonResponseStreaming)->Arg(4)->Arg(50);
+
+/// Like BM_ReadJsonResponseStreaming, with the JSON allocated from a caller-supplied memory resource.
+static void BM_ReadJsonResponseStreamingMonotonic(benchmark::State& state) {
+    std::string response = makeRewardsResponse(state.range(0));
+    AllocationCount start = getAllocationCount();
+    for (auto _ : state) {
+        std::string_view input = response;
+        JsonResponseBodyReader::Parser parser;
+        parser.eager(true);
+        while (!parser.is_header_done()) {
+            putInput(parser, input);
+        }
+        json::monotonic_resource memoryResource;
+        JsonResponseBodyReader bodyReader(parser, false, &memoryResource);
+        while (!parser.is_done()) {
+            bodyReader.prepareChunk();
+            putInput(parser, input);
+            bodyReader.consumeChunk();
+        }
+        json::value responseJson = bodyReader.releaseJson();
+        benchmark::DoNotOptimize(responseJson);
+    }
+    reportAllocations(state, start);
+    state.SetBytesProcessed(state.iterations() * response.size());
+}
+BENCHMARK(BM_ReadJsonResponseStreamingMonotonic)->Arg(4)->Arg(50);
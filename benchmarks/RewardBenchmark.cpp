@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include <benchmark/benchmark.h>
+
+#include <boost/json.hpp>
+#include <string>
+#include <vector>
+
+#include "Fixtures.h"
+#include "Reward.h"
+#include "TwitchRewardsApi.h"
+
+namespace json = boost::json;
+
+static void BM_ParseReward(benchmark::State& state) {
+    json::value response = readJsonFixture("custom_rewards.json");
+    const json::array& rewards = response.at("data").as_array();
+    for (auto _ : state) {
+        for (const json::value& reward : rewards) {
+            benchmark::DoNotOptimize(TwitchRewardsApi::parseReward(reward, true));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * rewards.size());
+}
+BENCHMARK(BM_ParseReward);
+
+/// Parsing the whole custom rewards response, as it's received when the rewards are reloaded.
+static void BM_ParseRewardsResponse(benchmark::State& state) {
+    std::string response = readFixture("custom_rewards.json");
+    for (auto _ : state) {
+        json::value responseJson = json::parse(response);
+        std::vector<Reward> rewards;
+        for (const json::value& reward : responseJson.at("data").as_array()) {
+            rewards.push_back(TwitchRewardsApi::parseReward(reward, true));
+        }
+        benchmark::DoNotOptimize(rewards);
+    }
+    state.SetBytesProcessed(state.iterations() * response.size());
+}
+BENCHMARK(BM_ParseRewardsResponse);
+
+static void BM_ParseEventsubReward(benchmark::State& state) {
+    json::value frames = readJsonFixture("eventsub_frames.json");
+    json::value reward = frames.as_array().at(1).at("payload").at("event").at("reward");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(TwitchRewardsApi::parseEventsubReward(reward));
+    }
+}
+BENCHMARK(BM_ParseEventsubReward);
+
+static void BM_ColorParse(benchmark::State& state) {
+    std::string hexColor = "#9147FF";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Color(hexColor));
+    }
+}
+BENCHMARK(BM_ColorParse);
+
+static void BM_ColorFormat(benchmark::State& state) {
+    Color color(0x91, 0x47, 0xff);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(color.toHex());
+    }
+}
+BENCHMARK(BM_ColorFormat);
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AllocationCounter.h"
+#include "RewardRedemptionQueueFixture.h"
+
+using namespace std::chrono_literals;
+
+/// How many redemptions a thread keeps in the queue before it cancels the oldest one.
+static constexpr std::size_t QUEUED_REDEMPTIONS_PER_THREAD = 64;
+
+/// Redemption ids are UUIDs, like on Twitch, so that they don't fit into the small string buffer.
+static std::string makeRedemptionId(std::size_t number) {
+    return fmt::format("00000000-0000-0000-0000-{:012}", number);
+}
+
+/// A reward with a title, a description and an image, like most of the rewards on Twitch.
+static Reward makeReward() {
+    return Reward(
+        "92af127c-7326-4483-a52b-b0da0be61c01",
+        "Play a meme",
+        "Plays a random meme from the streamer's collection on the stream",
+        500,
+        boost::urls::url("https://static-cdn.jtvnw.net/custom-reward-images/default-4.png"),
+        true,
+        Color(0x91, 0x47, 0xff),
+        std::nullopt,
+        std::nullopt,
+        std::nullopt,
+        true
+    );
+}
+
+/// The queue with one reward that all the redemptions share. Shared by the threads of a benchmark.
+struct QueueFixture : RewardRedemptionQueueFixture {
+    QueueFixture() : reward(std::make_shared<Reward>(makeReward())) {
+        // Short videos without a pause between them, so that the queue is also popped while the benchmark runs.
+        obsApi.addMediaSource("Video", 1ms);
+        obsApi.addMediaSource("LongVideo", 1h);
+        settings.setObsSourceName(reward->id, "Video");
+        settings.setIntervalBetweenRewardsSeconds(0);
+    }
+
+    RewardRedemption makeRewardRedemption(std::size_t number) const {
+        return RewardRedemptionQueueFixture::makeRewardRedemption(reward, makeRedemptionId(number));
+    }
+
+    std::shared_ptr<const Reward> reward;
+};
+
+static std::unique_ptr<QueueFixture> queueFixture;
+
+static void setUpQueueFixture(const benchmark::State&) {
+    queueFixture = std::make_unique<QueueFixture>();
+}
+
+static void tearDownQueueFixture(const benchmark::State&) {
+    queueFixture.reset();
+}
+
+/// Fills the queue with state.range(0) redemptions. The first one plays a long video, so the rest stay in the queue.
+static void setUpFullQueueFixture(const benchmark::State& state) {
+    setUpQueueFixture(state);
+    queueFixture->settings.setObsSourceName(queueFixture->reward->id, "LongVideo");
+    auto queueSize = static_cast<std::size_t>(state.range(0));
+    for (std::size_t i = 0; i <= queueSize; i++) {
+        queueFixture->rewardRedemptionQueue.queueRewardRedemption(queueFixture->makeRewardRedemption(i));
+    }
+    while (queueFixture->rewardRedemptionQueue.getRewardRedemptionQueue().size() < queueSize) {
+        std::this_thread::sleep_for(1ms);
+    }
+}
+
+/// Every thread queues redemptions, like EventSub does, and cancels them, like the streamer does from the UI, while
+/// the queue plays and pops the redemptions on its own thread.
+static void BM_QueueEnqueueAndCancel(benchmark::State& state) {
+    RewardRedemptionQueue& rewardRedemptionQueue = queueFixture->rewardRedemptionQueue;
+    std::deque<RewardRedemption> queuedRedemptions;
+    std::size_t redemptionNumber = 0;
+    for (auto _ : state) {
+        RewardRedemption rewardRedemption = RewardRedemptionQueueFixture::makeRewardRedemption(
+            queueFixture->reward,
+            std::to_string(state.thread_index()) + "-" + std::to_string(redemptionNumber++)
+        );
+        rewardRedemptionQueue.queueRewardRedemption(rewardRedemption);
+        queuedRedemptions.push_back(std::move(rewardRedemption));
+        if (queuedRedemptions.size() > QUEUED_REDEMPTIONS_PER_THREAD) {
+            rewardRedemptionQueue.removeRewardRedemption(queuedRedemptions.front());
+            queuedRedemptions.pop_front();
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QueueEnqueueAndCancel)
+    ->Setup(setUpQueueFixture)
+    ->Teardown(tearDownQueueFixture)
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+    ->UseRealTime();
+
+// The copies of the whole queue that are made on every queue update: for the signal, and for the widgets. The
+// allocated bytes of a copy are about the memory that the queue itself takes.
+
+static void BM_QueueSnapshot(benchmark::State& state) {
+    RewardRedemptionQueue& rewardRedemptionQueue = queueFixture->rewardRedemptionQueue;
+    AllocationCount start = getAllocationCount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rewardRedemptionQueue.getRewardRedemptionQueue());
+    }
+    reportAllocations(state, start);
+    // All the redemptions share one Reward, so this is the number of the redemptions plus the fixture's reference.
+    state.counters["reward_references"] = static_cast<double>(queueFixture->reward.use_count());
+}
+BENCHMARK(BM_QueueSnapshot)->Setup(setUpFullQueueFixture)->Teardown(tearDownQueueFixture)->Arg(500);
+
+/// A redemption the way it was before RewardRegistry, with its own copy of the reward, for comparison.
+struct RewardRedemptionWithRewardCopy {
+    Reward reward;
+    std::string redemptionId;
+    std::shared_ptr<RedemptionTrace> trace;
+    std::chrono::steady_clock::time_point receivedAt;
+};
+
+static void BM_QueueSnapshotWithRewardCopies(benchmark::State& state) {
+    Reward reward = makeReward();
+    std::vector<RewardRedemptionWithRewardCopy> rewardRedemptionQueue;
+    for (std::int64_t i = 0; i < state.range(0); i++) {
+        rewardRedemptionQueue.push_back(
+            {reward, makeRedemptionId(static_cast<std::size_t>(i)), nullptr, std::chrono::steady_clock::now()}
+        );
+    }
+    AllocationCount start = getAllocationCount();
+    for (auto _ : state) {
+        std::vector<RewardRedemptionWithRewardCopy> snapshot = rewardRedemptionQueue;
+        benchmark::DoNotOptimize(snapshot);
+    }
+    reportAllocations(state, start);
+}
+BENCHMARK(BM_QueueSnapshotWithRewardCopies)->Arg(500);
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "FakeObsApi.h"
+#include "Settings.h"
+
+// The config is stored in memory by FakeObsApi, so these measure Settings itself rather than the OBS config.
+
+static void BM_SettingsGetObsSourceName(benchmark::State& state) {
+    FakeObsApi obsApi;
+    Settings settings(obsApi);
+    settings.setObsSourceName("92af127c-7326-4483-a52b-b0da0be61c01", "Meme");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(settings.getObsSourceName("92af127c-7326-4483-a52b-b0da0be61c01"));
+    }
+}
+BENCHMARK(BM_SettingsGetObsSourceName);
+
+/// A reward without any settings, which falls back to the defaults.
+static void BM_SettingsGetSourcePlaybackSettingsDefault(benchmark::State& state) {
+    FakeObsApi obsApi;
+    Settings settings(obsApi);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(settings.getSourcePlaybackSettings("92af127c-7326-4483-a52b-b0da0be61c01"));
+    }
+}
+BENCHMARK(BM_SettingsGetSourcePlaybackSettingsDefault);
+
+static void BM_SettingsGetGlobalSettings(benchmark::State& state) {
+    FakeObsApi obsApi;
+    Settings settings(obsApi);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(settings.isRewardRedemptionQueueEnabled());
+        benchmark::DoNotOptimize(settings.getIntervalBetweenRewardsSeconds());
+        benchmark::DoNotOptimize(settings.getMaxSourceInstances());
+    }
+}
+BENCHMARK(BM_SettingsGetGlobalSettings);
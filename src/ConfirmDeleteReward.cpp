@@ -33,7 +33,7 @@ void ConfirmDeleteReward::showConfirmDeleteMessageBox() {
 
 void ConfirmDeleteReward::deleteRewardIfYesClicked(QAbstractButton* buttonClicked) {
     if (errorMessageBox && errorMessageBox->standardButton(buttonClicked) == QMessageBox::Yes) {
-        twitchRewardsApi.deleteReward(reward, this, "showDeleteRewardResult");
+        twitchRewardsApi.deleteReward(reward, {this, &ConfirmDeleteReward::showDeleteRewardResult});
     }
 }
 
@@ -7,6 +7,8 @@
 #include <obs-frontend-api.h>
 #include <obs-module.h>
 
+#include <QDir>
+#include <QFileDialog>
 #include <QPalette>
 #include <QPixmap>
 #include <algorithm>
@@ -71,6 +73,13 @@ EditRewardDialog::EditRewardDialog(
         this,
         &EditRewardDialog::showLoopVideoNotSupportedErrorIfNeeded
     );
+    connect(ui->chooseMediaDirectoryButton, &QPushButton::clicked, this, &EditRewardDialog::chooseMediaDirectory);
+    connect(
+        ui->mediaDirectoryEdit,
+        &QLineEdit::editingFinished,
+        this,
+        &EditRewardDialog::showMediaDirectoryNotSupportedErrorIfNeeded
+    );
     connect(&twitchAuth, &TwitchAuth::onUsernameChanged, this, &EditRewardDialog::showUploadCustomIconLabel);
 }
 
@@ -113,10 +122,10 @@ void EditRewardDialog::showColorDialog() {
 void EditRewardDialog::saveReward() {
     RewardData rewardData = getRewardData();
     if (!originalReward.has_value()) {
-        twitchRewardsApi.createReward(rewardData, this, "showSaveRewardResult");
+        twitchRewardsApi.createReward(rewardData, {this, &EditRewardDialog::showSaveRewardResult});
     } else if (rewardData != static_cast<const RewardData&>(originalReward.value())) {
         Reward newReward(originalReward.value(), rewardData);
-        twitchRewardsApi.updateReward(newReward, this, "showSaveRewardResult");
+        twitchRewardsApi.updateReward(newReward, {this, &EditRewardDialog::showSaveRewardResult});
     } else {
         saveLocalRewardSettings(originalReward.value().id);
         close();
@@ -156,7 +165,7 @@ void EditRewardDialog::showSaveRewardResult(std::variant<std::exception_ptr, Rew
 }
 
 void EditRewardDialog::updateObsSourceComboBox() {
-    std::vector<std::string> obsSources = RewardRedemptionQueue::enumObsSources();
+    std::vector<std::string> obsSources = rewardRedemptionQueue.enumObsSources();
     QString oldObsSource = ui->obsSourceComboBox->currentData().toString();
 
     ui->obsSourceComboBox->clear();
@@ -178,7 +187,7 @@ void EditRewardDialog::testObsSource() {
     if (!obsSourceName.has_value()) {
         return;
     }
-    if (showLoopVideoNotSupportedErrorIfNeeded()) {
+    if (showLoopVideoNotSupportedErrorIfNeeded() || showMediaDirectoryNotSupportedErrorIfNeeded()) {
         return;
     }
 
@@ -189,7 +198,10 @@ void EditRewardDialog::testObsSource() {
         rewardId = "new";
     }
     rewardRedemptionQueue.testObsSource(
-        rewardId, obsSourceName.value(), getSourcePlaybackSettings(), this, "showTestObsSourceException"
+        rewardId,
+        obsSourceName.value(),
+        getSourcePlaybackSettings(),
+        {this, &EditRewardDialog::showTestObsSourceException}
     );
 }
 
@@ -233,6 +245,28 @@ bool EditRewardDialog::showLoopVideoNotSupportedErrorIfNeeded() {
     return true;
 }
 
+void EditRewardDialog::chooseMediaDirectory() {
+    QString mediaDirectory =
+        QFileDialog::getExistingDirectory(this, obs_module_text("ChooseFolder"), ui->mediaDirectoryEdit->text());
+    if (mediaDirectory.isEmpty()) {
+        return;
+    }
+    ui->mediaDirectoryEdit->setText(QDir::toNativeSeparators(mediaDirectory));
+    showMediaDirectoryNotSupportedErrorIfNeeded();
+}
+
+bool EditRewardDialog::showMediaDirectoryNotSupportedErrorIfNeeded() {
+    std::optional<std::string> obsSourceName = getObsSourceName();
+    if (!getMediaDirectory().has_value() || !obsSourceName.has_value()) {
+        return false;
+    }
+    if (rewardRedemptionQueue.sourceSupportsMediaDirectory(obsSourceName.value())) {
+        return false;
+    }
+    errorMessageBox->show(obs_module_text("VideoFolderRequiresMediaSource"));
+    return true;
+}
+
 void EditRewardDialog::showReward(const Reward& reward) {
     ui->enabledCheckBox->setChecked(reward.isEnabled);
     ui->titleEdit->setText(QString::fromStdString(reward.title));
@@ -242,6 +276,10 @@ void EditRewardDialog::showReward(const Reward& reward) {
     ui->randomPositionEnabledCheckBox->setChecked(settings.isRandomPositionEnabled(reward.id));
     ui->loopVideoEnabledCheckBox->setChecked(settings.isLoopVideoEnabled(reward.id));
     ui->loopVideoDurationSpinBox->setValue(settings.getLoopVideoDurationSeconds(reward.id));
+    ui->mediaDirectoryEdit->setText(QString::fromStdString(settings.getMediaDirectory(reward.id).value_or("")));
+    std::optional<double> maxPlayTimeUnderLoadSeconds = settings.getMaxPlayTimeUnderLoadSeconds(reward.id);
+    ui->maxPlayTimeUnderLoadCheckBox->setChecked(maxPlayTimeUnderLoadSeconds.has_value());
+    ui->maxPlayTimeUnderLoadSpinBox->setValue(maxPlayTimeUnderLoadSeconds.value_or(5));
     ui->limitRedemptionsPerStreamCheckBox->setChecked(reward.maxRedemptionsPerStream.has_value());
     ui->limitRedemptionsPerStreamSpinBox->setValue(reward.maxRedemptionsPerStream.value_or(1));
     ui->limitRedemptionsPerUserPerStreamCheckBox->setChecked(reward.maxRedemptionsPerUserPerStream.has_value());
@@ -396,12 +434,30 @@ std::optional<std::int64_t> EditRewardDialog::getOptionalSetting(QCheckBox* chec
 void EditRewardDialog::saveLocalRewardSettings(const std::string& rewardId) {
     settings.setObsSourceName(rewardId, getObsSourceName());
     settings.setSourcePlaybackSettings(rewardId, getSourcePlaybackSettings());
+    rewardRedemptionQueue.probeMediaInBackground(rewardId);
 }
 
 SourcePlaybackSettings EditRewardDialog::getSourcePlaybackSettings() {
     return {
         ui->randomPositionEnabledCheckBox->isChecked(),
         ui->loopVideoEnabledCheckBox->isChecked(),
-        ui->loopVideoDurationSpinBox->value()
+        ui->loopVideoDurationSpinBox->value(),
+        getMediaDirectory(),
+        getMaxPlayTimeUnderLoadSeconds()
     };
 }
+
+std::optional<std::string> EditRewardDialog::getMediaDirectory() {
+    QString mediaDirectory = ui->mediaDirectoryEdit->text().trimmed();
+    if (mediaDirectory.isEmpty()) {
+        return {};
+    }
+    return mediaDirectory.toStdString();
+}
+
+std::optional<double> EditRewardDialog::getMaxPlayTimeUnderLoadSeconds() {
+    if (!ui->maxPlayTimeUnderLoadCheckBox->isChecked()) {
+        return {};
+    }
+    return ui->maxPlayTimeUnderLoadSpinBox->value();
+}
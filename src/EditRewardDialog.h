@@ -57,6 +57,8 @@ private slots:
     void testObsSource();
     void showTestObsSourceException(std::exception_ptr exception);
     bool showLoopVideoNotSupportedErrorIfNeeded();
+    void chooseMediaDirectory();
+    bool showMediaDirectoryNotSupportedErrorIfNeeded();
 
 private:
     void showReward(const Reward& reward);
@@ -72,6 +74,8 @@ private:
     bool shouldUseWhiteIcons();
     void setObsSourceName(const std::optional<std::string>& obsSourceName);
     std::optional<std::string> getObsSourceName();
+    std::optional<std::string> getMediaDirectory();
+    std::optional<double> getMaxPlayTimeUnderLoadSeconds();
 
     RewardData getRewardData();
     std::optional<std::int64_t> getOptionalSetting(QCheckBox* checkBox, QSpinBox* spinBox);
@@ -5,6 +5,9 @@
 
 #include <fmt/core.h>
 
+#include <cstdlib>
+#include <string>
+
 #include "ConditionVariable.h"
 #include "Log.h"
 #include "TwitchRewardsApi.h"
@@ -21,27 +24,53 @@ using namespace std::chrono_literals;
 
 static constexpr auto INITIAL_KEEPALIVE_TIMEOUT = 30s;
 static constexpr auto RECONNECT_DELAY = 10s;
+static constexpr auto SUBSCRIBE_TIMEOUT = 10s;
 static const char* const CHANNEL_POINTS_SUBSCRIPTION_TYPE = "channel.channel_points_custom_reward_redemption.add";
 
 EventsubListener::EventsubListener(
     TwitchAuth& twitchAuth,
     HttpClient& httpClient,
-    RewardRedemptionQueue& rewardRedemptionQueue
+    RewardRedemptionQueue& rewardRedemptionQueue,
+    RewardRegistry& rewardRegistry,
+    RedemptionTracer& redemptionTracer,
+    PluginMetrics& pluginMetrics,
+    IoThreadPool::Strand executor
 )
-    : twitchAuth(twitchAuth), httpClient(httpClient), rewardRedemptionQueue(rewardRedemptionQueue), eventsubThread(1),
-      eventsubUrl("wss://eventsub.wss.twitch.tv/ws"), processedMessageIds{}, sessionId{},
-      keepaliveTimeoutTimer(eventsubThread.ioContext), keepaliveTimeout(INITIAL_KEEPALIVE_TIMEOUT),
-      usernameCondVar(eventsubThread.ioContext, POS_INFINITY) {
+    : twitchAuth(twitchAuth), httpClient(httpClient), rewardRedemptionQueue(rewardRedemptionQueue),
+      rewardRegistry(rewardRegistry), redemptionTracer(redemptionTracer), pluginMetrics(pluginMetrics),
+      executor(executor), eventsubUrl("wss://eventsub.wss.twitch.tv/ws"), processedMessageIds{}, sessionId{},
+      keepaliveTimeoutTimer(executor), keepaliveTimeout(INITIAL_KEEPALIVE_TIMEOUT),
+      usernameCondVar(executor, POS_INFINITY) {
     connect(&twitchAuth, &TwitchAuth::onUsernameChanged, this, &EventsubListener::reconnectAfterUsernameChange);
-    asio::co_spawn(eventsubThread.ioContext, asyncReconnectToEventsubForever(), asio::detached);
+
+    if (std::optional<std::string> replayPath = getReplayPath()) {
+        const char* speedVariable = std::getenv("REWARDS_THEATER_EVENTSUB_REPLAY_SPEED");
+        double speed = speedVariable ? std::atof(speedVariable) : 1;
+        asio::co_spawn(executor, asyncReplayEventsub(replayPath.value(), speed), asio::detached);
+        return;
+    }
+    if (const char* recordPath = std::getenv("REWARDS_THEATER_EVENTSUB_RECORD")) {
+        try {
+            recorder = std::make_unique<EventsubRecorder>(recordPath);
+            log(LOG_WARNING, "Recording EventSub to {}", recordPath);
+        } catch (const std::exception& e) {
+            log(LOG_ERROR, "Could not start recording EventSub to {}: {}", recordPath, e.what());
+        }
+    }
+    asio::co_spawn(executor, asyncReconnectToEventsubForever(), asio::detached);
 }
 
-EventsubListener::~EventsubListener() {
-    eventsubThread.stop();
+EventsubListener::~EventsubListener() = default;
+
+std::optional<std::string> EventsubListener::getReplayPath() {
+    if (const char* replayPath = std::getenv("REWARDS_THEATER_EVENTSUB_REPLAY")) {
+        return replayPath;
+    }
+    return std::nullopt;
 }
 
 void EventsubListener::reconnectAfterUsernameChange() {
-    asio::post(eventsubThread.ioContext, [this] {
+    asio::post(executor, [this] {
         usernameCondVar.cancel();  // Equivalent to notify_all() for a condition variable.
     });
 }
@@ -80,13 +109,53 @@ asio::awaitable<void> EventsubListener::asyncReconnectToEventsubForever() {
                 "Exception in asyncReconnectToEventsubForever: {}",
                 getMultipleExceptionsMessage(std::current_exception()));
         }
+        pluginMetrics.onEventsubReconnect();
 
         if (twitchAuth.getUsername() != username) {
             // Disconnected because of a username change - reconnect immediately.
             continue;
         }
-        co_await asio::steady_timer(eventsubThread.ioContext, RECONNECT_DELAY).async_wait(asio::use_awaitable);
+        co_await asio::steady_timer(executor, RECONNECT_DELAY).async_wait(asio::use_awaitable);
+    }
+}
+
+asio::awaitable<void> EventsubListener::asyncReplayEventsub(std::string path, double speed) {
+    log(LOG_WARNING, "Replaying EventSub from {} at speed {}", path, speed);
+    std::size_t frameCount = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    try {
+        EventsubRecordingReader reader(path);
+        asio::steady_timer timer(executor);
+        while (std::optional<EventsubRecordingReader::Record> record = reader.readRecord()) {
+            if (speed > 0) {
+                timer.expires_at(
+                    startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(record->time / speed)
+                );
+                co_await timer.async_wait(asio::use_awaitable);
+            }
+            frameCount++;
+            lastMessageReceivedAt = std::chrono::steady_clock::now();
+            if (record->frame.empty()) {
+                continue;
+            }
+            // Skip a broken frame instead of stopping the whole replay.
+            try {
+                json::value message = json::parse(record->frame);
+                if (isDuplicateMessage(message)) {
+                    continue;
+                }
+                handleMessage(message);
+            } catch (const ReconnectException&) {
+                // There's no connection to replace during a replay.
+            } catch (const std::exception& e) {
+                log(LOG_ERROR, "Skipping EventSub frame {} of the replay: {}", frameCount, e.what());
+            }
+        }
+    } catch (const std::exception& e) {
+        log(LOG_ERROR, "Exception in asyncReplayEventsub: {}", e.what());
     }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+    log(LOG_INFO, "Replayed {} EventSub frames in {} ms", frameCount, elapsed.count());
 }
 
 std::string getMultipleExceptionsMessage(std::exception_ptr exceptionPointer) {
@@ -111,10 +180,11 @@ asio::awaitable<void> EventsubListener::asyncConnectToEventsub(const std::string
 
 asio::awaitable<EventsubListener::WebsocketStream> EventsubListener::asyncConnect() {
     ssl::context sslContext{ssl::context::tlsv12};
-    sslContext.set_default_verify_paths();
-    tcp::resolver resolver{eventsubThread.ioContext};
-    WebsocketStream ws{eventsubThread.ioContext, sslContext};
-    const auto resolveResults = co_await resolver.async_resolve(eventsubUrl.host(), "https", asio::use_awaitable);
+    httpClient.configureSslContext(sslContext);
+    tcp::resolver resolver{executor};
+    WebsocketStream ws{executor, sslContext};
+    auto [host, port] = httpClient.getHostAndPort(eventsubUrl.host());
+    const auto resolveResults = co_await resolver.async_resolve(host, port, asio::use_awaitable);
 
     co_await asio::async_connect(get_lowest_layer(ws), resolveResults, asio::use_awaitable);
     if (!SSL_set_tlsext_host_name(ws.next_layer().native_handle(), eventsubUrl.host().c_str())) {
@@ -192,59 +262,98 @@ asio::awaitable<void> EventsubListener::asyncSubscribeToChannelPoints() {
              {"session_id", sessionId},
          }}
     };
-    HttpClient::Response response = co_await httpClient.request(
-        "api.twitch.tv", "/helix/eventsub/subscriptions", twitchAuth, {}, http::verb::post, requestBody
+    // Twitch closes the connection if there's no subscription within 10 seconds after the welcome message anyway.
+    HttpRequestTimeouts timeouts{.total = SUBSCRIBE_TIMEOUT};
+    std::shared_ptr<const HttpClient::Response> response = co_await httpClient.request(
+        "api.twitch.tv",
+        "/helix/eventsub/subscriptions",
+        twitchAuth,
+        {},
+        http::verb::post,
+        requestBody,
+        HttpRequestPriority::HIGH,
+        timeouts
     );
-    if (response.status != http::status::accepted) {
-        log(LOG_ERROR, "HTTP status {} in asyncSubscribeToChannelPoints", static_cast<int>(response.status));
+    if (response->status != http::status::accepted) {
+        log(LOG_ERROR, "HTTP status {} in asyncSubscribeToChannelPoints", static_cast<int>(response->status));
         throw SubscribeToChannelPointsException();
     }
+    if (!isReady) {
+        isReady = true;
+        auto timeToReady = std::chrono::duration_cast<std::chrono::milliseconds>(pluginMetrics.getTimeSinceStart());
+        log(LOG_INFO, "Ready to receive redemptions {} ms after startup", timeToReady.count());
+    }
 }
 
 asio::awaitable<void> EventsubListener::asyncReadMessages(WebsocketStream& ws) {
     while (true) {
         json::value message = co_await asyncReadMessage(ws);
-        std::string type = getMessageType(message);
+        handleMessage(message);
+    }
+}
 
-        if (type == "notification") {
-            json::value payload = message.at("payload");
-            std::string subscriptionType = value_to<std::string>(payload.at("subscription").at("type"));
-            if (subscriptionType != CHANNEL_POINTS_SUBSCRIPTION_TYPE) {
-                continue;
-            }
-            json::value event = payload.at("event");
-            Reward reward = TwitchRewardsApi::parseEventsubReward(event.at("reward"));
-            std::string redemptionId = value_to<std::string>(event.at("id"));
-            rewardRedemptionQueue.queueRewardRedemption(RewardRedemption{reward, redemptionId});
-        } else if (type == "session_reconnect") {
-            throw ReconnectException();
+void EventsubListener::handleMessage(const json::value& message) {
+    std::string type = getMessageType(message);
+
+    if (type == "notification") {
+        const json::value& payload = message.at("payload");
+        std::string subscriptionType = value_to<std::string>(payload.at("subscription").at("type"));
+        if (subscriptionType != CHANNEL_POINTS_SUBSCRIPTION_TYPE) {
+            return;
         }
+        const json::value& event = payload.at("event");
+        std::shared_ptr<const Reward> reward =
+            rewardRegistry.internEventsubReward(TwitchRewardsApi::parseEventsubReward(event.at("reward")));
+        std::string redemptionId = value_to<std::string>(event.at("id"));
+        std::shared_ptr<RedemptionTrace> trace = redemptionTracer.startTrace(
+            redemptionId, reward->title, getMessageTimestamp(message), lastMessageReceivedAt
+        );
+        trace->stamp(RedemptionTrace::Stage::PARSED);
+        pluginMetrics.onRewardRedeemed(reward->id, reward->title);
+        rewardRedemptionQueue.queueRewardRedemption(
+            RewardRedemption{reward, redemptionId, trace, lastMessageReceivedAt}
+        );
+    } else if (type == "session_reconnect") {
+        throw ReconnectException();
     }
 }
 
 asio::awaitable<json::value> EventsubListener::asyncReadMessage(WebsocketStream& ws) {
     while (true) {
         json::value message = co_await asyncReadMessageIgnoringDuplicates(ws);
-        std::string messageId;
-        try {
-            messageId = value_to<std::string>(message.at("metadata").at("message_id"));
-        } catch (const boost::system::system_error&) {
-            log(LOG_ERROR, "Could not parse message_id");
-            co_return message;
-        }
-        // insert returns a pair of <iterator, whether insertion took place>
-        if (processedMessageIds.insert(messageId).second) {
+        if (!isDuplicateMessage(message)) {
             co_return message;
         }
         // Received a duplicate messsage, skip it and read the next one.
     }
 }
 
+bool EventsubListener::isDuplicateMessage(const json::value& message) {
+    std::string messageId;
+    try {
+        messageId = value_to<std::string>(message.at("metadata").at("message_id"));
+    } catch (const boost::system::system_error&) {
+        log(LOG_ERROR, "Could not parse message_id");
+        return false;
+    }
+    // insert returns a pair of <iterator, whether insertion took place>
+    return !processedMessageIds.insert(messageId).second;
+}
+
 asio::awaitable<json::value> EventsubListener::asyncReadMessageIgnoringDuplicates(WebsocketStream& ws) {
     std::string message;
     auto buffer = asio::dynamic_buffer(message);
     co_await ws.async_read(buffer, asio::use_awaitable);
+    lastMessageReceivedAt = std::chrono::steady_clock::now();
     resetKeepaliveTimeoutTimer();
+    if (recorder) {
+        try {
+            recorder->record(message);
+        } catch (const std::exception& e) {
+            log(LOG_ERROR, "Could not record an EventSub frame, stopping the recording: {}", e.what());
+            recorder.reset();
+        }
+    }
     if (message.empty()) {
         co_return json::value{};
     }
@@ -255,6 +364,14 @@ std::string EventsubListener::getMessageType(const boost::json::value& message)
     return value_to<std::string>(message.at("metadata").at("message_type"));
 }
 
+std::optional<std::chrono::system_clock::time_point> EventsubListener::getMessageTimestamp(const json::value& message) {
+    const json::value* timestamp = message.at("metadata").as_object().if_contains("message_timestamp");
+    if (!timestamp || !timestamp->is_string()) {
+        return std::nullopt;
+    }
+    return RedemptionTrace::parseTimestamp(std::string(timestamp->as_string()));
+}
+
 asio::awaitable<void> EventsubListener::asyncSendMessage(WebsocketStream& ws, const json::value& message) {
     std::string messageSerialized = json::serialize(message);
     co_await ws.async_write(asio::buffer(messageSerialized), asio::use_awaitable);
@@ -6,22 +6,45 @@
 #include <boost/json.hpp>
 #include <chrono>
 #include <exception>
+#include <memory>
+#include <optional>
 #include <set>
+#include <string>
 
 #include "BoostAsio.h"
+#include "EventsubRecording.h"
 #include "HttpClient.h"
 #include "IoThreadPool.h"
+#include "PluginMetrics.h"
+#include "RedemptionTracer.h"
 #include "RewardRedemptionQueue.h"
+#include "RewardRegistry.h"
 #include "TwitchAuth.h"
 
 /// Listens to channel points redemptions. Read https://dev.twitch.tv/docs/eventsub/ for API documentation.
+///
+/// To reproduce a problem, the raw frames can be recorded by setting REWARDS_THEATER_EVENTSUB_RECORD=/path/to/file.
+/// With REWARDS_THEATER_EVENTSUB_REPLAY=/path/to/file, the listener doesn't connect to Twitch and replays the recording
+/// instead, at the speed given by REWARDS_THEATER_EVENTSUB_REPLAY_SPEED (1 by default, 0 means as fast as possible).
+/// The queue mustn't send the statuses of the replayed redemptions to Twitch, see ReplayRedemptionStatusApi.
 class EventsubListener : public QObject {
     Q_OBJECT
 
 public:
-    EventsubListener(TwitchAuth& twitchAuth, HttpClient& httpClient, RewardRedemptionQueue& rewardRedemptionQueue);
+    EventsubListener(
+        TwitchAuth& twitchAuth,
+        HttpClient& httpClient,
+        RewardRedemptionQueue& rewardRedemptionQueue,
+        RewardRegistry& rewardRegistry,
+        RedemptionTracer& redemptionTracer,
+        PluginMetrics& pluginMetrics,
+        IoThreadPool::Strand executor
+    );
     ~EventsubListener();
 
+    /// The recording to replay instead of connecting to Twitch, if any.
+    static std::optional<std::string> getReplayPath();
+
 private slots:
     void reconnectAfterUsernameChange();
 
@@ -41,6 +64,7 @@ private:
     };
 
     boost::asio::awaitable<void> asyncReconnectToEventsubForever();
+    boost::asio::awaitable<void> asyncReplayEventsub(std::string path, double speed);
     boost::asio::awaitable<void> asyncConnectToEventsub(const std::string& username);
     boost::asio::awaitable<WebsocketStream> asyncConnect();
     boost::asio::awaitable<void> asyncSubscribeAndReadMessages(WebsocketStream& ws);
@@ -51,17 +75,27 @@ private:
     boost::asio::awaitable<void> asyncReadMessages(WebsocketStream& ws);
     boost::asio::awaitable<boost::json::value> asyncReadMessage(WebsocketStream& ws);
     boost::asio::awaitable<boost::json::value> asyncReadMessageIgnoringDuplicates(WebsocketStream& ws);
+    bool isDuplicateMessage(const boost::json::value& message);
+    void handleMessage(const boost::json::value& message);
     static std::string getMessageType(const boost::json::value& message);
+    static std::optional<std::chrono::system_clock::time_point> getMessageTimestamp(const boost::json::value& message);
     static boost::asio::awaitable<void> asyncSendMessage(WebsocketStream& ws, const boost::json::value& message);
 
     TwitchAuth& twitchAuth;
     HttpClient& httpClient;
     RewardRedemptionQueue& rewardRedemptionQueue;
-    IoThreadPool eventsubThread;
+    RewardRegistry& rewardRegistry;
+    RedemptionTracer& redemptionTracer;
+    PluginMetrics& pluginMetrics;
+    IoThreadPool::Strand executor;
     const boost::urls::url eventsubUrl;
     std::set<std::string> processedMessageIds;
     std::string sessionId;
     boost::asio::steady_timer keepaliveTimeoutTimer;
     std::chrono::seconds keepaliveTimeout;
+    std::chrono::steady_clock::time_point lastMessageReceivedAt;
+    std::unique_ptr<EventsubRecorder> recorder;
+    /// Whether the plugin has subscribed to redemptions at least once.
+    bool isReady = false;
     boost::asio::steady_timer usernameCondVar;
 };
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "EventsubRecording.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+static constexpr std::size_t MAGIC_LENGTH = sizeof(EVENTSUB_RECORDING_MAGIC) - 1;
+
+template <typename T>
+static void writeLittleEndian(std::ofstream& file, T value) {
+    std::array<char, sizeof(T)> bytes;
+    for (std::size_t i = 0; i < sizeof(T); i++) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+    file.write(bytes.data(), bytes.size());
+}
+
+template <typename T>
+static bool readLittleEndian(std::ifstream& file, T& value) {
+    std::array<unsigned char, sizeof(T)> bytes;
+    if (!file.read(reinterpret_cast<char*>(bytes.data()), bytes.size())) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = 0; i < sizeof(T); i++) {
+        value |= static_cast<T>(bytes[i]) << (8 * i);
+    }
+    return true;
+}
+
+EventsubRecorder::EventsubRecorder(const std::string& path)
+    : file(path, std::ios::binary | std::ios::trunc), startTime(std::chrono::steady_clock::now()) {
+    file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    file.write(EVENTSUB_RECORDING_MAGIC, MAGIC_LENGTH);
+}
+
+void EventsubRecorder::record(const std::string& frame) {
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+    writeLittleEndian(file, static_cast<std::uint64_t>(time.count()));
+    writeLittleEndian(file, static_cast<std::uint32_t>(frame.size()));
+    file.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+    // Flush every frame so that the recording survives a crash, which is usually what we want to reproduce.
+    file.flush();
+}
+
+EventsubRecordingReader::EventsubRecordingReader(const std::string& path) : file(path, std::ios::binary) {
+    std::array<char, MAGIC_LENGTH> magic;
+    if (!file.read(magic.data(), magic.size()) || std::memcmp(magic.data(), EVENTSUB_RECORDING_MAGIC, MAGIC_LENGTH)) {
+        throw InvalidRecordingException("Not an EventSub recording: " + path);
+    }
+}
+
+std::optional<EventsubRecordingReader::Record> EventsubRecordingReader::readRecord() {
+    std::uint64_t time;
+    if (!readLittleEndian(file, time)) {
+        return std::nullopt;
+    }
+    std::uint32_t length;
+    if (!readLittleEndian(file, length)) {
+        throw InvalidRecordingException("Truncated EventSub recording");
+    }
+    std::string frame(length, '\0');
+    if (!file.read(frame.data(), length)) {
+        throw InvalidRecordingException("Truncated EventSub recording");
+    }
+    return Record{std::chrono::microseconds(static_cast<std::int64_t>(time)), std::move(frame)};
+}
+
+EventsubRecordingReader::InvalidRecordingException::InvalidRecordingException(const std::string& message)
+    : message(message) {}
+
+const char* EventsubRecordingReader::InvalidRecordingException::what() const noexcept {
+    return message.c_str();
+}
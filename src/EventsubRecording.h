@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <optional>
+#include <string>
+
+/// A recording of raw EventSub frames. The file starts with EVENTSUB_RECORDING_MAGIC, followed by records of
+/// [8-byte little-endian microseconds since the recording started][4-byte little-endian length][frame bytes].
+inline constexpr char EVENTSUB_RECORDING_MAGIC[] = "RTEVSUB1";
+
+/// Appends frames to a recording. The time is taken from a monotonic clock.
+class EventsubRecorder {
+public:
+    EventsubRecorder(const std::string& path);
+
+    void record(const std::string& frame);
+
+private:
+    std::ofstream file;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+/// Reads the frames of a recording one by one.
+class EventsubRecordingReader {
+public:
+    EventsubRecordingReader(const std::string& path);
+
+    struct Record {
+        std::chrono::microseconds time;
+        std::string frame;
+    };
+
+    /// Returns std::nullopt at the end of the recording.
+    std::optional<Record> readRecord();
+
+    class InvalidRecordingException : public std::exception {
+    public:
+        InvalidRecordingException(const std::string& message);
+        const char* what() const noexcept override;
+
+    private:
+        std::string message;
+    };
+
+private:
+    std::ifstream file;
+};
@@ -10,19 +10,25 @@
 #include "RewardsTheaterVersion.generated.h"
 
 namespace asio = boost::asio;
+namespace http = boost::beast::http;
 
-GithubUpdateApi::GithubUpdateApi(HttpClient& httpClient, asio::io_context& ioContext)
-    : httpClient(httpClient), ioContext(ioContext) {}
+GithubUpdateApi::GithubUpdateApi(HttpClient& httpClient, IoThreadPool::Strand executor)
+    : httpClient(httpClient), executor(executor), updateFound(false) {}
 
 GithubUpdateApi::~GithubUpdateApi() = default;
 
 void GithubUpdateApi::checkForUpdates() {
-    asio::co_spawn(ioContext, asyncCheckForUpdates(), asio::detached);
+    asio::co_spawn(executor, asyncCheckForUpdates(), asio::detached);
+}
+
+bool GithubUpdateApi::isUpdateFound() const {
+    return updateFound;
 }
 
 asio::awaitable<void> GithubUpdateApi::asyncCheckForUpdates() {
     try {
         if (co_await isUpdateAvailable()) {
+            updateFound = true;
             emit onUpdateAvailable();
         }
     } catch (const std::exception& exception) {
@@ -38,10 +44,16 @@ asio::awaitable<bool> GithubUpdateApi::isUpdateAvailable() {
 
 asio::awaitable<std::string> GithubUpdateApi::getLatestReleaseVersion() {
     std::map<std::string, std::string> headers{{"User-Agent", "https://github.com/gottagofaster236/RewardsTheater"}};
-    HttpClient::Response response = co_await httpClient.request(
-        "api.github.com", "/repos/gottagofaster236/RewardsTheater/releases/latest", headers
+    std::shared_ptr<const HttpClient::Response> response = co_await httpClient.request(
+        "api.github.com",
+        "/repos/gottagofaster236/RewardsTheater/releases/latest",
+        headers,
+        {},
+        http::verb::get,
+        {},
+        HttpRequestPriority::LOW
     );
-    co_return value_to<std::string>(response.json.at("tag_name"));
+    co_return value_to<std::string>(response->json.at("tag_name"));
 }
 
 std::vector<int> GithubUpdateApi::parseVersion(const std::string& versionString) {
@@ -4,17 +4,21 @@
 #pragma once
 
 #include <QObject>
+#include <atomic>
 
 #include "BoostAsio.h"
 #include "HttpClient.h"
+#include "IoThreadPool.h"
 
 class GithubUpdateApi : public QObject {
     Q_OBJECT
 
 public:
-    GithubUpdateApi(HttpClient& httpClient, boost::asio::io_context& ioContext);
+    GithubUpdateApi(HttpClient& httpClient, IoThreadPool::Strand executor);
     ~GithubUpdateApi() override;
     void checkForUpdates();
+    /// Whether onUpdateAvailable has already been emitted, for dialogs that are created after the check.
+    bool isUpdateFound() const;
 
 signals:
     void onUpdateAvailable();
@@ -26,5 +30,6 @@ private:
     std::vector<int> parseVersion(const std::string& versionString);
 
     HttpClient& httpClient;
-    boost::asio::io_context& ioContext;
+    IoThreadPool::Strand executor;
+    std::atomic<bool> updateFound;
 };
@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "HelixRateLimiter.h"
+
+#include "ConditionVariable.h"
+
+namespace asio = boost::asio;
+
+asio::awaitable<void> HelixRateLimiter::asyncAcquire(HttpRequestPriority priority) {
+    auto timer = std::make_shared<asio::steady_timer>(co_await asio::this_coro::executor);
+    std::shared_ptr<Waiter> waiter;
+    {
+        std::lock_guard guard(mutex);
+        refillIfResetLocked();
+        if (waiters.empty() && hasTokenLocked()) {
+            consumeTokenLocked();
+            co_return;
+        }
+        waiter = std::make_shared<Waiter>(Waiter{priority, nextSequenceNumber++, timer});
+        waiters.push(waiter);
+    }
+
+    while (true) {
+        {
+            std::lock_guard guard(mutex);
+            if (waiter->isGranted) {
+                co_return;
+            }
+            // A grant cancels the timer through this strand, so a grant made after this check still wakes up the
+            // async_wait below.
+            timer->expires_at(getWakeUpTimeLocked());
+        }
+        boost::system::error_code errorCode;
+        co_await timer->async_wait(asio::redirect_error(asio::use_awaitable, errorCode));
+        // operation_aborted means that either a token was granted, or the request itself was cancelled.
+        asio::cancellation_state cancellationState = co_await asio::this_coro::cancellation_state;
+        std::lock_guard guard(mutex);
+        if (cancellationState.cancelled() != asio::cancellation_type::none) {
+            waiter->isAbandoned = true;
+            if (waiter->isGranted && tokens) {
+                // Give the token to someone else.
+                ++*tokens;
+                grantTokensLocked();
+            }
+            throw boost::system::system_error(asio::error::operation_aborted);
+        }
+        refillIfResetLocked();
+        grantTokensLocked();
+    }
+}
+
+void HelixRateLimiter::onResponse(
+    bool isTooManyRequests,
+    std::optional<std::int64_t> limit,
+    std::optional<std::int64_t> remaining,
+    std::optional<std::chrono::system_clock::time_point> resetTime
+) {
+    std::lock_guard guard(mutex);
+    if (limit) {
+        this->limit = limit;
+    }
+    if (remaining) {
+        tokens = remaining;
+    }
+    if (resetTime) {
+        this->resetTime = resetTime;
+    }
+    if (isTooManyRequests) {
+        tokens = 0;
+    }
+    if (tokens == 0 && !this->resetTime) {
+        // Without the reset time, assume the worst case: Helix refills the whole bucket within a minute.
+        this->resetTime = std::chrono::system_clock::now() + std::chrono::minutes(1);
+    }
+    grantTokensLocked();
+    // The reset time may have changed. It's enough for the first waiter to wait for it, it grants the tokens to the
+    // rest of the waiters after the reset.
+    while (!waiters.empty() && waiters.top()->isAbandoned) {
+        waiters.pop();
+    }
+    if (!waiters.empty()) {
+        wakeUp(waiters.top()->timer);
+    }
+}
+
+bool HelixRateLimiter::WaiterComparator::operator()(
+    const std::shared_ptr<Waiter>& a,
+    const std::shared_ptr<Waiter>& b
+) const {
+    // std::priority_queue pops the greatest element, so the "less" waiter is the one that should go later.
+    if (a->priority != b->priority) {
+        return a->priority < b->priority;
+    }
+    return a->sequenceNumber > b->sequenceNumber;
+}
+
+bool HelixRateLimiter::hasTokenLocked() const {
+    return !tokens || *tokens > 0;
+}
+
+void HelixRateLimiter::consumeTokenLocked() {
+    if (tokens) {
+        --*tokens;
+    }
+}
+
+void HelixRateLimiter::refillIfResetLocked() {
+    if (tokens && *tokens <= 0 && resetTime && std::chrono::system_clock::now() >= *resetTime) {
+        // If the limit is unknown, let one request through to learn it.
+        tokens = limit.value_or(1);
+        resetTime = std::nullopt;
+    }
+}
+
+void HelixRateLimiter::grantTokensLocked() {
+    while (!waiters.empty() && hasTokenLocked()) {
+        std::shared_ptr<Waiter> waiter = waiters.top();
+        waiters.pop();
+        if (waiter->isAbandoned) {
+            continue;
+        }
+        consumeTokenLocked();
+        waiter->isGranted = true;
+        wakeUp(waiter->timer);
+    }
+}
+
+void HelixRateLimiter::wakeUp(const std::shared_ptr<asio::steady_timer>& timer) {
+    asio::post(timer->get_executor(), [timer] {
+        timer->cancel();  // Equivalent to notify_all() for a condition variable.
+    });
+}
+
+std::chrono::steady_clock::time_point HelixRateLimiter::getWakeUpTimeLocked() const {
+    auto now = std::chrono::steady_clock::now();
+    if (!resetTime) {
+        // Wait until another response updates the bucket.
+        return now + POS_INFINITY;
+    }
+    auto untilReset = *resetTime - std::chrono::system_clock::now();
+    return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(untilReset);
+}
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <vector>
+
+#include "BoostAsio.h"
+
+/// The order in which requests waiting for the rate limit are sent.
+enum class HttpRequestPriority {
+    /// Update checks.
+    LOW,
+    /// Reward image downloads.
+    BELOW_NORMAL,
+    /// Reward reloads and changes made by the user.
+    NORMAL,
+    /// Redemption status updates and reward pauses, which viewers are waiting for, and the EventSub subscription,
+    /// without which no redemptions are received.
+    HIGH,
+};
+
+/// A token bucket in front of the requests to one host. It's seeded from the Ratelimit-Limit, Ratelimit-Remaining and
+/// Ratelimit-Reset headers that Helix returns, see https://dev.twitch.tv/docs/api/guide/#twitch-rate-limits.
+/// Until a response with these headers is received, requests aren't limited. Thread-safe.
+class HelixRateLimiter {
+public:
+    /// Waits until a request may be sent. Requests with a higher priority go first, requests with the same priority
+    /// go in the order of calls. Must be called on a strand.
+    boost::asio::awaitable<void> asyncAcquire(HttpRequestPriority priority);
+
+    /// Updates the bucket from the headers of a response. The bucket is emptied on 429 Too Many Requests.
+    void onResponse(
+        bool isTooManyRequests,
+        std::optional<std::int64_t> limit,
+        std::optional<std::int64_t> remaining,
+        std::optional<std::chrono::system_clock::time_point> resetTime
+    );
+
+private:
+    struct Waiter {
+        HttpRequestPriority priority;
+        std::uint64_t sequenceNumber;
+        std::shared_ptr<boost::asio::steady_timer> timer;
+        bool isGranted = false;
+        bool isAbandoned = false;
+    };
+
+    struct WaiterComparator {
+        bool operator()(const std::shared_ptr<Waiter>& a, const std::shared_ptr<Waiter>& b) const;
+    };
+
+    bool hasTokenLocked() const;
+    void consumeTokenLocked();
+    void refillIfResetLocked();
+    void grantTokensLocked();
+    static void wakeUp(const std::shared_ptr<boost::asio::steady_timer>& timer);
+    std::chrono::steady_clock::time_point getWakeUpTimeLocked() const;
+
+    std::mutex mutex;
+    std::optional<std::int64_t> limit;
+    /// std::nullopt means that the limit is unknown, and requests aren't limited.
+    std::optional<std::int64_t> tokens;
+    std::optional<std::chrono::system_clock::time_point> resetTime;
+    std::priority_queue<std::shared_ptr<Waiter>, std::vector<std::shared_ptr<Waiter>>, WaiterComparator> waiters;
+    std::uint64_t nextSequenceNumber = 0;
+};
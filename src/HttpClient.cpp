@@ -3,9 +3,21 @@
 
 #include "HttpClient.h"
 
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+#include <tuple>
 #include <utility>
 
 #include "BoostAsio.h"
+#include "JsonResponseBodyReader.h"
+#include "Log.h"
 #include "TwitchAuth.h"
 
 namespace asio = boost::asio;
@@ -13,7 +25,11 @@ namespace ssl = asio::ssl;
 namespace http = boost::beast::http;
 namespace json = boost::json;
 
-HttpClient::HttpClient(boost::asio::io_context& ioContext) : ioContext(ioContext) {}
+static constexpr int MAX_RATE_LIMITED_ATTEMPTS = 3;
+
+HttpClient::HttpClient(PluginMetrics& pluginMetrics) : pluginMetrics(pluginMetrics) {
+    loadOverridesFromEnvironment();
+}
 
 HttpClient::~HttpClient() = default;
 
@@ -23,17 +39,120 @@ const char* HttpClient::InternalServerErrorException::what() const noexcept {
     return message.c_str();
 }
 
-asio::awaitable<HttpClient::Response> HttpClient::request(
+HttpClient::TimeoutException::TimeoutException(const std::string& stage)
+    : NetworkException(asio::error::timed_out, "TimeoutException: " + stage) {}
+
+static std::optional<std::int64_t> parseIntegerHeader(const http::fields& fields, std::string_view name) {
+    auto header = fields.find(name);
+    if (header == fields.end()) {
+        return std::nullopt;
+    }
+    std::string_view value = header->value();
+    std::int64_t result;
+    auto [end, errorCode] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (errorCode != std::errc{}) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+static std::optional<std::chrono::system_clock::time_point> parseResetTime(const http::fields& fields) {
+    // Ratelimit-Reset is a Unix timestamp in seconds.
+    std::optional<std::int64_t> resetTimestamp = parseIntegerHeader(fields, "Ratelimit-Reset");
+    if (!resetTimestamp) {
+        return std::nullopt;
+    }
+    return std::chrono::system_clock::time_point(std::chrono::seconds(*resetTimestamp));
+}
+
+/// Throws TimeoutException if the operation failed with `errorCode` because its deadline has passed.
+static void throwIfTimedOut(
+    const boost::system::error_code& errorCode,
+    const char* stage,
+    std::chrono::steady_clock::time_point stageDeadline,
+    std::chrono::steady_clock::time_point totalDeadline
+) {
+    // The operation may also have been cancelled by the caller, that's not a timeout.
+    if (errorCode == asio::error::operation_aborted &&
+        std::chrono::steady_clock::now() >= std::min(stageDeadline, totalDeadline)) {
+        throw HttpClient::TimeoutException(stageDeadline < totalDeadline ? stage : "total");
+    }
+}
+
+/// Runs an asynchronous operation, cancelling it through its cancellation slot if it doesn't complete before the
+/// earliest of the two deadlines. `operation` is called with the completion token to use.
+template <typename Operation>
+static auto asyncWithDeadline(
+    Operation operation,
+    const char* stage,
+    std::chrono::steady_clock::time_point stageDeadline,
+    std::chrono::steady_clock::time_point totalDeadline
+) -> decltype(operation(asio::cancel_after(std::chrono::steady_clock::duration{}, asio::use_awaitable))) {
+    auto timeout = std::min(stageDeadline, totalDeadline) - std::chrono::steady_clock::now();
+    try {
+        co_return co_await operation(asio::cancel_after(timeout, asio::use_awaitable));
+    } catch (const boost::system::system_error& e) {
+        throwIfTimedOut(e.code(), stage, stageDeadline, totalDeadline);
+        throw;
+    }
+}
+
+/// Like asyncWithDeadline, but returns the error of the operation instead of throwing it, for operations that fail as
+/// a part of their normal flow. Timeouts are still thrown.
+template <typename Operation>
+static asio::awaitable<boost::system::error_code> asyncWithDeadlineNoThrow(
+    Operation operation,
+    const char* stage,
+    std::chrono::steady_clock::time_point stageDeadline,
+    std::chrono::steady_clock::time_point totalDeadline
+) {
+    auto timeout = std::min(stageDeadline, totalDeadline) - std::chrono::steady_clock::now();
+    auto result = co_await operation(asio::cancel_after(timeout, asio::as_tuple(asio::use_awaitable)));
+    boost::system::error_code errorCode = std::get<0>(result);
+    throwIfTimedOut(errorCode, stage, stageDeadline, totalDeadline);
+    co_return errorCode;
+}
+
+/// Waits for the rate limit. The wait counts towards the total deadline of the request.
+static asio::awaitable<void> asyncAcquireRateLimit(
+    HelixRateLimiter& rateLimiter,
+    HttpRequestPriority priority,
+    std::chrono::steady_clock::time_point totalDeadline
+) {
+    auto executor = co_await asio::this_coro::executor;
+    co_await asyncWithDeadline(
+        [&](auto token) { return asio::co_spawn(executor, rateLimiter.asyncAcquire(priority), std::move(token)); },
+        "total",
+        totalDeadline,
+        totalDeadline
+    );
+}
+
+/// Updates the rate limiter from the headers of a response.
+static void updateRateLimiter(HelixRateLimiter& rateLimiter, http::status status, const http::fields& headers) {
+    rateLimiter.onResponse(
+        status == http::status::too_many_requests,
+        parseIntegerHeader(headers, "Ratelimit-Limit"),
+        parseIntegerHeader(headers, "Ratelimit-Remaining"),
+        parseResetTime(headers)
+    );
+}
+
+asio::awaitable<std::shared_ptr<const HttpClient::Response>> HttpClient::request(
     const std::string& host,
     const std::string& path,
     const std::map<std::string, std::string>& headers,
     std::initializer_list<boost::urls::param_view> urlParams,
     http::verb method,
-    json::value requestBody
+    json::value requestBody,
+    HttpRequestPriority priority,
+    HttpRequestTimeouts timeouts,
+    json::storage_ptr storage
 ) {
-    ssl::stream<asio::ip::tcp::socket> stream = co_await resolveHost(host);
+    // The path may have parameters already, e.g. a parameter repeated a variable number of times.
     boost::urls::url pathWithParams = boost::urls::parse_origin_form(path).value();
-    pathWithParams.set_params(urlParams);
+    pathWithParams.params().append(urlParams);
+    std::string endpoint(pathWithParams.encoded_path());
     http::request<http::string_body> request{method, pathWithParams.buffer(), 11};
     request.set(http::field::host, host);
     for (const auto& [headerName, headerValue] : headers) {
@@ -45,65 +164,208 @@ asio::awaitable<HttpClient::Response> HttpClient::request(
         request.set(http::field::content_type, "application/json");
     }
 
-    http::response<http::dynamic_body> response = co_await getResponse(request, stream);
-    std::string body = boost::beast::buffers_to_string(response.body().data());
-    if (response.result() == http::status::internal_server_error) {
-        throw HttpClient::InternalServerErrorException(body);
+    bool isCoalesced = method == http::verb::get && requestBody.is_null() && storage.get() == json::storage_ptr().get();
+    if (isCoalesced) {
+        co_return co_await requestFlights.run(getFlightKey(host, request, headers), [&] {
+            return requestWithRetries(host, endpoint, request, priority, timeouts, std::move(storage));
+        });
+    }
+    if (method == http::verb::get) {
+        co_return std::make_shared<const Response>(
+            co_await requestWithRetries(host, endpoint, request, priority, timeouts, std::move(storage))
+        );
+    }
+
+    // The GET requests to the path that are still in flight may return the data from before this request.
+    try {
+        Response response =
+            co_await requestWithRetries(host, endpoint, request, priority, timeouts, std::move(storage));
+        requestFlights.forget(host + endpoint);
+        co_return std::make_shared<const Response>(std::move(response));
+    } catch (...) {
+        requestFlights.forget(host + endpoint);
+        throw;
+    }
+}
+
+std::string HttpClient::getFlightKey(
+    const std::string& host,
+    const http::request<http::string_body>& request,
+    const std::map<std::string, std::string>& headers
+) {
+    // The target includes the parameters, and the headers include the access token. The key starts with the host and
+    // the path, so that the flights to a path can be forgotten.
+    std::string key = fmt::format("{}{}", host, std::string_view(request.target()));
+    for (const auto& [headerName, headerValue] : headers) {
+        key += fmt::format("\n{}: {}", headerName, headerValue);
     }
-    json::value responseJson;
-    if (!body.empty()) {
-        responseJson = boost::json::parse(body);
+    return key;
+}
+
+asio::awaitable<HttpClient::Response> HttpClient::requestWithRetries(
+    const std::string& host,
+    const std::string& path,
+    const http::request<http::string_body>& request,
+    HttpRequestPriority priority,
+    const HttpRequestTimeouts& timeouts,
+    json::storage_ptr storage
+) {
+    // The total timeout also covers waiting for the rate limit and the retries.
+    auto totalDeadline = std::chrono::steady_clock::now() + timeouts.total;
+    HelixRateLimiter& rateLimiter = getRateLimiter(host);
+    for (int attempt = 1;; attempt++) {
+        co_await asyncAcquireRateLimit(rateLimiter, priority, totalDeadline);
+        Response response = co_await requestOnce(host, path, request, rateLimiter, timeouts, totalDeadline, storage);
+        if (response.status != http::status::too_many_requests || attempt == MAX_RATE_LIMITED_ATTEMPTS) {
+            co_return response;
+        }
+        log(LOG_WARNING, "Rate limited by {}, retrying {} after the rate limit resets", host, path);
+    }
+}
+
+asio::awaitable<HttpClient::Response> HttpClient::requestOnce(
+    const std::string& host,
+    const std::string& path,
+    const http::request<http::string_body>& request,
+    HelixRateLimiter& rateLimiter,
+    const HttpRequestTimeouts& timeouts,
+    std::chrono::steady_clock::time_point totalDeadline,
+    json::storage_ptr storage
+) {
+    auto startTime = std::chrono::steady_clock::now();
+    ssl::stream<asio::ip::tcp::socket> stream = co_await resolveHost(host, timeouts, totalDeadline);
+
+    auto firstByteDeadline = std::chrono::steady_clock::now() + timeouts.firstByte;
+    co_await asyncWithDeadline(
+        [&](auto token) { return http::async_write(stream, request, std::move(token)); },
+        "first byte",
+        firstByteDeadline,
+        totalDeadline
+    );
+    Response response =
+        co_await asyncReadJsonResponse(stream, rateLimiter, std::move(storage), firstByteDeadline, totalDeadline);
+    onRequestFinished(host, path, startTime);
+    co_return response;
+}
+
+HelixRateLimiter& HttpClient::getRateLimiter(const std::string& host) {
+    std::lock_guard guard(rateLimitersMutex);
+    std::unique_ptr<HelixRateLimiter>& rateLimiter = rateLimiters[host];
+    if (!rateLimiter) {
+        rateLimiter = std::make_unique<HelixRateLimiter>();
     }
-    co_return HttpClient::Response{response.result(), std::move(responseJson)};
+    return *rateLimiter;
 }
 
-asio::awaitable<HttpClient::Response> HttpClient::request(
+asio::awaitable<std::shared_ptr<const HttpClient::Response>> HttpClient::request(
     const std::string& host,
     const std::string& path,
     const std::string& accessToken,
     const std::string& clientId,
     std::initializer_list<boost::urls::param_view> urlParams,
     http::verb method,
-    json::value body
+    json::value body,
+    HttpRequestPriority priority,
+    HttpRequestTimeouts timeouts,
+    json::storage_ptr storage
 ) {
     std::map<std::string, std::string> headers{{"Authorization", "Bearer " + accessToken}, {"Client-Id", clientId}};
-    co_return co_await request(host, path, headers, urlParams, method, body);
+    co_return co_await request(host, path, headers, urlParams, method, body, priority, timeouts, std::move(storage));
 }
 
-asio::awaitable<HttpClient::Response> HttpClient::request(
+asio::awaitable<std::shared_ptr<const HttpClient::Response>> HttpClient::request(
     const std::string& host,
     const std::string& path,
     TwitchAuth& auth,
     std::initializer_list<boost::urls::param_view> urlParams,
     http::verb method,
-    json::value body
+    json::value body,
+    HttpRequestPriority priority,
+    HttpRequestTimeouts timeouts,
+    json::storage_ptr storage
 ) {
-    HttpClient::Response response =
-        co_await request(host, path, auth.getAccessTokenOrThrow(), auth.getClientId(), urlParams, method, body);
-    if (response.status == http::status::unauthorized) {
+    std::shared_ptr<const HttpClient::Response> response = co_await request(
+        host,
+        path,
+        auth.getAccessTokenOrThrow(),
+        auth.getClientId(),
+        urlParams,
+        method,
+        body,
+        priority,
+        timeouts,
+        std::move(storage)
+    );
+    if (response->status == http::status::unauthorized) {
         auth.logOutAndEmitAuthenticationFailure();
         throw TwitchAuth::UnauthenticatedException();
     }
     co_return response;
 }
 
-asio::awaitable<std::string> HttpClient::downloadFile(const std::string& host, const std::string& path) {
-    ssl::stream<asio::ip::tcp::socket> stream = co_await resolveHost(host);
+asio::awaitable<std::string> HttpClient::downloadFile(
+    const std::string& host,
+    const std::string& path,
+    HttpRequestPriority priority,
+    HttpRequestTimeouts timeouts
+) {
+    std::shared_ptr<const std::string> file = co_await downloadFlights.run(host + path, [&] {
+        return downloadFileOnce(host, path, priority, timeouts);
+    });
+    co_return *file;
+}
+
+asio::awaitable<std::string> HttpClient::downloadFileOnce(
+    const std::string& host,
+    const std::string& path,
+    HttpRequestPriority priority,
+    const HttpRequestTimeouts& timeouts
+) {
+    auto totalDeadline = std::chrono::steady_clock::now() + timeouts.total;
+    HelixRateLimiter& rateLimiter = getRateLimiter(host);
+    co_await asyncAcquireRateLimit(rateLimiter, priority, totalDeadline);
+    auto startTime = std::chrono::steady_clock::now();
+    ssl::stream<asio::ip::tcp::socket> stream = co_await resolveHost(host, timeouts, totalDeadline);
     http::request<http::string_body> request{http::verb::get, path, 11};
     request.set(http::field::host, host);
 
-    http::response<http::dynamic_body> response = co_await getResponse(request, stream);
+    auto firstByteDeadline = std::chrono::steady_clock::now() + timeouts.firstByte;
+    http::response<http::string_body> response =
+        co_await getResponse(request, stream, firstByteDeadline, totalDeadline);
+    updateRateLimiter(rateLimiter, response.result(), response);
+    // Image paths are unique, so they are all accounted as a single endpoint.
+    onRequestFinished(host, "/download", startTime);
     if (response.result() != http::status::ok) {
         throw TwitchAuth::UnauthenticatedException();
     }
-    co_return boost::beast::buffers_to_string(response.body().data());
+    co_return std::move(response.body());
 }
 
-asio::awaitable<ssl::stream<asio::ip::tcp::socket>> HttpClient::resolveHost(const std::string& host) {
-    ssl::context sslContext{ssl::context::tlsv12};
+std::pair<std::string, std::string> HttpClient::getHostAndPort(const std::string& host) const {
+    auto hostOverride = hostOverrides.find(host);
+    if (hostOverride == hostOverrides.end()) {
+        return {host, "https"};
+    }
+    return hostOverride->second;
+}
+
+void HttpClient::configureSslContext(ssl::context& sslContext) const {
     sslContext.set_default_verify_paths();
-    asio::ip::tcp::resolver resolver{ioContext};
-    ssl::stream<asio::ip::tcp::socket> stream{ioContext, sslContext};
+    if (!caFile.empty()) {
+        sslContext.load_verify_file(caFile);
+    }
+}
+
+asio::awaitable<ssl::stream<asio::ip::tcp::socket>> HttpClient::resolveHost(
+    const std::string& host,
+    const HttpRequestTimeouts& timeouts,
+    std::chrono::steady_clock::time_point totalDeadline
+) {
+    ssl::context sslContext{ssl::context::tlsv12};
+    configureSslContext(sslContext);
+    auto executor = co_await asio::this_coro::executor;
+    asio::ip::tcp::resolver resolver{executor};
+    ssl::stream<asio::ip::tcp::socket> stream{executor, sslContext};
 
     if (!SSL_set_tlsext_host_name(stream.native_handle(), host.c_str())) {
         throw boost::system::system_error(
@@ -112,21 +374,134 @@ asio::awaitable<ssl::stream<asio::ip::tcp::socket>> HttpClient::resolveHost(cons
         );
     }
 
-    const auto resolveResults = co_await resolver.async_resolve(host, "https", asio::use_awaitable);
-    co_await asio::async_connect(
-        stream.next_layer(), resolveResults.begin(), resolveResults.end(), asio::use_awaitable
+    auto [connectHost, connectPort] = getHostAndPort(host);
+    auto connectDeadline = std::chrono::steady_clock::now() + timeouts.connect;
+    const auto resolveResults = co_await asyncWithDeadline(
+        [&](auto token) { return resolver.async_resolve(connectHost, connectPort, std::move(token)); },
+        "connect",
+        connectDeadline,
+        totalDeadline
+    );
+    co_await asyncWithDeadline(
+        [&](auto token) { return asio::async_connect(stream.next_layer(), resolveResults, std::move(token)); },
+        "connect",
+        connectDeadline,
+        totalDeadline
     );
-    co_await stream.async_handshake(ssl::stream_base::client, asio::use_awaitable);
+    co_await asyncWithDeadline(
+        [&](auto token) { return stream.async_handshake(ssl::stream_base::client, std::move(token)); },
+        "handshake",
+        std::chrono::steady_clock::now() + timeouts.handshake,
+        totalDeadline
+    );
+    pluginMetrics.onHttpConnectionOpened();
     co_return stream;
 }
 
-asio::awaitable<http::response<http::dynamic_body>> HttpClient::getResponse(
+asio::awaitable<http::response<http::string_body>> HttpClient::getResponse(
     const http::request<http::string_body>& request,
-    ssl::stream<asio::ip::tcp::socket>& stream
+    ssl::stream<asio::ip::tcp::socket>& stream,
+    std::chrono::steady_clock::time_point firstByteDeadline,
+    std::chrono::steady_clock::time_point totalDeadline
 ) {
-    co_await http::async_write(stream, request, asio::use_awaitable);
+    co_await asyncWithDeadline(
+        [&](auto token) { return http::async_write(stream, request, std::move(token)); },
+        "first byte",
+        firstByteDeadline,
+        totalDeadline
+    );
     boost::beast::flat_buffer buffer;
-    http::response<http::dynamic_body> response;
-    co_await http::async_read(stream, buffer, response, asio::use_awaitable);
-    co_return response;
+    http::response_parser<http::string_body> parser;
+    co_await asyncWithDeadline(
+        [&](auto token) { return http::async_read_header(stream, buffer, parser, std::move(token)); },
+        "first byte",
+        firstByteDeadline,
+        totalDeadline
+    );
+    co_await asyncWithDeadline(
+        [&](auto token) { return http::async_read(stream, buffer, parser, std::move(token)); },
+        "total",
+        totalDeadline,
+        totalDeadline
+    );
+    co_return parser.release();
+}
+
+asio::awaitable<HttpClient::Response> HttpClient::asyncReadJsonResponse(
+    ssl::stream<asio::ip::tcp::socket>& stream,
+    HelixRateLimiter& rateLimiter,
+    json::storage_ptr storage,
+    std::chrono::steady_clock::time_point firstByteDeadline,
+    std::chrono::steady_clock::time_point totalDeadline
+) {
+    boost::beast::flat_buffer buffer;
+    http::response_parser<http::buffer_body> parser;
+    co_await asyncWithDeadline(
+        [&](auto token) { return http::async_read_header(stream, buffer, parser, std::move(token)); },
+        "first byte",
+        firstByteDeadline,
+        totalDeadline
+    );
+    http::status status = parser.get().result();
+    updateRateLimiter(rateLimiter, status, parser.get());
+
+    bool isInternalServerError = status == http::status::internal_server_error;
+    JsonResponseBodyReader bodyReader(parser, isInternalServerError, std::move(storage));
+    while (!parser.is_done()) {
+        bodyReader.prepareChunk();
+        boost::system::error_code errorCode = co_await asyncWithDeadlineNoThrow(
+            [&](auto token) { return http::async_read(stream, buffer, parser, std::move(token)); },
+            "total",
+            totalDeadline,
+            totalDeadline
+        );
+        // need_buffer means that the chunk is full, which is expected.
+        if (errorCode && errorCode != http::error::need_buffer) {
+            throw boost::system::system_error(errorCode);
+        }
+        bodyReader.consumeChunk();
+    }
+
+    if (isInternalServerError) {
+        throw HttpClient::InternalServerErrorException(bodyReader.releaseText());
+    }
+    json::value responseJson = bodyReader.releaseJson();
+    co_return HttpClient::Response{status, std::move(responseJson)};
+}
+
+void HttpClient::onRequestFinished(
+    const std::string& host,
+    const std::string& path,
+    std::chrono::steady_clock::time_point startTime
+) {
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+    pluginMetrics.onHttpRequestFinished(host + path, latency);
+}
+
+void HttpClient::loadOverridesFromEnvironment() {
+    if (const char* overrides = std::getenv("REWARDS_THEATER_HOST_OVERRIDES")) {
+        std::string_view remaining = overrides;
+        while (!remaining.empty()) {
+            std::size_t commaPosition = remaining.find(',');
+            std::string_view entry = remaining.substr(0, commaPosition);
+            remaining = commaPosition == std::string_view::npos ? "" : remaining.substr(commaPosition + 1);
+
+            std::size_t equalsPosition = entry.find('=');
+            std::size_t colonPosition = entry.rfind(':');
+            if (equalsPosition == std::string_view::npos || colonPosition == std::string_view::npos ||
+                colonPosition < equalsPosition) {
+                log(LOG_ERROR, "Malformed entry in REWARDS_THEATER_HOST_OVERRIDES: {}", entry);
+                continue;
+            }
+            std::string host{entry.substr(0, equalsPosition)};
+            std::string overrideHost{entry.substr(equalsPosition + 1, colonPosition - equalsPosition - 1)};
+            std::string overridePort{entry.substr(colonPosition + 1)};
+            log(LOG_WARNING, "Connecting to {}:{} instead of {}", overrideHost, overridePort, host);
+            hostOverrides[host] = {overrideHost, overridePort};
+        }
+    }
+    if (const char* caFileVariable = std::getenv("REWARDS_THEATER_CA_FILE")) {
+        caFile = caFileVariable;
+        log(LOG_WARNING, "Trusting the certificates from {}", caFile);
+    }
 }
@@ -6,18 +6,47 @@
 #include <boost/json.hpp>
 #include <boost/system/system_error.hpp>
 #include <boost/url.hpp>
+#include <chrono>
 #include <exception>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
 
 #include "BoostAsio.h"
+#include "HelixRateLimiter.h"
+#include "PluginMetrics.h"
+#include "SingleFlight.h"
 
 class TwitchAuth;
 
+/// How long the stages of an HTTPS request may take. Declared outside of HttpClient so that it can be used as a
+/// default argument of its methods.
+struct HttpRequestTimeouts {
+    /// Resolving the host and connecting to it.
+    std::chrono::milliseconds connect = std::chrono::seconds(10);
+    std::chrono::milliseconds handshake = std::chrono::seconds(10);
+    /// Sending the request and receiving the response headers.
+    std::chrono::milliseconds firstByte = std::chrono::seconds(20);
+    /// The whole request, including waiting for the rate limit and the retries.
+    std::chrono::milliseconds total = std::chrono::seconds(60);
+};
+
+/// Performs HTTPS requests on the executor of the calling coroutine.
+///
+/// For testing against a local stand-in for Twitch, hosts can be redirected with the environment variable
+/// REWARDS_THEATER_HOST_OVERRIDES="api.twitch.tv=localhost:8443,id.twitch.tv=localhost:8443", and an extra CA
+/// certificate can be trusted with REWARDS_THEATER_CA_FILE=/path/to/ca.pem.
 class HttpClient {
 public:
-    HttpClient(boost::asio::io_context& ioContext);
+    HttpClient(PluginMetrics& pluginMetrics);
     ~HttpClient();
 
+    /// Returns the host and the port (or service name) to connect to instead of `host`.
+    std::pair<std::string, std::string> getHostAndPort(const std::string& host) const;
+    void configureSslContext(boost::asio::ssl::context& sslContext) const;
+
     struct Response {
         boost::beast::http::status status;
         boost::json::value json;
@@ -34,42 +63,130 @@ public:
         std::string message;
     };
 
-    boost::asio::awaitable<Response> request(
+    /// Thrown when a stage of a request exceeds its timeout from HttpRequestTimeouts. It's a NetworkException, so that
+    /// it's shown to the user like any other connection problem.
+    class TimeoutException : public NetworkException {
+    public:
+        TimeoutException(const std::string& stage);
+    };
+
+    /// Waits for the rate limit of the host, and retries the request after the rate limit resets on 429 Too Many
+    /// Requests. The response JSON is parsed while the body is being received. If `storage` is given, the JSON is
+    /// allocated from it, so it must outlive the response.
+    ///
+    /// Concurrent identical GET requests (same host, path, parameters and headers) share one network round trip and
+    /// one response, unless `storage` is given. GET requests that are sent after another request to the same path has
+    /// completed don't share the responses of the ones sent before, since the other request may have changed the data.
+    boost::asio::awaitable<std::shared_ptr<const Response>> request(
         const std::string& host,
         const std::string& path,
         const std::map<std::string, std::string>& headers = {},
         std::initializer_list<boost::urls::param_view> urlParams = {},
         boost::beast::http::verb method = boost::beast::http::verb::get,
-        boost::json::value body = {}
+        boost::json::value body = {},
+        HttpRequestPriority priority = HttpRequestPriority::NORMAL,
+        HttpRequestTimeouts timeouts = {},
+        boost::json::storage_ptr storage = {}
     );
 
-    boost::asio::awaitable<Response> request(
+    boost::asio::awaitable<std::shared_ptr<const Response>> request(
         const std::string& host,
         const std::string& path,
         const std::string& accessToken,
         const std::string& clientId,
         std::initializer_list<boost::urls::param_view> urlParams = {},
         boost::beast::http::verb method = boost::beast::http::verb::get,
-        boost::json::value body = {}
+        boost::json::value body = {},
+        HttpRequestPriority priority = HttpRequestPriority::NORMAL,
+        HttpRequestTimeouts timeouts = {},
+        boost::json::storage_ptr storage = {}
     );
 
-    boost::asio::awaitable<Response> request(
+    boost::asio::awaitable<std::shared_ptr<const Response>> request(
         const std::string& host,
         const std::string& path,
         TwitchAuth& auth,
         std::initializer_list<boost::urls::param_view> urlParams = {},
         boost::beast::http::verb method = boost::beast::http::verb::get,
-        boost::json::value body = {}
+        boost::json::value body = {},
+        HttpRequestPriority priority = HttpRequestPriority::NORMAL,
+        HttpRequestTimeouts timeouts = {},
+        boost::json::storage_ptr storage = {}
     );
 
-    boost::asio::awaitable<std::string> downloadFile(const std::string& host, const std::string& path);
+    /// Waits for the rate limit of the host like request() does. Concurrent downloads of the same file share one
+    /// network round trip.
+    boost::asio::awaitable<std::string> downloadFile(
+        const std::string& host,
+        const std::string& path,
+        HttpRequestPriority priority = HttpRequestPriority::NORMAL,
+        HttpRequestTimeouts timeouts = {}
+    );
 
 private:
-    boost::asio::awaitable<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>> resolveHost(const std::string& host);
-    boost::asio::awaitable<boost::beast::http::response<boost::beast::http::dynamic_body>> getResponse(
+    boost::asio::awaitable<Response> requestWithRetries(
+        const std::string& host,
+        const std::string& path,
+        const boost::beast::http::request<boost::beast::http::string_body>& request,
+        HttpRequestPriority priority,
+        const HttpRequestTimeouts& timeouts,
+        boost::json::storage_ptr storage
+    );
+    boost::asio::awaitable<Response> requestOnce(
+        const std::string& host,
+        const std::string& path,
         const boost::beast::http::request<boost::beast::http::string_body>& request,
-        boost::asio::ssl::stream<boost::asio::ip::tcp::socket>& stream
+        HelixRateLimiter& rateLimiter,
+        const HttpRequestTimeouts& timeouts,
+        std::chrono::steady_clock::time_point totalDeadline,
+        boost::json::storage_ptr storage
     );
+    static std::string getFlightKey(
+        const std::string& host,
+        const boost::beast::http::request<boost::beast::http::string_body>& request,
+        const std::map<std::string, std::string>& headers
+    );
+    HelixRateLimiter& getRateLimiter(const std::string& host);
+    boost::asio::awaitable<std::string> downloadFileOnce(
+        const std::string& host,
+        const std::string& path,
+        HttpRequestPriority priority,
+        const HttpRequestTimeouts& timeouts
+    );
+    boost::asio::awaitable<boost::asio::ssl::stream<boost::asio::ip::tcp::socket>> resolveHost(
+        const std::string& host,
+        const HttpRequestTimeouts& timeouts,
+        std::chrono::steady_clock::time_point totalDeadline
+    );
+    static boost::asio::awaitable<boost::beast::http::response<boost::beast::http::string_body>> getResponse(
+        const boost::beast::http::request<boost::beast::http::string_body>& request,
+        boost::asio::ssl::stream<boost::asio::ip::tcp::socket>& stream,
+        std::chrono::steady_clock::time_point firstByteDeadline,
+        std::chrono::steady_clock::time_point totalDeadline
+    );
+    /// Parses the response body as it arrives instead of buffering the whole body first.
+    static boost::asio::awaitable<Response> asyncReadJsonResponse(
+        boost::asio::ssl::stream<boost::asio::ip::tcp::socket>& stream,
+        HelixRateLimiter& rateLimiter,
+        boost::json::storage_ptr storage,
+        std::chrono::steady_clock::time_point firstByteDeadline,
+        std::chrono::steady_clock::time_point totalDeadline
+    );
+    void onRequestFinished(
+        const std::string& host,
+        const std::string& path,
+        std::chrono::steady_clock::time_point startTime
+    );
+
+    void loadOverridesFromEnvironment();
 
-    boost::asio::io_context& ioContext;
+    PluginMetrics& pluginMetrics;
+    // Only modified in the constructor, so no locking is needed.
+    std::map<std::string, std::pair<std::string, std::string>> hostOverrides;
+    std::string caFile;
+    // Rate limiters are never removed, so references to them stay valid.
+    std::map<std::string, std::unique_ptr<HelixRateLimiter>> rateLimiters;
+    std::mutex rateLimitersMutex;
+    SingleFlight<Response> requestFlights;
+    SingleFlight<std::string> downloadFlights;
 };
@@ -3,20 +3,16 @@
 
 #include "IoThreadPool.h"
 
+#include <algorithm>
+#include <functional>
+
 #include "Log.h"
 
-IoThreadPool::IoThreadPool(unsigned nThreads) {
-    auto runIoContext = [this]() {
-        auto workGuard = boost::asio::make_work_guard(ioContext);  // Run forever until stop()
-        try {
-            ioContext.run();
-        } catch (const std::exception& exception) {
-            log(LOG_ERROR, "Exception in IoThreadPool: {}", exception.what());
-        }
-    };
+namespace asio = boost::asio;
 
+IoThreadPool::IoThreadPool(unsigned nThreads) {
     for (unsigned i = 0; i < nThreads; i++) {
-        threads.emplace_back(runIoContext);
+        threads.emplace_back(&IoThreadPool::runIoContext, std::ref(ioContext));
     }
 }
 
@@ -26,9 +22,118 @@ IoThreadPool::~IoThreadPool() {
 
 void IoThreadPool::stop() {
     ioContext.stop();
+    for (asio::io_context& dedicatedContext : dedicatedContexts) {
+        dedicatedContext.stop();
+    }
     for (std::thread& thread : threads) {
         if (thread.joinable()) {
             thread.join();
         }
     }
 }
+
+IoThreadPool::ExecutorMetrics::ExecutorMetrics(const std::string& name, const std::atomic<bool>& timingEnabled)
+    : name(name), timingEnabled(timingEnabled) {}
+
+// The counters are only statistics, so they don't order any other memory operations.
+void IoThreadPool::ExecutorMetrics::onHandlerQueued() {
+    std::int64_t queued = queuedHandlers.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::int64_t maxQueued = maxQueuedHandlers.load(std::memory_order_relaxed);
+    while (queued > maxQueued &&
+           !maxQueuedHandlers.compare_exchange_weak(maxQueued, queued, std::memory_order_relaxed)) {}
+}
+
+void IoThreadPool::ExecutorMetrics::onHandlerStarted() {
+    queuedHandlers.fetch_sub(1, std::memory_order_relaxed);
+    executedHandlers.fetch_add(1, std::memory_order_relaxed);
+}
+
+void IoThreadPool::ExecutorMetrics::onHandlerStarted(std::chrono::steady_clock::time_point queuedAt) {
+    onHandlerStarted();
+    queueDelay.record(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queuedAt)
+    );
+}
+
+void IoThreadPool::ExecutorMetrics::onHandlerFinished(std::chrono::steady_clock::time_point startedAt) {
+    executionTime.record(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startedAt)
+    );
+}
+
+IoThreadPool::Strand IoThreadPool::makeStrand(const std::string& name) {
+    std::lock_guard guard(executorMetricsMutex);
+    ExecutorMetrics& metrics = executorMetrics.emplace_back(name, timingEnabled);
+    return Strand(asio::make_strand(ioContext), metrics);
+}
+
+IoThreadPool::Strand IoThreadPool::makeDedicatedStrand(const std::string& name) {
+    std::lock_guard guard(executorMetricsMutex);
+    asio::io_context& dedicatedContext = dedicatedContexts.emplace_back();
+    threads.emplace_back(&IoThreadPool::runIoContext, std::ref(dedicatedContext));
+    ExecutorMetrics& metrics = executorMetrics.emplace_back(name, timingEnabled);
+    return Strand(asio::make_strand(dedicatedContext), metrics);
+}
+
+std::vector<IoThreadPool::ExecutorMetricsSnapshot> IoThreadPool::getExecutorMetrics() const {
+    std::lock_guard guard(executorMetricsMutex);
+    std::vector<ExecutorMetricsSnapshot> result;
+    for (const ExecutorMetrics& metrics : executorMetrics) {
+        result.push_back(
+            {metrics.name,
+             metrics.queuedHandlers.load(std::memory_order_relaxed),
+             metrics.maxQueuedHandlers.load(std::memory_order_relaxed),
+             metrics.executedHandlers.load(std::memory_order_relaxed),
+             metrics.queueDelay.getSnapshot(),
+             metrics.executionTime.getSnapshot()}
+        );
+    }
+    return result;
+}
+
+void IoThreadPool::setTimingEnabled(bool enabled) {
+    timingEnabled = enabled;
+}
+
+bool IoThreadPool::isTimingEnabled() const {
+    return timingEnabled;
+}
+
+void IoThreadPool::startMetricsLogging(std::chrono::seconds interval, int logLevel) {
+    setTimingEnabled(true);
+    asio::co_spawn(makeStrand("IoThreadPool"), asyncLogMetrics(interval, logLevel), asio::detached);
+}
+
+asio::awaitable<void> IoThreadPool::asyncLogMetrics(std::chrono::seconds interval, int logLevel) {
+    asio::steady_timer timer(co_await asio::this_coro::executor);
+    while (true) {
+        timer.expires_after(interval);
+        co_await timer.async_wait(asio::use_awaitable);
+
+        for (const ExecutorMetricsSnapshot& metrics : getExecutorMetrics()) {
+            log(
+                logLevel,
+                "Executor {}: {} handlers executed, {} queued (max {}), queue delay {}, execution time {}",
+                metrics.name,
+                metrics.executedHandlers,
+                metrics.queuedHandlers,
+                metrics.maxQueuedHandlers,
+                metrics.queueDelay.toString(),
+                metrics.executionTime.toString()
+            );
+        }
+    }
+}
+
+void IoThreadPool::runIoContext(asio::io_context& context) {
+    auto workGuard = asio::make_work_guard(context);  // Run forever until stop()
+    try {
+        context.run();
+    } catch (const std::exception& exception) {
+        log(LOG_ERROR, "Exception in IoThreadPool: {}", exception.what());
+    }
+}
+
+unsigned IoThreadPool::getDefaultThreadCount() {
+    return std::clamp(std::thread::hardware_concurrency(), 2u, 4u);
+}
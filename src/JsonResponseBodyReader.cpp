@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "JsonResponseBodyReader.h"
+
+#include <utility>
+
+namespace json = boost::json;
+
+JsonResponseBodyReader::JsonResponseBodyReader(Parser& parser, bool isText, json::storage_ptr storage)
+    : parser(parser), isText(isText), jsonParser(std::move(storage)) {}
+
+void JsonResponseBodyReader::prepareChunk() {
+    parser.get().body().data = chunk.data();
+    parser.get().body().size = chunk.size();
+}
+
+void JsonResponseBodyReader::consumeChunk() {
+    std::size_t chunkSize = chunk.size() - parser.get().body().size;
+    if (chunkSize == 0) {
+        return;
+    }
+    isBodyEmpty = false;
+    if (isText) {
+        text.append(chunk.data(), chunkSize);
+    } else {
+        jsonParser.write(chunk.data(), chunkSize);
+    }
+}
+
+json::value JsonResponseBodyReader::releaseJson() {
+    if (isBodyEmpty) {
+        return nullptr;
+    }
+    jsonParser.finish();
+    return jsonParser.release();
+}
+
+std::string JsonResponseBodyReader::releaseText() {
+    return std::move(text);
+}
@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <array>
+#include <boost/json.hpp>
+#include <string>
+
+#include "BoostAsio.h"
+
+/// Parses the JSON body of an HTTP response while it's being received, a chunk at a time, so that the whole body is
+/// never held in memory. A body that isn't necessarily JSON, like the one of an internal server error, is collected as
+/// text instead.
+class JsonResponseBodyReader {
+public:
+    using Parser = boost::beast::http::response_parser<boost::beast::http::buffer_body>;
+
+    /// If `storage` is given, the JSON is allocated from it.
+    JsonResponseBodyReader(Parser& parser, bool isText, boost::json::storage_ptr storage = {});
+
+    /// Gives the parser the chunk to read the body into. Must be called before every read of the body.
+    void prepareChunk();
+    /// Parses or collects what the parser has read into the chunk.
+    void consumeChunk();
+
+    /// Null if the body is empty.
+    boost::json::value releaseJson();
+    std::string releaseText();
+
+private:
+    Parser& parser;
+    const bool isText;
+    bool isBodyEmpty = true;
+    boost::json::stream_parser jsonParser;
+    std::string text;
+    std::array<char, 8192> chunk;
+};
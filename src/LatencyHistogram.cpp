@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "LatencyHistogram.h"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+void LatencyHistogram::record(std::chrono::microseconds duration) {
+    std::uint64_t microseconds = static_cast<std::uint64_t>(std::max<std::int64_t>(0, duration.count()));
+    std::size_t bucket = std::min<std::size_t>(std::bit_width(microseconds), BUCKET_COUNT - 1);
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumMicroseconds.fetch_add(static_cast<std::int64_t>(microseconds), std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::getSnapshot() const {
+    Snapshot snapshot;
+    for (std::size_t i = 0; i < BUCKET_COUNT; i++) {
+        snapshot.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sum = std::chrono::microseconds(sumMicroseconds.load(std::memory_order_relaxed));
+    return snapshot;
+}
+
+std::chrono::microseconds LatencyHistogram::getBucketUpperBound(std::size_t bucket) {
+    if (bucket + 1 >= BUCKET_COUNT) {
+        return std::chrono::microseconds::max();
+    }
+    return std::chrono::microseconds(std::int64_t{1} << bucket);
+}
+
+std::chrono::microseconds LatencyHistogram::Snapshot::getQuantile(double quantile) const {
+    if (count == 0) {
+        return std::chrono::microseconds(0);
+    }
+    auto rank = static_cast<std::uint64_t>(std::ceil(quantile * static_cast<double>(count)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= std::max<std::uint64_t>(rank, 1)) {
+            return getBucketUpperBound(i);
+        }
+    }
+    return getBucketUpperBound(BUCKET_COUNT - 1);
+}
+
+std::chrono::microseconds LatencyHistogram::Snapshot::getMean() const {
+    if (count == 0) {
+        return std::chrono::microseconds(0);
+    }
+    return sum / static_cast<std::int64_t>(count);
+}
+
+static std::string formatDuration(std::chrono::microseconds duration) {
+    if (duration == std::chrono::microseconds::max()) {
+        return "inf";
+    }
+    if (duration < std::chrono::milliseconds(1)) {
+        return fmt::format("{}us", duration.count());
+    }
+    return fmt::format("{:.1f}ms", static_cast<double>(duration.count()) / 1000);
+}
+
+std::string LatencyHistogram::Snapshot::toString() const {
+    return fmt::format(
+        "n={} mean={} p50={} p99={}",
+        count,
+        formatDuration(getMean()),
+        formatDuration(getQuantile(0.5)),
+        formatDuration(getQuantile(0.99))
+    );
+}
@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// A lock-free histogram of durations. Bucket i counts the durations below 2^i microseconds, the last bucket counts
+/// everything else.
+class LatencyHistogram {
+public:
+    static constexpr std::size_t BUCKET_COUNT = 28;
+
+    struct Snapshot {
+        std::array<std::uint64_t, BUCKET_COUNT> buckets{};
+        std::uint64_t count = 0;
+        std::chrono::microseconds sum{0};
+
+        /// Returns the upper bound of the bucket containing the given quantile, quantile is in [0, 1].
+        std::chrono::microseconds getQuantile(double quantile) const;
+        std::chrono::microseconds getMean() const;
+        /// Returns a string like "n=10 mean=1.2ms p50=1.0ms p99=4.1ms".
+        std::string toString() const;
+    };
+
+    void record(std::chrono::microseconds duration);
+    Snapshot getSnapshot() const;
+
+    /// Upper bound of the bucket, or microseconds::max() for the last one.
+    static std::chrono::microseconds getBucketUpperBound(std::size_t bucket);
+
+private:
+    std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets{};
+    std::atomic<std::uint64_t> count = 0;
+    std::atomic<std::int64_t> sumMicroseconds = 0;
+};
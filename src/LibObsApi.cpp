@@ -0,0 +1,483 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "LibObsApi.h"
+
+#include <obs-module.h>
+#include <obs.hpp>
+#include <util/darray.h>
+#include <util/threading.h>
+
+#include <utility>
+
+#include "Log.h"
+
+void logMessage(int logLevel, const std::string& message) {
+    blog(logLevel, "[RewardsTheater] %s", message.c_str());
+}
+
+LibObsApi::LibObsApi(config_t* config) : config(config) {}
+
+LibObsApi::~LibObsApi() = default;
+
+bool LibObsApi::getConfigBool(const char* section, const char* name) {
+    return config_get_bool(config, section, name);
+}
+
+std::int64_t LibObsApi::getConfigInt(const char* section, const char* name) {
+    return config_get_int(config, section, name);
+}
+
+std::uint64_t LibObsApi::getConfigUint(const char* section, const char* name) {
+    return config_get_uint(config, section, name);
+}
+
+double LibObsApi::getConfigDouble(const char* section, const char* name) {
+    return config_get_double(config, section, name);
+}
+
+std::string LibObsApi::getConfigString(const char* section, const char* name) {
+    std::lock_guard lock(configStringMutex);
+    const char* value = config_get_string(config, section, name);
+    return value == nullptr ? "" : value;
+}
+
+void LibObsApi::setConfigBool(const char* section, const char* name, bool value) {
+    config_set_bool(config, section, name, value);
+}
+
+void LibObsApi::setConfigInt(const char* section, const char* name, std::int64_t value) {
+    config_set_int(config, section, name, value);
+}
+
+void LibObsApi::setConfigUint(const char* section, const char* name, std::uint64_t value) {
+    config_set_uint(config, section, name, value);
+}
+
+void LibObsApi::setConfigDouble(const char* section, const char* name, double value) {
+    config_set_double(config, section, name, value);
+}
+
+void LibObsApi::setConfigString(const char* section, const char* name, const char* value) {
+    std::lock_guard lock(configStringMutex);
+    config_set_string(config, section, name, value);
+}
+
+void LibObsApi::setConfigDefaultBool(const char* section, const char* name, bool value) {
+    config_set_default_bool(config, section, name, value);
+}
+
+void LibObsApi::setConfigDefaultInt(const char* section, const char* name, std::int64_t value) {
+    config_set_default_int(config, section, name, value);
+}
+
+void LibObsApi::setConfigDefaultUint(const char* section, const char* name, std::uint64_t value) {
+    config_set_default_uint(config, section, name, value);
+}
+
+void LibObsApi::setConfigDefaultDouble(const char* section, const char* name, double value) {
+    config_set_default_double(config, section, name, value);
+}
+
+void LibObsApi::setConfigDefaultString(const char* section, const char* name, const char* value) {
+    std::lock_guard lock(configStringMutex);
+    config_set_default_string(config, section, name, value);
+}
+
+bool LibObsApi::hasConfigUserValue(const char* section, const char* name) {
+    return config_has_user_value(config, section, name);
+}
+
+void LibObsApi::removeConfigValue(const char* section, const char* name) {
+    std::lock_guard lock(configStringMutex);
+    config_remove_value(config, section, name);
+}
+
+std::string LibObsApi::getLocaleText(const char* key) {
+    return obs_module_text(key);
+}
+
+ObsSourceRef LibObsApi::getSourceByName(const std::string& name) {
+    return makeSourceRef(obs_get_source_by_name(name.c_str()));
+}
+
+std::vector<ObsSourceRef> LibObsApi::enumSources() {
+    std::vector<ObsSourceRef> sources;
+
+    struct AddToSourcesCallback {
+        static bool addToSources(void* param, obs_source_t* source) {
+            auto& sources = *static_cast<std::vector<ObsSourceRef>*>(param);
+            ObsSourceRef sourceRef = makeSourceRef(obs_source_get_ref(source));
+            if (sourceRef) {
+                sources.push_back(std::move(sourceRef));
+            }
+            return true;
+        }
+    };
+
+    obs_enum_sources(&AddToSourcesCallback::addToSources, &sources);
+    return sources;
+}
+
+std::string LibObsApi::getSourceName(obs_source_t* source) {
+    return obs_source_get_name(source);
+}
+
+std::string LibObsApi::getSourceUuid(obs_source_t* source) {
+    return obs_source_get_uuid(source);
+}
+
+std::string LibObsApi::getSourceId(obs_source_t* source) {
+    return obs_source_get_id(source);
+}
+
+boost::json::object LibObsApi::getSourceSettings(obs_source_t* source) {
+    OBSDataAutoRelease sourceSettings = obs_source_get_settings(source);
+    if (!sourceSettings) {
+        return {};
+    }
+    boost::system::error_code errorCode;
+    boost::json::value settings = boost::json::parse(obs_data_get_json_with_defaults(sourceSettings), errorCode);
+    if (errorCode || !settings.is_object()) {
+        log(LOG_ERROR, "Could not parse the settings of source {}", obs_source_get_name(source));
+        return {};
+    }
+    return std::move(settings.as_object());
+}
+
+void LibObsApi::updateSourceSettings(obs_source_t* source, const boost::json::object& settings) {
+    OBSDataAutoRelease newSettings = obs_data_create_from_json(boost::json::serialize(settings).c_str());
+    obs_source_update(source, newSettings);
+}
+
+ObsSourceRef LibObsApi::duplicateSource(obs_source_t* source, const std::string& name) {
+    return makeSourceRef(obs_source_duplicate(source, name.c_str(), true));
+}
+
+ObsSourceRef LibObsApi::createPrivateSource(
+    const std::string& id,
+    const std::string& name,
+    const boost::json::object& settings
+) {
+    OBSDataAutoRelease sourceSettings = obs_data_create_from_json(boost::json::serialize(settings).c_str());
+    return makeSourceRef(obs_source_create_private(id.c_str(), name.c_str(), sourceSettings));
+}
+
+void LibObsApi::setSourceMuted(obs_source_t* source, bool muted) {
+    obs_source_set_muted(source, muted);
+}
+
+bool LibObsApi::isSourceActive(obs_source_t* source) {
+    return obs_source_active(source);
+}
+
+std::pair<std::uint32_t, std::uint32_t> LibObsApi::getSourceSize(obs_source_t* source) {
+    return {obs_source_get_width(source), obs_source_get_height(source)};
+}
+
+std::optional<std::pair<std::uint32_t, std::uint32_t>> LibObsApi::getSourceFrameSize(obs_source_t* source) {
+    // The size of an async source is only updated when it's rendered, so look at the decoded frame instead.
+    obs_source_frame* frame = obs_source_get_frame(source);
+    if (!frame) {
+        return std::nullopt;
+    }
+    std::pair<std::uint32_t, std::uint32_t> frameSize{frame->width, frame->height};
+    obs_source_release_frame(source, frame);
+    if (frameSize.first == 0 || frameSize.second == 0) {
+        return std::nullopt;
+    }
+    return frameSize;
+}
+
+void LibObsApi::restartMedia(obs_source_t* source) {
+    obs_source_media_restart(source);
+}
+
+void LibObsApi::stopMedia(obs_source_t* source) {
+    obs_source_media_stop(source);
+}
+
+std::int64_t LibObsApi::getMediaDurationMilliseconds(obs_source_t* source) {
+    return obs_source_media_get_duration(source);
+}
+
+class LibObsSignalConnection : public ObsApi::SignalConnection {
+public:
+    LibObsSignalConnection(obs_source_t* source, const std::string& signalName, std::function<void()> callback)
+        : callback(std::move(callback)), signalName(signalName),
+          signal(obs_source_get_signal_handler(source), this->signalName.c_str(), &LibObsSignalConnection::call, this) {
+    }
+
+private:
+    static void call(void* param, [[maybe_unused]] calldata_t* data) {
+        static_cast<LibObsSignalConnection*>(param)->callback();
+    }
+
+    std::function<void()> callback;
+    // OBSSignal keeps the pointer to the name.
+    std::string signalName;
+    OBSSignal signal;
+};
+
+std::unique_ptr<ObsApi::SignalConnection> LibObsApi::connectSourceSignal(
+    obs_source_t* source,
+    const std::string& signal,
+    std::function<void()> callback
+) {
+    return std::make_unique<LibObsSignalConnection>(source, signal, std::move(callback));
+}
+
+// See https://github.com/obsproject/obs-studio/blob/a1fbf1015f4079b79dc9ef4f6abecf67920e93cf/libobs/obs-internal.h#L547
+struct obs_context_data {
+    char* name;
+    const char* uuid;
+    void* data;
+    // Other fields
+};
+
+// See https://github.com/obsproject/obs-studio/blob/a1fbf1015f4079b79dc9ef4f6abecf67920e93cf/libobs/obs-internal.h#L693
+struct obs_source {
+    struct obs_context_data context;
+    // Other fields
+};
+
+// See
+// https://github.com/obsproject/obs-studio/blob/a1fbf1015f4079b79dc9ef4f6abecf67920e93cf/plugins/vlc-video/vlc-video-source.c#L56
+typedef DARRAY(struct media_file_data) media_file_array_t;
+
+struct vlc_source {
+    obs_source_t* source;
+
+    void* media_player;
+    libvlc_media_list_player_t* media_list_player;
+
+    struct obs_source_frame frame;
+    struct obs_source_audio audio;
+    size_t audio_capacity;
+
+    pthread_mutex_t mutex;
+    media_file_array_t files;
+    // Other fields
+};
+
+static vlc_source* getVlcSourceData(obs_source_t* source) {
+    if (!source) {
+        return nullptr;
+    }
+    obs_source* sourceInternal = reinterpret_cast<obs_source*>(source);
+    void* data = sourceInternal->context.data;
+    if (!data) {
+        return nullptr;
+    }
+    vlc_source* vlcSource = static_cast<vlc_source*>(data);
+    return vlcSource;
+}
+
+bool LibObsApi::isVlcAvailable() {
+    std::call_once(libVlcLoadedFlag, [this]() {
+        try {
+            libVlc.emplace();
+        } catch (const LibVlc::VlcLibraryLoadingError&) {
+            // LibVlc has already logged the reason.
+        }
+    });
+    return libVlc.has_value();
+}
+
+std::size_t LibObsApi::getVlcPlaylistSize(obs_source_t* source) {
+    vlc_source* vlcSource = getVlcSourceData(source);
+    if (!vlcSource) {
+        log(LOG_ERROR, "Could not get VLC player from source");
+        return 0;
+    }
+    pthread_mutex_lock(&vlcSource->mutex);
+    std::size_t size = vlcSource->files.num;
+    pthread_mutex_unlock(&vlcSource->mutex);
+    return size;
+}
+
+void LibObsApi::playVlcPlaylistItem(obs_source_t* source, std::size_t index) {
+    if (!isVlcAvailable()) {
+        log(LOG_ERROR, "Cannot play VLC Source because libvlc wasn't loaded");
+        return;
+    }
+    vlc_source* vlcSource = getVlcSourceData(source);
+    if (!vlcSource || !vlcSource->media_list_player) {
+        log(LOG_ERROR, "Could not get VLC player from source");
+        return;
+    }
+    libVlc->libvlc_media_list_player_play_item_at_index(vlcSource->media_list_player, static_cast<int>(index));
+}
+
+std::pair<std::uint32_t, std::uint32_t> LibObsApi::getBaseVideoSize() {
+    obs_video_info obsVideoInfo;
+    obs_get_video_info(&obsVideoInfo);
+    return {obsVideoInfo.base_width, obsVideoInfo.base_height};
+}
+
+std::vector<ObsApi::SceneItem> LibObsApi::findSceneItems(obs_source_t* source) {
+    struct FindSceneItemsCallback {
+        const char* sourceName;
+        std::vector<SceneItem> sceneItems = {};
+
+        static bool findSceneItemOnScene(void* param, obs_source_t* sceneSource) {
+            auto& [sourceName, sceneItems] = *static_cast<FindSceneItemsCallback*>(param);
+            obs_scene_t* scene = obs_scene_from_source(sceneSource);
+            obs_sceneitem_t* sceneItem = obs_scene_find_source_recursive(scene, sourceName);
+            if (!sceneItem) {
+                return true;
+            }
+            obs_sceneitem_addref(sceneItem);
+            sceneItems.push_back(
+                {makeSceneRef(obs_scene_get_ref(scene)), obs_source_get_uuid(sceneSource), makeSceneItemRef(sceneItem)}
+            );
+            return true;
+        }
+    } callback{obs_source_get_name(source)};
+
+    obs_enum_scenes(&FindSceneItemsCallback::findSceneItemOnScene, &callback);
+    return std::move(callback.sceneItems);
+}
+
+ObsApi::Vec2 LibObsApi::getSceneItemPosition(const SceneItem& sceneItem) {
+    vec2 position;
+    obs_sceneitem_get_pos(sceneItem.sceneItem.get(), &position);
+
+    obs_scene_item* parentGroup = obs_sceneitem_get_group(sceneItem.scene.get(), sceneItem.sceneItem.get());
+    if (parentGroup) {
+        vec2 parentPosition, parentScale;
+        obs_sceneitem_get_pos(parentGroup, &parentPosition);
+        obs_sceneitem_get_scale(parentGroup, &parentScale);
+
+        vec2_mul(&position, &position, &parentScale);
+        vec2_add(&position, &position, &parentPosition);
+    }
+    return {position.x, position.y};
+}
+
+ObsApi::Vec2 LibObsApi::getSceneItemScale(const SceneItem& sceneItem) {
+    vec2 scale;
+    obs_sceneitem_get_scale(sceneItem.sceneItem.get(), &scale);
+    obs_scene_item* parentGroup = obs_sceneitem_get_group(sceneItem.scene.get(), sceneItem.sceneItem.get());
+    if (parentGroup) {
+        vec2 parentScale;
+        obs_sceneitem_get_scale(parentGroup, &parentScale);
+        vec2_mul(&scale, &scale, &parentScale);
+    }
+    return {scale.x, scale.y};
+}
+
+ObsApi::Crop LibObsApi::getSceneItemCrop(obs_sceneitem_t* sceneItem) {
+    obs_sceneitem_crop crop;
+    obs_sceneitem_get_crop(sceneItem, &crop);
+    return {crop.left, crop.top, crop.right, crop.bottom};
+}
+
+std::optional<std::chrono::milliseconds> LibObsApi::getSceneItemTransitionDuration(
+    obs_sceneitem_t* sceneItem,
+    bool show
+) {
+    if (!obs_sceneitem_get_transition(sceneItem, show)) {
+        return std::nullopt;
+    }
+    return std::chrono::milliseconds(obs_sceneitem_get_transition_duration(sceneItem, show));
+}
+
+void LibObsApi::updateSceneItems(obs_scene_t* scene, const std::vector<SceneItemUpdate>& updates) {
+    struct SceneUpdate {
+        std::vector<SceneItemUpdate> sceneItemUpdates;
+
+        static void apply(void* param, [[maybe_unused]] obs_scene_t* scene) {
+            auto& sceneUpdate = *static_cast<SceneUpdate*>(param);
+            for (const SceneItemUpdate& update : sceneUpdate.sceneItemUpdates) {
+                obs_sceneitem_t* sceneItem = update.sceneItem.get();
+                if (update.removeHideTransition) {
+                    obs_sceneitem_set_transition(sceneItem, false, nullptr);
+                }
+                if (update.position.has_value()) {
+                    vec2 position{update.position->x, update.position->y};
+                    obs_sceneitem_set_pos(sceneItem, &position);
+                }
+                if (update.visible.has_value()) {
+                    obs_sceneitem_set_visible(sceneItem, update.visible.value());
+                }
+            }
+        }
+    } sceneUpdate{updates};
+
+    // The positions of the items in groups are relative to the group.
+    for (SceneItemUpdate& update : sceneUpdate.sceneItemUpdates) {
+        obs_scene_item* parentGroup = obs_sceneitem_get_group(scene, update.sceneItem.get());
+        if (!update.position.has_value() || !parentGroup) {
+            continue;
+        }
+        vec2 position{update.position->x, update.position->y};
+        vec2 parentPosition, parentScale;
+        obs_sceneitem_get_pos(parentGroup, &parentPosition);
+        obs_sceneitem_get_scale(parentGroup, &parentScale);
+
+        vec2_sub(&position, &position, &parentPosition);
+        vec2_div(&position, &position, &parentScale);
+        update.position = Vec2{position.x, position.y};
+    }
+    obs_scene_atomic_update(scene, &SceneUpdate::apply, &sceneUpdate);
+}
+
+ObsSceneItemRef LibObsApi::addSceneItemCopy(obs_sceneitem_t* originalItem, obs_source_t* source) {
+    // The item may be in a group, which is a scene too.
+    obs_scene_t* itemScene = obs_sceneitem_get_scene(originalItem);
+    if (obs_scene_find_source(itemScene, obs_source_get_name(source))) {
+        return {};
+    }
+
+    obs_sceneitem_t* item = obs_scene_add(itemScene, source);
+    obs_sceneitem_set_visible(item, false);
+    obs_transform_info info;
+    obs_sceneitem_get_info2(originalItem, &info);
+    obs_sceneitem_set_info2(item, &info);
+    obs_sceneitem_crop crop;
+    obs_sceneitem_get_crop(originalItem, &crop);
+    obs_sceneitem_set_crop(item, &crop);
+    obs_sceneitem_set_scale_filter(item, obs_sceneitem_get_scale_filter(originalItem));
+    obs_sceneitem_set_blending_method(item, obs_sceneitem_get_blending_method(originalItem));
+    obs_sceneitem_set_blending_mode(item, obs_sceneitem_get_blending_mode(originalItem));
+    for (bool show : {true, false}) {
+        obs_source_t* transition = obs_sceneitem_get_transition(originalItem, show);
+        if (transition) {
+            OBSSourceAutoRelease transitionDuplicate =
+                obs_source_duplicate(transition, obs_source_get_name(transition), true);
+            obs_sceneitem_set_transition(item, show, transitionDuplicate);
+            obs_sceneitem_set_transition_duration(
+                item, show, obs_sceneitem_get_transition_duration(originalItem, show)
+            );
+        }
+    }
+    obs_sceneitem_set_order_position(item, obs_sceneitem_get_order_position(originalItem) + 1);
+    obs_sceneitem_addref(item);
+    return makeSceneItemRef(item);
+}
+
+void LibObsApi::removeSceneItem(obs_sceneitem_t* sceneItem) {
+    obs_sceneitem_remove(sceneItem);
+}
+
+ObsSourceRef LibObsApi::makeSourceRef(obs_source_t* source) {
+    if (!source) {
+        return {};
+    }
+    return ObsSourceRef(source, obs_source_release);
+}
+
+ObsSceneRef LibObsApi::makeSceneRef(obs_scene_t* scene) {
+    if (!scene) {
+        return {};
+    }
+    return ObsSceneRef(scene, obs_scene_release);
+}
+
+ObsSceneItemRef LibObsApi::makeSceneItemRef(obs_sceneitem_t* sceneItem) {
+    if (!sceneItem) {
+        return {};
+    }
+    return ObsSceneItemRef(sceneItem, obs_sceneitem_release);
+}
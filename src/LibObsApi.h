@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <util/config-file.h>
+
+#include <mutex>
+#include <optional>
+
+#include "LibVlc.h"
+#include "ObsApi.h"
+
+/// ObsApi on top of libobs and the config of the OBS frontend.
+class LibObsApi : public ObsApi {
+public:
+    LibObsApi(config_t* config);
+    ~LibObsApi() override;
+
+    bool getConfigBool(const char* section, const char* name) override;
+    std::int64_t getConfigInt(const char* section, const char* name) override;
+    std::uint64_t getConfigUint(const char* section, const char* name) override;
+    double getConfigDouble(const char* section, const char* name) override;
+    std::string getConfigString(const char* section, const char* name) override;
+    void setConfigBool(const char* section, const char* name, bool value) override;
+    void setConfigInt(const char* section, const char* name, std::int64_t value) override;
+    void setConfigUint(const char* section, const char* name, std::uint64_t value) override;
+    void setConfigDouble(const char* section, const char* name, double value) override;
+    void setConfigString(const char* section, const char* name, const char* value) override;
+    void setConfigDefaultBool(const char* section, const char* name, bool value) override;
+    void setConfigDefaultInt(const char* section, const char* name, std::int64_t value) override;
+    void setConfigDefaultUint(const char* section, const char* name, std::uint64_t value) override;
+    void setConfigDefaultDouble(const char* section, const char* name, double value) override;
+    void setConfigDefaultString(const char* section, const char* name, const char* value) override;
+    bool hasConfigUserValue(const char* section, const char* name) override;
+    void removeConfigValue(const char* section, const char* name) override;
+
+    std::string getLocaleText(const char* key) override;
+
+    ObsSourceRef getSourceByName(const std::string& name) override;
+    std::vector<ObsSourceRef> enumSources() override;
+    std::string getSourceName(obs_source_t* source) override;
+    std::string getSourceUuid(obs_source_t* source) override;
+    std::string getSourceId(obs_source_t* source) override;
+    boost::json::object getSourceSettings(obs_source_t* source) override;
+    void updateSourceSettings(obs_source_t* source, const boost::json::object& settings) override;
+    ObsSourceRef duplicateSource(obs_source_t* source, const std::string& name) override;
+    ObsSourceRef createPrivateSource(
+        const std::string& id,
+        const std::string& name,
+        const boost::json::object& settings
+    ) override;
+    void setSourceMuted(obs_source_t* source, bool muted) override;
+    bool isSourceActive(obs_source_t* source) override;
+    std::pair<std::uint32_t, std::uint32_t> getSourceSize(obs_source_t* source) override;
+    std::optional<std::pair<std::uint32_t, std::uint32_t>> getSourceFrameSize(obs_source_t* source) override;
+
+    void restartMedia(obs_source_t* source) override;
+    void stopMedia(obs_source_t* source) override;
+    std::int64_t getMediaDurationMilliseconds(obs_source_t* source) override;
+
+    std::unique_ptr<SignalConnection> connectSourceSignal(
+        obs_source_t* source,
+        const std::string& signal,
+        std::function<void()> callback
+    ) override;
+
+    bool isVlcAvailable() override;
+    std::size_t getVlcPlaylistSize(obs_source_t* source) override;
+    void playVlcPlaylistItem(obs_source_t* source, std::size_t index) override;
+
+    std::pair<std::uint32_t, std::uint32_t> getBaseVideoSize() override;
+    std::vector<SceneItem> findSceneItems(obs_source_t* source) override;
+    Vec2 getSceneItemPosition(const SceneItem& sceneItem) override;
+    Vec2 getSceneItemScale(const SceneItem& sceneItem) override;
+    Crop getSceneItemCrop(obs_sceneitem_t* sceneItem) override;
+    std::optional<std::chrono::milliseconds> getSceneItemTransitionDuration(
+        obs_sceneitem_t* sceneItem,
+        bool show
+    ) override;
+    void updateSceneItems(obs_scene_t* scene, const std::vector<SceneItemUpdate>& updates) override;
+    ObsSceneItemRef addSceneItemCopy(obs_sceneitem_t* sceneItem, obs_source_t* source) override;
+    void removeSceneItem(obs_sceneitem_t* sceneItem) override;
+
+private:
+    static ObsSourceRef makeSourceRef(obs_source_t* source);
+    static ObsSceneRef makeSceneRef(obs_scene_t* scene);
+    static ObsSceneItemRef makeSceneItemRef(obs_sceneitem_t* sceneItem);
+
+    config_t* config;
+    // config_get_string returns a char* which we copy to a std::string.
+    // But that char* can be freed - therefore we need a mutex for string get/set operations.
+    std::mutex configStringMutex;
+    std::optional<LibVlc> libVlc;
+    std::once_flag libVlcLoadedFlag;
+};
@@ -29,14 +29,6 @@ LibVlc::~LibVlc() {
     unload();
 }
 
-const std::optional<LibVlc> LibVlc::createSafe() {
-    try {
-        return std::make_optional<LibVlc>();
-    } catch (const VlcLibraryLoadingError &) {
-        return {};
-    }
-}
-
 const char *LibVlc::VlcLibraryLoadingError::what() const noexcept {
     return "VlcLibraryLoadingError";
 }
@@ -5,7 +5,6 @@
 #pragma once
 
 #include <exception>
-#include <optional>
 
 typedef void libvlc_media_list_player_t;
 
@@ -15,8 +14,6 @@ public:
     ~LibVlc();
     LibVlc(const LibVlc&) = delete;
 
-    static const std::optional<LibVlc> createSafe();
-
     const char* (*libvlc_get_version)();
     int (*libvlc_media_list_player_play_item_at_index)(libvlc_media_list_player_t* p_mlp, int i_index);
 
@@ -4,11 +4,26 @@
 #pragma once
 
 #include <fmt/core.h>
-#include <util/base.h>
 
+#include <string>
 #include <utility>
 
+#if __has_include(<util/base.h>)
+#include <util/base.h>
+#else
+// The same levels as in util/base.h, for the builds without libobs.
+enum {
+    LOG_ERROR = 100,
+    LOG_WARNING = 200,
+    LOG_INFO = 300,
+    LOG_DEBUG = 400,
+};
+#endif
+
+/// Writes the message to the OBS log. Defined by the plugin, and by the tests and benchmarks, which write to stderr.
+void logMessage(int logLevel, const std::string& message);
+
 template <typename... T>
-inline void log(decltype(LOG_DEBUG) logLevel, fmt::format_string<T...> fmt, T&&... args) {
-    blog(logLevel, "[RewardsTheater] %s", fmt::format(fmt, std::forward<T>(args)...).c_str());
+inline void log(int logLevel, fmt::format_string<T...> fmt, T&&... args) {
+    logMessage(logLevel, fmt::format(fmt, std::forward<T>(args)...));
 }
@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "MediaIndex.h"
+
+#include <algorithm>
+#include <array>
+#include <boost/json.hpp>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <system_error>
+#include <utility>
+
+#include "Log.h"
+
+namespace asio = boost::asio;
+namespace json = boost::json;
+
+// The extensions that the OBS Media Source offers in its file dialog.
+static const std::array VIDEO_EXTENSIONS =
+    {".mp4", ".m4v", ".ts", ".mov", ".mxf", ".flv", ".mkv", ".avi", ".gif", ".webm", ".mpg", ".mpeg", ".wmv"};
+
+MediaIndex::MediaIndex(std::filesystem::path indexPath, IoThreadPool::Strand executor)
+    : indexPath(std::move(indexPath)), executor(executor), saveScheduled(false), randomEngine(std::random_device()()) {
+    load();
+}
+
+MediaIndex::~MediaIndex() {
+    std::string index;
+    {
+        std::lock_guard guard(mutex);
+        if (!saveScheduled) {
+            return;
+        }
+        index = serialize();
+    }
+    save(index);
+}
+
+std::vector<std::string> MediaIndex::getFiles(const std::string& directory) {
+    scanIfChanged(directory);
+    std::lock_guard guard(mutex);
+    return directories[directory].files;
+}
+
+asio::awaitable<std::optional<std::string>> MediaIndex::asyncPickFile(std::string directory) {
+    bool isKnown;
+    {
+        std::lock_guard guard(mutex);
+        isKnown = directories.contains(directory);
+    }
+    if (isKnown) {
+        rescanInBackground(directory);
+    } else {
+        co_await asio::co_spawn(
+            executor,
+            [this, directory]() -> asio::awaitable<void> {
+                scanIfChanged(directory);
+                co_return;
+            },
+            asio::use_awaitable
+        );
+    }
+
+    std::lock_guard guard(mutex);
+    DirectoryEntry& directoryEntry = directories[directory];
+    if (directoryEntry.files.empty()) {
+        co_return std::nullopt;
+    }
+    if (directoryEntry.shuffleBag.empty()) {
+        directoryEntry.shuffleBag.resize(directoryEntry.files.size());
+        for (std::size_t i = 0; i < directoryEntry.files.size(); i++) {
+            directoryEntry.shuffleBag[i] = i;
+        }
+    }
+    std::uniform_int_distribution<std::size_t> randomIndex(0, directoryEntry.shuffleBag.size() - 1);
+    std::size_t index = randomIndex(randomEngine);
+    std::size_t fileIndex = directoryEntry.shuffleBag[index];
+    std::swap(directoryEntry.shuffleBag[index], directoryEntry.shuffleBag.back());
+    directoryEntry.shuffleBag.pop_back();
+    co_return directoryEntry.files[fileIndex];
+}
+
+std::optional<MediaInfo> MediaIndex::getMediaInfo(const std::string& file) const {
+    std::filesystem::path path = pathFromUtf8(file);
+    std::error_code errorCode;
+    std::uintmax_t size = std::filesystem::file_size(path, errorCode);
+    if (errorCode) {
+        return std::nullopt;
+    }
+    std::int64_t modificationTime = getModificationTime(path);
+
+    std::lock_guard guard(mutex);
+    auto it = files.find(file);
+    if (it == files.end() || size != it->second.size || modificationTime != it->second.modificationTime) {
+        return std::nullopt;
+    }
+    return it->second.mediaInfo;
+}
+
+void MediaIndex::setMediaInfo(const std::string& file, const MediaInfo& mediaInfo) {
+    std::filesystem::path path = pathFromUtf8(file);
+    std::error_code errorCode;
+    std::uintmax_t size = std::filesystem::file_size(path, errorCode);
+    if (errorCode) {
+        return;
+    }
+    std::lock_guard guard(mutex);
+    files[file] = FileEntry{getModificationTime(path), size, mediaInfo};
+    scheduleSave();
+}
+
+void MediaIndex::scanIfChanged(const std::string& directory) {
+    std::int64_t modificationTime = getModificationTime(pathFromUtf8(directory));
+    {
+        std::lock_guard guard(mutex);
+        auto it = directories.find(directory);
+        if (it != directories.end() && it->second.modificationTime == modificationTime) {
+            return;
+        }
+    }
+    std::vector<ScannedFile> scannedFiles = listVideoFiles(directory);
+
+    std::lock_guard guard(mutex);
+    DirectoryEntry& directoryEntry = directories[directory];
+    std::set<std::string> oldFiles(directoryEntry.files.begin(), directoryEntry.files.end());
+    std::vector<std::string> newFiles;
+    for (ScannedFile& scannedFile : scannedFiles) {
+        FileEntry& fileEntry = files[scannedFile.file];
+        if (fileEntry.modificationTime != scannedFile.modificationTime || fileEntry.size != scannedFile.size) {
+            fileEntry = FileEntry{scannedFile.modificationTime, scannedFile.size, std::nullopt};
+        }
+        oldFiles.erase(scannedFile.file);
+        newFiles.push_back(std::move(scannedFile.file));
+    }
+    for (const std::string& removedFile : oldFiles) {
+        files.erase(removedFile);
+    }
+
+    std::sort(newFiles.begin(), newFiles.end());
+    log(LOG_INFO, "Found {} videos in {}", newFiles.size(), directory);
+    directoryEntry = DirectoryEntry{modificationTime, std::move(newFiles), {}};
+    scheduleSave();
+}
+
+std::vector<MediaIndex::ScannedFile> MediaIndex::listVideoFiles(const std::string& directory) {
+    std::vector<ScannedFile> scannedFiles;
+    std::error_code errorCode;
+    for (const auto& entry : std::filesystem::directory_iterator(pathFromUtf8(directory), errorCode)) {
+        std::error_code fileErrorCode;
+        if (!entry.is_regular_file(fileErrorCode) || !isVideoFile(entry.path())) {
+            continue;
+        }
+        std::uintmax_t size = entry.file_size(fileErrorCode);
+        if (fileErrorCode) {
+            continue;
+        }
+        scannedFiles.push_back({pathToUtf8(entry.path()), getModificationTime(entry.path()), size});
+    }
+    if (errorCode) {
+        log(LOG_WARNING, "Could not scan video directory {}: {}", directory, errorCode.message());
+    }
+    return scannedFiles;
+}
+
+void MediaIndex::rescanInBackground(const std::string& directory) {
+    std::lock_guard guard(mutex);
+    if (!rescansScheduled.insert(directory).second) {
+        return;
+    }
+    asio::post(executor, [this, directory]() {
+        {
+            std::lock_guard guard(mutex);
+            rescansScheduled.erase(directory);
+        }
+        scanIfChanged(directory);
+    });
+}
+
+bool MediaIndex::isVideoFile(const std::filesystem::path& file) {
+    std::string extension = pathToUtf8(file.extension());
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return std::find(VIDEO_EXTENSIONS.begin(), VIDEO_EXTENSIONS.end(), extension) != VIDEO_EXTENSIONS.end();
+}
+
+std::int64_t MediaIndex::getModificationTime(const std::filesystem::path& path) {
+    std::error_code errorCode;
+    std::filesystem::file_time_type modificationTime = std::filesystem::last_write_time(path, errorCode);
+    if (errorCode) {
+        return -1;
+    }
+    return static_cast<std::int64_t>(modificationTime.time_since_epoch().count());
+}
+
+std::filesystem::path MediaIndex::pathFromUtf8(const std::string& path) {
+    return std::filesystem::path(std::u8string(path.begin(), path.end()));
+}
+
+std::string MediaIndex::pathToUtf8(const std::filesystem::path& path) {
+    std::u8string result = path.u8string();
+    return std::string(result.begin(), result.end());
+}
+
+void MediaIndex::scheduleSave() {
+    if (saveScheduled || indexPath.empty()) {
+        return;
+    }
+    saveScheduled = true;
+    asio::post(executor, [this]() {
+        std::string index;
+        {
+            std::lock_guard guard(mutex);
+            saveScheduled = false;
+            index = serialize();
+        }
+        save(index);
+    });
+}
+
+void MediaIndex::load() {
+    std::ifstream indexFile(indexPath, std::ios::binary);
+    if (!indexFile) {
+        return;
+    }
+    try {
+        std::stringstream contents;
+        contents << indexFile.rdbuf();
+        json::value index = json::parse(contents.str());
+        for (const auto& [directory, directoryJson] : index.at("directories").as_object()) {
+            DirectoryEntry& directoryEntry = directories[directory];
+            directoryEntry.modificationTime = value_to<std::int64_t>(directoryJson.at("mtime"));
+            directoryEntry.files = value_to<std::vector<std::string>>(directoryJson.at("files"));
+        }
+        for (const auto& [file, fileJson] : index.at("files").as_object()) {
+            FileEntry& fileEntry = files[file];
+            fileEntry.modificationTime = value_to<std::int64_t>(fileJson.at("mtime"));
+            fileEntry.size = value_to<std::uintmax_t>(fileJson.at("size"));
+            if (fileJson.as_object().contains("width")) {
+                fileEntry.mediaInfo = MediaInfo{
+                    value_to<std::uint32_t>(fileJson.at("width")),
+                    value_to<std::uint32_t>(fileJson.at("height")),
+                    std::chrono::milliseconds(value_to<std::int64_t>(fileJson.at("duration"))),
+                };
+            }
+        }
+    } catch (const std::exception& exception) {
+        log(LOG_WARNING, "Could not load the media index, it will be rebuilt: {}", exception.what());
+        directories.clear();
+        files.clear();
+    }
+}
+
+std::string MediaIndex::serialize() const {
+    json::object directoriesJson;
+    for (const auto& [directory, directoryEntry] : directories) {
+        directoriesJson[directory] = {
+            {"mtime", directoryEntry.modificationTime},
+            {"files", json::value_from(directoryEntry.files)},
+        };
+    }
+    json::object filesJson;
+    for (const auto& [file, fileEntry] : files) {
+        json::object fileJson{{"mtime", fileEntry.modificationTime}, {"size", fileEntry.size}};
+        if (fileEntry.mediaInfo.has_value()) {
+            fileJson["width"] = fileEntry.mediaInfo->width;
+            fileJson["height"] = fileEntry.mediaInfo->height;
+            fileJson["duration"] = fileEntry.mediaInfo->duration.count();
+        }
+        filesJson[file] = std::move(fileJson);
+    }
+    json::object index{{"directories", std::move(directoriesJson)}, {"files", std::move(filesJson)}};
+    return json::serialize(index);
+}
+
+void MediaIndex::save(const std::string& index) const {
+    std::filesystem::path temporaryPath = indexPath;
+    temporaryPath += ".tmp";
+    {
+        std::ofstream indexFile(temporaryPath, std::ios::binary | std::ios::trunc);
+        indexFile << index;
+        if (!indexFile) {
+            log(LOG_ERROR, "Could not write the media index to {}", pathToUtf8(temporaryPath));
+            return;
+        }
+    }
+    std::error_code errorCode;
+    std::filesystem::rename(temporaryPath, indexPath, errorCode);
+    if (errorCode) {
+        log(LOG_ERROR, "Could not save the media index: {}", errorCode.message());
+    }
+}
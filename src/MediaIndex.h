@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "BoostAsio.h"
+#include "IoThreadPool.h"
+
+struct MediaInfo {
+    std::uint32_t width;
+    std::uint32_t height;
+    /// Zero if the duration is unknown.
+    std::chrono::milliseconds duration;
+};
+
+/// The videos in the directories that rewards are mapped to, together with their dimensions and durations once they
+/// are known. The index is kept in a JSON file, so that a directory doesn't need to be scanned again at startup unless
+/// it has changed. The information about a file is keyed by its path, modification time and size. All paths are UTF-8.
+/// If the index path is empty, the index is only kept in memory. Thread-safe.
+class MediaIndex {
+public:
+    MediaIndex(std::filesystem::path indexPath, IoThreadPool::Strand executor);
+    ~MediaIndex();
+
+    /// Returns the videos in the directory, scanning it first if it has changed. Blocks on the file system.
+    std::vector<std::string> getFiles(const std::string& directory);
+
+    /// Picks a random video from the directory. Every video is picked once before any video is picked again. Returns
+    /// std::nullopt if there are no videos in the directory. Only the first pick from a directory waits for it to be
+    /// scanned, later picks use the known videos and rescan the directory in the background, so the caller's strand
+    /// doesn't block on the file system.
+    boost::asio::awaitable<std::optional<std::string>> asyncPickFile(std::string directory);
+
+    /// Returns std::nullopt if the file is unknown or has changed since its information was saved.
+    std::optional<MediaInfo> getMediaInfo(const std::string& file) const;
+    void setMediaInfo(const std::string& file, const MediaInfo& mediaInfo);
+
+    static std::filesystem::path pathFromUtf8(const std::string& path);
+    static std::string pathToUtf8(const std::filesystem::path& path);
+
+private:
+    struct FileEntry {
+        std::int64_t modificationTime = -1;
+        std::uintmax_t size = 0;
+        std::optional<MediaInfo> mediaInfo;
+    };
+
+    struct DirectoryEntry {
+        std::int64_t modificationTime = -1;
+        std::vector<std::string> files;
+        /// Indices of the files that haven't been picked since the bag was last refilled.
+        std::vector<std::size_t> shuffleBag;
+    };
+
+    struct ScannedFile {
+        std::string file;
+        std::int64_t modificationTime;
+        std::uintmax_t size;
+    };
+
+    /// Doesn't hold the mutex while the directory is listed.
+    void scanIfChanged(const std::string& directory);
+    static std::vector<ScannedFile> listVideoFiles(const std::string& directory);
+    void rescanInBackground(const std::string& directory);
+    static bool isVideoFile(const std::filesystem::path& file);
+    static std::int64_t getModificationTime(const std::filesystem::path& path);
+    void scheduleSave();
+    void load();
+    /// Must be called with the mutex held.
+    std::string serialize() const;
+    /// Doesn't need the mutex, so that the file system isn't accessed under it.
+    void save(const std::string& index) const;
+
+    const std::filesystem::path indexPath;
+    IoThreadPool::Strand executor;
+    std::map<std::string, DirectoryEntry> directories;
+    std::map<std::string, FileEntry> files;
+    std::set<std::string> rescansScheduled;
+    bool saveScheduled;
+    std::default_random_engine randomEngine;
+    mutable std::mutex mutex;
+};
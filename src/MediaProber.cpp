@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "MediaProber.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#include "Log.h"
+
+namespace asio = boost::asio;
+
+MediaProber::MediaProber(ObsApi& obsApi, MediaIndex& mediaIndex, IoThreadPool::Strand executor)
+    : obsApi(obsApi), mediaIndex(mediaIndex), executor(executor), probing(false) {}
+
+void MediaProber::probeInBackground(
+    const std::string& obsSourceName,
+    const std::optional<std::string>& mediaDirectory
+) {
+    asio::post(executor, [this, obsSourceName, mediaDirectory]() {
+        ObsSourceRef source = obsApi.getSourceByName(obsSourceName);
+        if (source) {
+            queueFiles(getSourceFiles(obsApi.getSourceId(source.get()), obsApi.getSourceSettings(source.get())));
+        }
+        if (mediaDirectory.has_value()) {
+            queueFiles(mediaIndex.getFiles(mediaDirectory.value()));
+        }
+    });
+}
+
+static std::string getStringSetting(const boost::json::object& settings, const char* name) {
+    const boost::json::value* value = settings.if_contains(name);
+    if (!value || !value->is_string()) {
+        return "";
+    }
+    return std::string(value->get_string());
+}
+
+std::vector<std::string> MediaProber::getSourceFiles(
+    const std::string& sourceId,
+    const boost::json::object& sourceSettings
+) {
+    if (sourceId != "vlc_source") {
+        std::string file = getStringSetting(sourceSettings, "local_file");
+        const boost::json::value* isLocalFile = sourceSettings.if_contains("is_local_file");
+        if (!isLocalFile || !isLocalFile->is_bool() || !isLocalFile->get_bool() || file.empty()) {
+            return {};
+        }
+        return {file};
+    }
+
+    std::vector<std::string> files;
+    const boost::json::value* playlist = sourceSettings.if_contains("playlist");
+    if (!playlist || !playlist->is_array()) {
+        return {};
+    }
+    for (const boost::json::value& playlistItem : playlist->get_array()) {
+        if (!playlistItem.is_object()) {
+            return {};
+        }
+        std::string file = getStringSetting(playlistItem.get_object(), "value");
+        std::error_code errorCode;
+        if (!std::filesystem::is_regular_file(MediaIndex::pathFromUtf8(file), errorCode)) {
+            // The VLC source expands directories into several videos, so the indices wouldn't match.
+            return {};
+        }
+        files.push_back(std::move(file));
+    }
+    return files;
+}
+
+void MediaProber::queueFiles(const std::vector<std::string>& files) {
+    for (const std::string& file : files) {
+        if (mediaIndex.getMediaInfo(file).has_value() || queuedFileSet.contains(file)) {
+            continue;
+        }
+        queuedFiles.push_back(file);
+        queuedFileSet.insert(file);
+    }
+    if (!probing && !queuedFiles.empty()) {
+        probing = true;
+        asio::co_spawn(executor, asyncProbeQueuedFiles(), asio::detached);
+    }
+}
+
+asio::awaitable<void> MediaProber::asyncProbeQueuedFiles() {
+    while (!queuedFiles.empty()) {
+        std::string file = queuedFiles.front();
+        std::optional<MediaInfo> mediaInfo = co_await asyncProbeFile(file);
+        if (mediaInfo.has_value()) {
+            mediaIndex.setMediaInfo(file, mediaInfo.value());
+        }
+        queuedFiles.pop_front();
+        queuedFileSet.erase(file);
+    }
+    probing = false;
+}
+
+asio::awaitable<std::optional<MediaInfo>> MediaProber::asyncProbeFile(const std::string& file) {
+    boost::json::object sourceSettings{
+        {"is_local_file", true},
+        {"local_file", file},
+        {"looping", false},
+        // Otherwise the source would only start decoding once it's shown.
+        {"restart_on_activate", false},
+        {"close_when_inactive", false},
+    };
+    ObsSourceRef source = obsApi.createPrivateSource("ffmpeg_source", "RewardsTheater probe", sourceSettings);
+    if (!source) {
+        co_return std::nullopt;
+    }
+    obsApi.setSourceMuted(source.get(), true);
+
+    auto deadline = std::chrono::steady_clock::now() + PROBE_TIMEOUT;
+    asio::steady_timer timer(executor);
+    while (std::chrono::steady_clock::now() < deadline) {
+        timer.expires_after(PROBE_POLL_INTERVAL);
+        co_await timer.async_wait(asio::use_awaitable);
+        std::optional<std::pair<std::uint32_t, std::uint32_t>> frameSize = obsApi.getSourceFrameSize(source.get());
+        if (!frameSize.has_value()) {
+            continue;
+        }
+        std::int64_t durationMilliseconds = obsApi.getMediaDurationMilliseconds(source.get());
+        auto [width, height] = frameSize.value();
+        log(LOG_INFO, "Probed {}: {}x{}, {} ms", file, width, height, durationMilliseconds);
+        co_return MediaInfo{width, height, std::chrono::milliseconds(std::max<std::int64_t>(0, durationMilliseconds))};
+    }
+    log(LOG_WARNING, "Could not probe {} in time", file);
+    co_return std::nullopt;
+}
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <boost/json.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BoostAsio.h"
+#include "IoThreadPool.h"
+#include "MediaIndex.h"
+#include "ObsApi.h"
+
+/// Finds out the dimensions and durations of videos before they are played, so that random positioning works on the
+/// first play too. A video is probed by decoding it with a private muted Media Source that is never shown. The results
+/// are saved in the MediaIndex, so every file is only probed once (or again after it changes).
+class MediaProber {
+public:
+    MediaProber(ObsApi& obsApi, MediaIndex& mediaIndex, IoThreadPool::Strand executor);
+
+    /// Probes the videos of the source and of the media directory (if set) that aren't in the media index yet.
+    void probeInBackground(const std::string& obsSourceName, const std::optional<std::string>& mediaDirectory);
+
+    /// The local files that the Media Source or VLC Video Source plays, in playlist order. Empty if they can't be
+    /// matched to the playlist indices.
+    static std::vector<std::string> getSourceFiles(
+        const std::string& sourceId,
+        const boost::json::object& sourceSettings
+    );
+
+private:
+    static constexpr std::chrono::milliseconds PROBE_POLL_INTERVAL{50};
+    static constexpr std::chrono::milliseconds PROBE_TIMEOUT{5000};
+
+    void queueFiles(const std::vector<std::string>& files);
+    boost::asio::awaitable<void> asyncProbeQueuedFiles();
+    boost::asio::awaitable<std::optional<MediaInfo>> asyncProbeFile(const std::string& file);
+
+    ObsApi& obsApi;
+    MediaIndex& mediaIndex;
+    IoThreadPool::Strand executor;
+    // Only accessed on the executor.
+    std::deque<std::string> queuedFiles;
+    std::set<std::string> queuedFileSet;
+    bool probing;
+};
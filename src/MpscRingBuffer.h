@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+/// A bounded lock-free queue with any number of producers and a single consumer. Each slot has a sequence number that
+/// tells whether it's free for the producer of the current lap or holds a value for the consumer, so producers never
+/// wait for each other or for the consumer.
+template <typename T, std::size_t Capacity>
+class MpscRingBuffer {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpscRingBuffer() {
+        for (std::size_t i = 0; i < Capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+    /// Returns false if the buffer is full. Can be called from any thread.
+    bool tryPush(T value) {
+        std::size_t position = pushPosition.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[position & (Capacity - 1)];
+            std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (difference == 0) {
+                // The slot is free. On failure, position is updated to the current value.
+                if (pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                // The consumer hasn't taken the value from the previous lap yet.
+                return false;
+            } else {
+                // Another producer has taken the slot.
+                position = pushPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Must only be called by the consumer.
+    std::optional<T> tryPop() {
+        Slot& slot = slots[popPosition & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != popPosition + 1) {
+            // Empty, or a producer is still writing the value.
+            return std::nullopt;
+        }
+        std::optional<T> value = std::move(slot.value);
+        slot.value = T{};
+        slot.sequence.store(popPosition + Capacity, std::memory_order_release);
+        popPosition++;
+        return value;
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::array<Slot, Capacity> slots;
+    alignas(64) std::atomic<std::size_t> pushPosition = 0;
+    // Only accessed by the consumer.
+    alignas(64) std::size_t popPosition = 0;
+};
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <boost/json.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Declared the same way as in libobs, whose headers the core library doesn't include.
+struct obs_source;
+struct obs_scene;
+struct obs_scene_item;
+typedef struct obs_source obs_source_t;
+typedef struct obs_scene obs_scene_t;
+typedef struct obs_scene_item obs_sceneitem_t;
+
+/// Releases the reference once the last copy is destructed. Empty if there's no such object.
+using ObsSourceRef = std::shared_ptr<obs_source_t>;
+using ObsSceneRef = std::shared_ptr<obs_scene_t>;
+using ObsSceneItemRef = std::shared_ptr<obs_sceneitem_t>;
+
+/// Everything that the core library needs from OBS: the config, the sources and the scenes. The plugin implements it
+/// with libobs (see LibObsApi), and the tests implement it in memory, so that the queue can run without OBS.
+///
+/// The methods may be called from any thread, like the libobs functions they stand for.
+class ObsApi {
+public:
+    virtual ~ObsApi() = default;
+
+    // The config, see util/config-file.h. A string that doesn't exist is returned as "". As with config_get_string,
+    // a string must not be read while it's changed on another thread.
+    virtual bool getConfigBool(const char* section, const char* name) = 0;
+    virtual std::int64_t getConfigInt(const char* section, const char* name) = 0;
+    virtual std::uint64_t getConfigUint(const char* section, const char* name) = 0;
+    virtual double getConfigDouble(const char* section, const char* name) = 0;
+    virtual std::string getConfigString(const char* section, const char* name) = 0;
+    virtual void setConfigBool(const char* section, const char* name, bool value) = 0;
+    virtual void setConfigInt(const char* section, const char* name, std::int64_t value) = 0;
+    virtual void setConfigUint(const char* section, const char* name, std::uint64_t value) = 0;
+    virtual void setConfigDouble(const char* section, const char* name, double value) = 0;
+    virtual void setConfigString(const char* section, const char* name, const char* value) = 0;
+    virtual void setConfigDefaultBool(const char* section, const char* name, bool value) = 0;
+    virtual void setConfigDefaultInt(const char* section, const char* name, std::int64_t value) = 0;
+    virtual void setConfigDefaultUint(const char* section, const char* name, std::uint64_t value) = 0;
+    virtual void setConfigDefaultDouble(const char* section, const char* name, double value) = 0;
+    virtual void setConfigDefaultString(const char* section, const char* name, const char* value) = 0;
+    virtual bool hasConfigUserValue(const char* section, const char* name) = 0;
+    virtual void removeConfigValue(const char* section, const char* name) = 0;
+
+    /// The translation from the locale files of the plugin.
+    virtual std::string getLocaleText(const char* key) = 0;
+
+    virtual ObsSourceRef getSourceByName(const std::string& name) = 0;
+    /// The sources that aren't scenes, like obs_enum_sources.
+    virtual std::vector<ObsSourceRef> enumSources() = 0;
+    virtual std::string getSourceName(obs_source_t* source) = 0;
+    virtual std::string getSourceUuid(obs_source_t* source) = 0;
+    /// The type of the source, e.g. "ffmpeg_source".
+    virtual std::string getSourceId(obs_source_t* source) = 0;
+    /// The settings of the source, including the defaults.
+    virtual boost::json::object getSourceSettings(obs_source_t* source) = 0;
+    /// Applies the settings on top of the current ones, like obs_source_update.
+    virtual void updateSourceSettings(obs_source_t* source, const boost::json::object& settings) = 0;
+    /// A private copy of the source that isn't saved with the scene collection. Empty on failure.
+    virtual ObsSourceRef duplicateSource(obs_source_t* source, const std::string& name) = 0;
+    /// A private source that isn't saved with the scene collection. Empty on failure.
+    virtual ObsSourceRef createPrivateSource(
+        const std::string& id,
+        const std::string& name,
+        const boost::json::object& settings
+    ) = 0;
+    virtual void setSourceMuted(obs_source_t* source, bool muted) = 0;
+    /// Whether the source is shown on the program output.
+    virtual bool isSourceActive(obs_source_t* source) = 0;
+    /// The size as it's rendered. Zero while it isn't known.
+    virtual std::pair<std::uint32_t, std::uint32_t> getSourceSize(obs_source_t* source) = 0;
+    /// The size of the last decoded frame of an async source, which is known before the source is rendered.
+    virtual std::optional<std::pair<std::uint32_t, std::uint32_t>> getSourceFrameSize(obs_source_t* source) = 0;
+
+    virtual void restartMedia(obs_source_t* source) = 0;
+    virtual void stopMedia(obs_source_t* source) = 0;
+    /// -1 if it isn't known.
+    virtual std::int64_t getMediaDurationMilliseconds(obs_source_t* source) = 0;
+
+    /// Disconnects the callback once destructed.
+    class SignalConnection {
+    public:
+        virtual ~SignalConnection() = default;
+    };
+    /// Calls the callback on an OBS thread every time the source emits the signal, e.g. "media_started".
+    virtual std::unique_ptr<SignalConnection> connectSourceSignal(
+        obs_source_t* source,
+        const std::string& signal,
+        std::function<void()> callback
+    ) = 0;
+
+    /// Loads libvlc the first time it's needed, so that it doesn't slow down the OBS startup. Returns false if it
+    /// couldn't be loaded.
+    virtual bool isVlcAvailable() = 0;
+    /// The number of videos in the playlist of a VLC Video Source.
+    virtual std::size_t getVlcPlaylistSize(obs_source_t* source) = 0;
+    /// Plays the video at the index of the playlist of a VLC Video Source.
+    virtual void playVlcPlaylistItem(obs_source_t* source, std::size_t index) = 0;
+
+    struct Vec2 {
+        float x;
+        float y;
+    };
+
+    struct Crop {
+        int left;
+        int top;
+        int right;
+        int bottom;
+    };
+
+    /// The base (canvas) resolution.
+    virtual std::pair<std::uint32_t, std::uint32_t> getBaseVideoSize() = 0;
+
+    struct SceneItem {
+        /// The scene that was enumerated. The item may be in a group inside of it.
+        ObsSceneRef scene;
+        std::string sceneUuid;
+        ObsSceneItemRef sceneItem;
+    };
+    /// The item of the source in every scene, including the ones in groups.
+    virtual std::vector<SceneItem> findSceneItems(obs_source_t* source) = 0;
+    /// In the coordinates of the scene, even if the item is in a group.
+    virtual Vec2 getSceneItemPosition(const SceneItem& sceneItem) = 0;
+    /// Relative to the scene, even if the item is in a group.
+    virtual Vec2 getSceneItemScale(const SceneItem& sceneItem) = 0;
+    virtual Crop getSceneItemCrop(obs_sceneitem_t* sceneItem) = 0;
+    /// std::nullopt if the item has no such transition.
+    virtual std::optional<std::chrono::milliseconds> getSceneItemTransitionDuration(
+        obs_sceneitem_t* sceneItem,
+        bool show
+    ) = 0;
+
+    struct SceneItemUpdate {
+        ObsSceneItemRef sceneItem;
+        bool removeHideTransition = false;
+        /// In the coordinates of the scene, even if the item is in a group.
+        std::optional<Vec2> position;
+        std::optional<bool> visible;
+    };
+    /// Applies the updates of the items of the scene (and of its groups) in one frame: the transitions, then the
+    /// positions, then the visibility.
+    virtual void updateSceneItems(obs_scene_t* scene, const std::vector<SceneItemUpdate>& updates) = 0;
+
+    /// Adds a hidden item of the source next to the item, in the same scene or group, with the same transform, crop,
+    /// blending and transitions. Empty if the source is already there.
+    virtual ObsSceneItemRef addSceneItemCopy(obs_sceneitem_t* sceneItem, obs_source_t* source) = 0;
+    virtual void removeSceneItem(obs_sceneitem_t* sceneItem) = 0;
+};
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "PluginMetrics.h"
+
+void PluginMetrics::setRewardRedemptionQueueLength(std::size_t length) {
+    rewardRedemptionQueueLength.store(static_cast<std::int64_t>(length), std::memory_order_relaxed);
+}
+
+void PluginMetrics::onRewardRedeemed(const std::string& rewardId, const std::string& rewardTitle) {
+    RewardCounter* counter;
+    {
+        std::lock_guard guard(mapsMutex);
+        std::unique_ptr<RewardCounter>& counterPointer = rewardCounters[rewardId];
+        if (!counterPointer) {
+            counterPointer = std::make_unique<RewardCounter>();
+        }
+        // The title may have been changed since the last redemption.
+        counterPointer->rewardTitle = rewardTitle;
+        counter = counterPointer.get();
+    }
+    counter->count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PluginMetrics::onEventsubReconnect() {
+    eventsubReconnects.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PluginMetrics::onHttpConnectionOpened() {
+    httpConnectionsOpened.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PluginMetrics::onHttpRequestFinished(const std::string& endpoint, std::chrono::microseconds latency) {
+    httpRequests.fetch_add(1, std::memory_order_relaxed);
+    LatencyHistogram* histogram;
+    {
+        std::lock_guard guard(mapsMutex);
+        std::unique_ptr<LatencyHistogram>& histogramPointer = httpEndpointLatencies[endpoint];
+        if (!histogramPointer) {
+            histogramPointer = std::make_unique<LatencyHistogram>();
+        }
+        histogram = histogramPointer.get();
+    }
+    histogram->record(latency);
+}
+
+std::chrono::steady_clock::duration PluginMetrics::getTimeSinceStart() const {
+    return std::chrono::steady_clock::now() - startTime;
+}
+
+std::int64_t PluginMetrics::getRewardRedemptionQueueLength() const {
+    return rewardRedemptionQueueLength.load(std::memory_order_relaxed);
+}
+
+std::vector<PluginMetrics::RewardRedemptionCount> PluginMetrics::getRewardRedemptionCounts() const {
+    std::lock_guard guard(mapsMutex);
+    std::vector<RewardRedemptionCount> result;
+    for (const auto& [rewardId, counter] : rewardCounters) {
+        result.push_back({rewardId, counter->rewardTitle, counter->count.load(std::memory_order_relaxed)});
+    }
+    return result;
+}
+
+std::uint64_t PluginMetrics::getEventsubReconnects() const {
+    return eventsubReconnects.load(std::memory_order_relaxed);
+}
+
+std::uint64_t PluginMetrics::getHttpConnectionsOpened() const {
+    return httpConnectionsOpened.load(std::memory_order_relaxed);
+}
+
+std::uint64_t PluginMetrics::getHttpRequests() const {
+    return httpRequests.load(std::memory_order_relaxed);
+}
+
+std::vector<PluginMetrics::HttpEndpointLatency> PluginMetrics::getHttpEndpointLatencies() const {
+    std::lock_guard guard(mapsMutex);
+    std::vector<HttpEndpointLatency> result;
+    for (const auto& [endpoint, histogram] : httpEndpointLatencies) {
+        result.push_back({endpoint, histogram->getSnapshot()});
+    }
+    return result;
+}
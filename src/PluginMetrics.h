@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "LatencyHistogram.h"
+
+/// Counters updated by the plugin subsystems. Updating and reading them is cheap and never takes the locks of the
+/// subsystems themselves.
+class PluginMetrics {
+public:
+    void setRewardRedemptionQueueLength(std::size_t length);
+    void onRewardRedeemed(const std::string& rewardId, const std::string& rewardTitle);
+    void onEventsubReconnect();
+    void onHttpConnectionOpened();
+    void onHttpRequestFinished(const std::string& endpoint, std::chrono::microseconds latency);
+
+    struct RewardRedemptionCount {
+        std::string rewardId;
+        std::string rewardTitle;
+        std::uint64_t count;
+    };
+
+    struct HttpEndpointLatency {
+        std::string endpoint;
+        LatencyHistogram::Snapshot latency;
+    };
+
+    /// Time since the plugin was loaded.
+    std::chrono::steady_clock::duration getTimeSinceStart() const;
+    std::int64_t getRewardRedemptionQueueLength() const;
+    std::vector<RewardRedemptionCount> getRewardRedemptionCounts() const;
+    std::uint64_t getEventsubReconnects() const;
+    std::uint64_t getHttpConnectionsOpened() const;
+    std::uint64_t getHttpRequests() const;
+    std::vector<HttpEndpointLatency> getHttpEndpointLatencies() const;
+
+private:
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    struct RewardCounter {
+        std::string rewardTitle;
+        std::atomic<std::uint64_t> count = 0;
+    };
+
+    std::atomic<std::int64_t> rewardRedemptionQueueLength = 0;
+    std::atomic<std::uint64_t> eventsubReconnects = 0;
+    std::atomic<std::uint64_t> httpConnectionsOpened = 0;
+    std::atomic<std::uint64_t> httpRequests = 0;
+
+    // The maps only grow, so the mutex is only held to find or insert an element.
+    std::map<std::string, std::unique_ptr<RewardCounter>> rewardCounters;
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> httpEndpointLatencies;
+    mutable std::mutex mapsMutex;
+};
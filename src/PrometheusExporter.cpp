@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "PrometheusExporter.h"
+
+#include <fmt/format.h>
+
+#include <iterator>
+
+PrometheusExporter::PrometheusExporter(
+    const PluginMetrics& pluginMetrics,
+    const RedemptionTracer& redemptionTracer,
+    const IoThreadPool& ioThreadPool
+)
+    : pluginMetrics(pluginMetrics), redemptionTracer(redemptionTracer), ioThreadPool(ioThreadPool) {}
+
+static std::string escapeLabelValue(const std::string& value) {
+    std::string result;
+    for (char c : value) {
+        switch (c) {
+        case '\\': result += "\\\\"; break;
+        case '"': result += "\\\""; break;
+        case '\n': result += "\\n"; break;
+        default: result += c;
+        }
+    }
+    return result;
+}
+
+static void appendHeader(std::string& text, const char* name, const char* type, const char* help) {
+    fmt::format_to(std::back_inserter(text), "# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+}
+
+/// Appends the buckets, the sum and the count of a histogram. `labels` is either empty or ends with a comma.
+static void appendHistogram(
+    std::string& text,
+    const char* name,
+    const std::string& labels,
+    const LatencyHistogram::Snapshot& snapshot
+) {
+    std::uint64_t cumulativeCount = 0;
+    for (std::size_t i = 0; i + 1 < LatencyHistogram::BUCKET_COUNT; i++) {
+        cumulativeCount += snapshot.buckets[i];
+        double upperBoundSeconds = static_cast<double>(LatencyHistogram::getBucketUpperBound(i).count()) / 1e6;
+        fmt::format_to(
+            std::back_inserter(text), "{}_bucket{{{}le=\"{}\"}} {}\n", name, labels, upperBoundSeconds, cumulativeCount
+        );
+    }
+    fmt::format_to(std::back_inserter(text), "{}_bucket{{{}le=\"+Inf\"}} {}\n", name, labels, snapshot.count);
+
+    std::string sumLabels = labels.empty() ? "" : fmt::format("{{{}}}", labels.substr(0, labels.size() - 1));
+    double sumSeconds = static_cast<double>(snapshot.sum.count()) / 1e6;
+    fmt::format_to(std::back_inserter(text), "{}_sum{} {}\n", name, sumLabels, sumSeconds);
+    fmt::format_to(std::back_inserter(text), "{}_count{} {}\n", name, sumLabels, snapshot.count);
+}
+
+std::string PrometheusExporter::getMetricsText() const {
+    std::string text;
+    auto out = std::back_inserter(text);
+
+    appendHeader(
+        text,
+        "rewardstheater_queue_length",
+        "gauge",
+        "Number of reward redemptions in the queue, including the playing one."
+    );
+    fmt::format_to(out, "rewardstheater_queue_length {}\n", pluginMetrics.getRewardRedemptionQueueLength());
+
+    appendHeader(text, "rewardstheater_redemptions_total", "counter", "Reward redemptions received from EventSub.");
+    for (const PluginMetrics::RewardRedemptionCount& reward : pluginMetrics.getRewardRedemptionCounts()) {
+        fmt::format_to(
+            out,
+            "rewardstheater_redemptions_total{{reward_id=\"{}\",reward_title=\"{}\"}} {}\n",
+            escapeLabelValue(reward.rewardId),
+            escapeLabelValue(reward.rewardTitle),
+            reward.count
+        );
+    }
+
+    appendHeader(
+        text,
+        "rewardstheater_redemption_stage_seconds",
+        "histogram",
+        "Time from the previous stage of a reward redemption to this one."
+    );
+    for (const RedemptionTracer::StageLatency& stageLatency : redemptionTracer.getStageLatencies()) {
+        std::string labels = fmt::format("stage=\"{}\",", RedemptionTrace::getStageName(stageLatency.stage));
+        appendHistogram(text, "rewardstheater_redemption_stage_seconds", labels, stageLatency.latency);
+    }
+
+    appendHeader(
+        text,
+        "rewardstheater_redemption_time_to_visible_seconds",
+        "histogram",
+        "Time from the EventSub message timestamp to the video being visible."
+    );
+    appendHistogram(
+        text, "rewardstheater_redemption_time_to_visible_seconds", "", redemptionTracer.getTimeToVisibleLatency()
+    );
+
+    appendHeader(text, "rewardstheater_eventsub_reconnects_total", "counter", "EventSub connections that were lost.");
+    fmt::format_to(out, "rewardstheater_eventsub_reconnects_total {}\n", pluginMetrics.getEventsubReconnects());
+
+    appendHeader(
+        text, "rewardstheater_http_request_seconds", "histogram", "Latency of HTTPS requests, including connecting."
+    );
+    for (const PluginMetrics::HttpEndpointLatency& endpoint : pluginMetrics.getHttpEndpointLatencies()) {
+        std::string labels = fmt::format("endpoint=\"{}\",", escapeLabelValue(endpoint.endpoint));
+        appendHistogram(text, "rewardstheater_http_request_seconds", labels, endpoint.latency);
+    }
+
+    std::uint64_t connectionsOpened = pluginMetrics.getHttpConnectionsOpened();
+    std::uint64_t requests = pluginMetrics.getHttpRequests();
+    appendHeader(text, "rewardstheater_http_connections_opened_total", "counter", "HTTPS connections opened.");
+    fmt::format_to(out, "rewardstheater_http_connections_opened_total {}\n", connectionsOpened);
+    appendHeader(text, "rewardstheater_http_requests_total", "counter", "HTTPS requests finished.");
+    fmt::format_to(out, "rewardstheater_http_requests_total {}\n", requests);
+    appendHeader(
+        text,
+        "rewardstheater_http_connection_reuse_ratio",
+        "gauge",
+        "Share of HTTPS requests that didn't need a new connection."
+    );
+    double reuseRatio = 0;
+    if (requests > connectionsOpened) {
+        reuseRatio = static_cast<double>(requests - connectionsOpened) / static_cast<double>(requests);
+    }
+    fmt::format_to(out, "rewardstheater_http_connection_reuse_ratio {}\n", reuseRatio);
+
+    appendHeader(
+        text, "rewardstheater_executor_queued_handlers", "gauge", "Handlers submitted to an executor but not started."
+    );
+    std::vector<IoThreadPool::ExecutorMetricsSnapshot> executorMetrics = ioThreadPool.getExecutorMetrics();
+    for (const IoThreadPool::ExecutorMetricsSnapshot& executor : executorMetrics) {
+        fmt::format_to(
+            out,
+            "rewardstheater_executor_queued_handlers{{executor=\"{}\"}} {}\n",
+            executor.name,
+            executor.queuedHandlers
+        );
+    }
+    appendHeader(text, "rewardstheater_executor_handlers_total", "counter", "Handlers executed by an executor.");
+    for (const IoThreadPool::ExecutorMetricsSnapshot& executor : executorMetrics) {
+        fmt::format_to(
+            out,
+            "rewardstheater_executor_handlers_total{{executor=\"{}\"}} {}\n",
+            executor.name,
+            executor.executedHandlers
+        );
+    }
+    return text;
+}
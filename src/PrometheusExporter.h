@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <string>
+
+#include "IoThreadPool.h"
+#include "PluginMetrics.h"
+#include "RedemptionTracer.h"
+
+/// Formats the plugin metrics in the Prometheus text exposition format.
+/// See https://prometheus.io/docs/instrumenting/exposition_formats/
+class PrometheusExporter {
+public:
+    PrometheusExporter(
+        const PluginMetrics& pluginMetrics,
+        const RedemptionTracer& redemptionTracer,
+        const IoThreadPool& ioThreadPool
+    );
+
+    std::string getMetricsText() const;
+
+private:
+    const PluginMetrics& pluginMetrics;
+    const RedemptionTracer& redemptionTracer;
+    const IoThreadPool& ioThreadPool;
+};
@@ -3,43 +3,57 @@
 
 #pragma once
 
+#include <QCoreApplication>
+#include <QMetaObject>
 #include <QObject>
-#include <mutex>
-
-/// Calls a method on a QObject, or does nothing if the QObject no longer exists.
-class QObjectCallback : public QObject {
-    Q_OBJECT
+#include <QPointer>
+#include <concepts>
+#include <functional>
+#include <utility>
 
+/// Calls a function with the result of an asynchronous operation on the GUI thread, or does nothing if the receiver
+/// no longer exists. Must be constructed on the GUI thread; can be invoked from any thread.
+///
+/// No QObject is allocated per call: the receiver is tracked with a QPointer, which is only dereferenced on the GUI
+/// thread, where the receiver lives.
+template <typename Result>
+class QObjectCallback {
 public:
-    QObjectCallback(QObject* parent, QObject* receiver, const char* member)
-        : QObject(parent), receiver(receiver), member(member) {
-        connect(
-            receiver, &QObject::destroyed, this, &QObjectCallback::clearReceiver, Qt::ConnectionType::DirectConnection
-        );
-    }
+    using Function = std::function<void(const Result&)>;
 
-    template <typename Result>
-    void operator()(const char* typeName, const Result& result) {
-        qRegisterMetaType<Result>(typeName);
-        {
-            std::lock_guard guard(receiverMutex);
-            if (receiver) {
-                QMetaObject::invokeMethod(
-                    receiver, member, Qt::ConnectionType::QueuedConnection, QArgument(typeName, result)
-                );
-            }
-        }
-        deleteLater();
-    }
+    template <std::derived_from<QObject> Receiver>
+    QObjectCallback(Receiver* receiver, void (Receiver::*member)(Result))
+        : receiver(receiver), function([receiver, member](const Result& result) {
+              (receiver->*member)(result);
+          }) {}
 
-private slots:
-    void clearReceiver() {
-        std::lock_guard guard(receiverMutex);
-        receiver = nullptr;
+    template <std::derived_from<QObject> Receiver>
+    QObjectCallback(Receiver* receiver, void (Receiver::*member)(const Result&))
+        : receiver(receiver), function([receiver, member](const Result& result) {
+              (receiver->*member)(result);
+          }) {}
+
+    /// Compatibility with the string-based form. Calls the slot named `member` that accepts `typeName`.
+    QObjectCallback(QObject* receiver, const char* member, const char* typeName)
+        : receiver(receiver), function([receiver, member, typeName](const Result& result) {
+              QMetaObject::invokeMethod(
+                  receiver, member, Qt::ConnectionType::DirectConnection, QArgument<Result>(typeName, result)
+              );
+          }) {}
+
+    void operator()(Result result) const {
+        QMetaObject::invokeMethod(
+            QCoreApplication::instance(),
+            [receiver = receiver, function = function, result = std::move(result)]() {
+                if (receiver) {
+                    function(result);
+                }
+            },
+            Qt::ConnectionType::QueuedConnection
+        );
     }
 
 private:
-    QObject* receiver;
-    std::mutex receiverMutex;
-    const char* member;
+    QPointer<QObject> receiver;
+    Function function;
 };
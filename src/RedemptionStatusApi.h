@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Reward.h"
+
+/// The Twitch requests that RewardRedemptionQueue sends. Implemented by TwitchRewardsApi, and in memory by the tests.
+class RedemptionStatusApi {
+public:
+    virtual ~RedemptionStatusApi() = default;
+
+    enum class RedemptionStatus {
+        CANCELED,
+        FULFILLED,
+    };
+    virtual void updateRedemptionStatus(const RewardRedemption& rewardRedemption, RedemptionStatus status) = 0;
+    /// The redemptions must be of the same reward. They are updated in as few requests as possible.
+    virtual void updateRedemptionStatus(
+        const std::vector<RewardRedemption>& rewardRedemptions,
+        RedemptionStatus status
+    ) = 0;
+
+    /// Pauses or resumes the redemptions of the rewards on Twitch. The rewards are updated concurrently, but the
+    /// requests for one reward are sent one by one, so the last call wins.
+    virtual void setRewardsPaused(const std::vector<std::string>& rewardIds, bool paused) = 0;
+};
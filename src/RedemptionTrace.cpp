@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "RedemptionTrace.h"
+
+#include <charconv>
+#include <string_view>
+
+#include "RedemptionTracer.h"
+
+RedemptionTrace::RedemptionTrace(
+    RedemptionTracer& tracer,
+    const std::string& redemptionId,
+    const std::string& rewardTitle,
+    std::optional<std::chrono::system_clock::time_point> messageTimestamp,
+    std::chrono::steady_clock::time_point receivedAt
+)
+    : redemptionId(redemptionId), rewardTitle(rewardTitle), messageTimestamp(messageTimestamp), tracer(tracer),
+      receivedAt(receivedAt),
+      receivedAtSystem(std::chrono::system_clock::now() - (std::chrono::steady_clock::now() - receivedAt)) {
+    stamp(Stage::FRAME_RECEIVED, receivedAt);
+}
+
+const char* RedemptionTrace::getStageName(Stage stage) {
+    switch (stage) {
+    case Stage::FRAME_RECEIVED: return "FrameReceived";
+    case Stage::PARSED: return "Parsed";
+    case Stage::ENQUEUED: return "Enqueued";
+    case Stage::DEQUEUED: return "Dequeued";
+    case Stage::SOURCE_STARTED: return "SourceStarted";
+    case Stage::MEDIA_STARTED: return "MediaStarted";
+    case Stage::VISIBLE: return "Visible";
+    case Stage::ENDED: return "Ended";
+    case Stage::STATUS_ACKNOWLEDGED: return "StatusAcknowledged";
+    }
+    return "Unknown";
+}
+
+void RedemptionTrace::stamp(Stage stage, std::chrono::steady_clock::time_point time) {
+    std::chrono::steady_clock::rep expected = 0;
+    stageTimes[static_cast<std::size_t>(stage)].compare_exchange_strong(expected, time.time_since_epoch().count());
+}
+
+std::optional<std::chrono::steady_clock::time_point> RedemptionTrace::getStageTime(Stage stage) const {
+    std::chrono::steady_clock::rep ticks = stageTimes[static_cast<std::size_t>(stage)].load();
+    if (ticks == 0) {
+        return std::nullopt;
+    }
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(ticks));
+}
+
+std::optional<std::chrono::microseconds> RedemptionTrace::getTimeToVisible() const {
+    std::optional<std::chrono::steady_clock::time_point> visibleAt = getStageTime(Stage::VISIBLE);
+    if (!visibleAt.has_value()) {
+        return std::nullopt;
+    }
+    auto sentAt = messageTimestamp.value_or(receivedAtSystem);
+    return std::chrono::duration_cast<std::chrono::microseconds>(toSystemTime(visibleAt.value()) - sentAt);
+}
+
+void RedemptionTrace::finish() {
+    if (!finished.exchange(true)) {
+        tracer.onTraceFinished(shared_from_this());
+    }
+}
+
+std::chrono::system_clock::time_point RedemptionTrace::toSystemTime(std::chrono::steady_clock::time_point time) const {
+    return receivedAtSystem + std::chrono::duration_cast<std::chrono::system_clock::duration>(time - receivedAt);
+}
+
+template <typename T>
+static bool parseNumber(std::string_view& input, std::size_t length, T& result) {
+    if (input.size() < length) {
+        return false;
+    }
+    auto [end, error] = std::from_chars(input.data(), input.data() + length, result);
+    if (error != std::errc() || end != input.data() + length) {
+        return false;
+    }
+    input.remove_prefix(length);
+    return true;
+}
+
+static bool skipCharacter(std::string_view& input, char character) {
+    if (input.empty() || input.front() != character) {
+        return false;
+    }
+    input.remove_prefix(1);
+    return true;
+}
+
+std::optional<std::chrono::system_clock::time_point> RedemptionTrace::parseTimestamp(const std::string& timestamp) {
+    std::string_view input = timestamp;
+    int year;
+    unsigned month, day, hours, minutes, seconds;
+    if (!parseNumber(input, 4, year) || !skipCharacter(input, '-') || !parseNumber(input, 2, month) ||
+        !skipCharacter(input, '-') || !parseNumber(input, 2, day) || !skipCharacter(input, 'T') ||
+        !parseNumber(input, 2, hours) || !skipCharacter(input, ':') || !parseNumber(input, 2, minutes) ||
+        !skipCharacter(input, ':') || !parseNumber(input, 2, seconds)) {
+        return std::nullopt;
+    }
+
+    std::chrono::nanoseconds fraction{0};
+    if (skipCharacter(input, '.')) {
+        std::int64_t multiplier = 100'000'000;
+        while (!input.empty() && input.front() >= '0' && input.front() <= '9') {
+            fraction += std::chrono::nanoseconds((input.front() - '0') * multiplier);
+            multiplier /= 10;
+            input.remove_prefix(1);
+        }
+    }
+    if (input != "Z") {
+        return std::nullopt;
+    }
+
+    std::chrono::year_month_day date{std::chrono::year(year), std::chrono::month(month), std::chrono::day(day)};
+    if (!date.ok()) {
+        return std::nullopt;
+    }
+    auto time = std::chrono::sys_days(date) + std::chrono::hours(hours) + std::chrono::minutes(minutes) +
+                std::chrono::seconds(seconds) + fraction;
+    return std::chrono::time_point_cast<std::chrono::system_clock::duration>(time);
+}
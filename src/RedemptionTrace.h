@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+class RedemptionTracer;
+
+/// Timestamps of the stages that a reward redemption goes through, from the EventSub notification to the
+/// acknowledgement of its status by Twitch. Stages can be stamped from any thread.
+class RedemptionTrace : public std::enable_shared_from_this<RedemptionTrace> {
+public:
+    enum class Stage : std::size_t {
+        FRAME_RECEIVED,
+        PARSED,
+        ENQUEUED,
+        DEQUEUED,
+        SOURCE_STARTED,
+        MEDIA_STARTED,
+        VISIBLE,
+        ENDED,
+        STATUS_ACKNOWLEDGED,
+    };
+    static constexpr std::size_t STAGE_COUNT = 9;
+    static const char* getStageName(Stage stage);
+
+    RedemptionTrace(
+        RedemptionTracer& tracer,
+        const std::string& redemptionId,
+        const std::string& rewardTitle,
+        std::optional<std::chrono::system_clock::time_point> messageTimestamp,
+        std::chrono::steady_clock::time_point receivedAt
+    );
+
+    /// Only the first stamp of a stage is kept.
+    void stamp(Stage stage, std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now());
+    std::optional<std::chrono::steady_clock::time_point> getStageTime(Stage stage) const;
+    /// Time from the moment Twitch sent the notification to the moment the video became visible.
+    std::optional<std::chrono::microseconds> getTimeToVisible() const;
+    /// Reports the trace to the tracer. Does nothing if the trace is already finished.
+    void finish();
+
+    /// Converts a time of a stage to the wall clock, to compare it with messageTimestamp.
+    std::chrono::system_clock::time_point toSystemTime(std::chrono::steady_clock::time_point time) const;
+
+    /// Parses an RFC 3339 timestamp like "2023-07-19T14:56:51.634234626Z". Returns std::nullopt if it's malformed.
+    static std::optional<std::chrono::system_clock::time_point> parseTimestamp(const std::string& timestamp);
+
+    const std::string redemptionId;
+    const std::string rewardTitle;
+    /// When Twitch sent the notification, according to the Twitch clock.
+    const std::optional<std::chrono::system_clock::time_point> messageTimestamp;
+
+private:
+    RedemptionTracer& tracer;
+    const std::chrono::steady_clock::time_point receivedAt;
+    const std::chrono::system_clock::time_point receivedAtSystem;
+    // steady_clock ticks, 0 if the stage hasn't been stamped.
+    std::array<std::atomic<std::chrono::steady_clock::rep>, STAGE_COUNT> stageTimes{};
+    std::atomic<bool> finished = false;
+};
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "RedemptionTracer.h"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <boost/json.hpp>
+
+namespace json = boost::json;
+
+using Stage = RedemptionTrace::Stage;
+
+RedemptionTracer::RedemptionTracer(std::size_t maxSlowestTraces) : maxSlowestTraces(maxSlowestTraces) {}
+
+std::shared_ptr<RedemptionTrace> RedemptionTracer::startTrace(
+    const std::string& redemptionId,
+    const std::string& rewardTitle,
+    std::optional<std::chrono::system_clock::time_point> messageTimestamp,
+    std::chrono::steady_clock::time_point receivedAt
+) {
+    return std::make_shared<RedemptionTrace>(*this, redemptionId, rewardTitle, messageTimestamp, receivedAt);
+}
+
+static bool compareTimeToVisible(
+    const std::pair<std::chrono::microseconds, std::shared_ptr<const RedemptionTrace>>& a,
+    const std::pair<std::chrono::microseconds, std::shared_ptr<const RedemptionTrace>>& b
+) {
+    return a.first > b.first;
+}
+
+void RedemptionTracer::onTraceFinished(std::shared_ptr<const RedemptionTrace> trace) {
+    std::optional<std::chrono::system_clock::time_point> previousTime = trace->messageTimestamp;
+    for (std::size_t i = 0; i < RedemptionTrace::STAGE_COUNT; i++) {
+        std::optional<std::chrono::steady_clock::time_point> stageTime = trace->getStageTime(static_cast<Stage>(i));
+        if (!stageTime.has_value()) {
+            continue;
+        }
+        std::chrono::system_clock::time_point time = trace->toSystemTime(stageTime.value());
+        if (previousTime.has_value()) {
+            stageLatencies[i].record(std::chrono::duration_cast<std::chrono::microseconds>(time - *previousTime));
+        }
+        previousTime = time;
+    }
+
+    std::optional<std::chrono::microseconds> timeToVisible = trace->getTimeToVisible();
+    if (!timeToVisible.has_value()) {
+        return;
+    }
+    timeToVisibleLatency.record(timeToVisible.value());
+
+    std::lock_guard guard(slowestTracesMutex);
+    if (slowestTraces.size() == maxSlowestTraces) {
+        if (slowestTraces.front().first >= timeToVisible.value()) {
+            return;
+        }
+        std::pop_heap(slowestTraces.begin(), slowestTraces.end(), compareTimeToVisible);
+        slowestTraces.pop_back();
+    }
+    slowestTraces.emplace_back(timeToVisible.value(), std::move(trace));
+    std::push_heap(slowestTraces.begin(), slowestTraces.end(), compareTimeToVisible);
+}
+
+std::vector<RedemptionTracer::StageLatency> RedemptionTracer::getStageLatencies() const {
+    std::vector<StageLatency> result;
+    for (std::size_t i = 0; i < RedemptionTrace::STAGE_COUNT; i++) {
+        result.push_back({static_cast<Stage>(i), stageLatencies[i].getSnapshot()});
+    }
+    return result;
+}
+
+LatencyHistogram::Snapshot RedemptionTracer::getTimeToVisibleLatency() const {
+    return timeToVisibleLatency.getSnapshot();
+}
+
+std::vector<std::shared_ptr<const RedemptionTrace>> RedemptionTracer::getSlowestTraces() const {
+    std::vector<std::pair<std::chrono::microseconds, std::shared_ptr<const RedemptionTrace>>> traces;
+    {
+        std::lock_guard guard(slowestTracesMutex);
+        traces = slowestTraces;
+    }
+    std::sort(traces.begin(), traces.end(), compareTimeToVisible);
+
+    std::vector<std::shared_ptr<const RedemptionTrace>> result;
+    for (auto& [timeToVisible, trace] : traces) {
+        result.push_back(std::move(trace));
+    }
+    return result;
+}
+
+static std::int64_t toTraceTimestamp(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+static json::object makeCompleteEvent(
+    const char* name,
+    std::size_t threadId,
+    std::chrono::system_clock::time_point start,
+    std::chrono::system_clock::time_point end
+) {
+    return {
+        {"name", name},
+        {"ph", "X"},
+        {"pid", 1},
+        {"tid", threadId},
+        {"ts", toTraceTimestamp(start)},
+        {"dur", std::max<std::int64_t>(0, toTraceTimestamp(end) - toTraceTimestamp(start))},
+    };
+}
+
+std::string RedemptionTracer::exportChromeTrace() const {
+    json::array events;
+    std::vector<std::shared_ptr<const RedemptionTrace>> traces = getSlowestTraces();
+    for (std::size_t i = 0; i < traces.size(); i++) {
+        const RedemptionTrace& trace = *traces[i];
+        // Every trace gets its own row in the viewer.
+        std::size_t threadId = i + 1;
+        events.push_back(json::object{
+            {"name", "thread_name"},
+            {"ph", "M"},
+            {"pid", 1},
+            {"tid", threadId},
+            {"args", {{"name", fmt::format("{} ({})", trace.rewardTitle, trace.redemptionId)}}},
+        });
+
+        std::optional<std::chrono::system_clock::time_point> previousTime = trace.messageTimestamp;
+        for (std::size_t stage = 0; stage < RedemptionTrace::STAGE_COUNT; stage++) {
+            std::optional<std::chrono::steady_clock::time_point> stageTime =
+                trace.getStageTime(static_cast<Stage>(stage));
+            if (!stageTime.has_value()) {
+                continue;
+            }
+            std::chrono::system_clock::time_point time = trace.toSystemTime(stageTime.value());
+            if (previousTime.has_value()) {
+                const char* name = RedemptionTrace::getStageName(static_cast<Stage>(stage));
+                events.push_back(makeCompleteEvent(name, threadId, previousTime.value(), time));
+            }
+            previousTime = time;
+        }
+    }
+
+    json::object result{
+        {"traceEvents", std::move(events)},
+        {"displayTimeUnit", "ms"},
+    };
+    return json::serialize(result);
+}
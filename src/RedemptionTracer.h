@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "LatencyHistogram.h"
+#include "RedemptionTrace.h"
+
+/// Aggregates finished redemption traces into per-stage latency histograms and keeps the slowest of them.
+class RedemptionTracer {
+public:
+    RedemptionTracer(std::size_t maxSlowestTraces = 32);
+
+    std::shared_ptr<RedemptionTrace> startTrace(
+        const std::string& redemptionId,
+        const std::string& rewardTitle,
+        std::optional<std::chrono::system_clock::time_point> messageTimestamp,
+        std::chrono::steady_clock::time_point receivedAt
+    );
+    void onTraceFinished(std::shared_ptr<const RedemptionTrace> trace);
+
+    struct StageLatency {
+        RedemptionTrace::Stage stage;
+        /// Time since the previous stamped stage. For FRAME_RECEIVED, time since the message timestamp.
+        LatencyHistogram::Snapshot latency;
+    };
+    std::vector<StageLatency> getStageLatencies() const;
+    LatencyHistogram::Snapshot getTimeToVisibleLatency() const;
+
+    /// Returns the slowest traces by time to visible, slowest first.
+    std::vector<std::shared_ptr<const RedemptionTrace>> getSlowestTraces() const;
+    /// Exports the slowest traces in the Chrome trace event format, which can be opened in chrome://tracing or
+    /// https://ui.perfetto.dev.
+    std::string exportChromeTrace() const;
+
+private:
+    std::array<LatencyHistogram, RedemptionTrace::STAGE_COUNT> stageLatencies;
+    LatencyHistogram timeToVisibleLatency;
+
+    const std::size_t maxSlowestTraces;
+    // A min-heap by time to visible, so that the fastest of the kept traces is the one evicted.
+    std::vector<std::pair<std::chrono::microseconds, std::shared_ptr<const RedemptionTrace>>> slowestTraces;
+    mutable std::mutex slowestTracesMutex;
+};
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "ReplayRedemptionStatusApi.h"
+
+#include "Log.h"
+
+void ReplayRedemptionStatusApi::updateRedemptionStatus(
+    const RewardRedemption& rewardRedemption,
+    RedemptionStatus status
+) {
+    updateRedemptionStatus(std::vector{rewardRedemption}, status);
+}
+
+void ReplayRedemptionStatusApi::updateRedemptionStatus(
+    const std::vector<RewardRedemption>& rewardRedemptions,
+    RedemptionStatus status
+) {
+    log(LOG_DEBUG,
+        "Not sending the status {} of {} replayed redemptions to Twitch",
+        status == RedemptionStatus::FULFILLED ? "FULFILLED" : "CANCELED",
+        rewardRedemptions.size());
+    // Finish the traces like TwitchRewardsApi does, so that the replay can be traced too.
+    for (const RewardRedemption& rewardRedemption : rewardRedemptions) {
+        if (rewardRedemption.trace) {
+            rewardRedemption.trace->stamp(RedemptionTrace::Stage::STATUS_ACKNOWLEDGED);
+            rewardRedemption.trace->finish();
+        }
+    }
+}
+
+void ReplayRedemptionStatusApi::setRewardsPaused(const std::vector<std::string>& rewardIds, bool paused) {
+    log(LOG_INFO, "Not {} {} rewards on Twitch during the replay", paused ? "pausing" : "resuming", rewardIds.size());
+}
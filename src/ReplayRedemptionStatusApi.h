@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "RedemptionStatusApi.h"
+
+/// Used by the queue instead of TwitchRewardsApi while EventSub is replayed from a recording. The recorded
+/// redemptions were fulfilled or canceled on Twitch long ago, and pausing the rewards would affect the live channel,
+/// so the requests are only logged.
+class ReplayRedemptionStatusApi : public RedemptionStatusApi {
+public:
+    void updateRedemptionStatus(const RewardRedemption& rewardRedemption, RedemptionStatus status) override;
+    void updateRedemptionStatus(
+        const std::vector<RewardRedemption>& rewardRedemptions,
+        RedemptionStatus status
+    ) override;
+    void setRewardsPaused(const std::vector<std::string>& rewardIds, bool paused) override;
+};
@@ -3,19 +3,24 @@
 
 #include "Reward.h"
 
-#include <iomanip>
-#include <sstream>
+#include <fmt/format.h>
+
+#include <charconv>
+#include <ios>
 
 Color::Color(const std::string& hexColor) {
     if (hexColor.empty()) {
         red = green = blue = 0;
         return;
     }
-    std::string withoutHash = hexColor.substr(1);
-    std::istringstream iss(withoutHash);
-    iss.exceptions(std::istringstream::failbit | std::istringstream::badbit);
+    // Skip the leading '#'.
+    const char* begin = hexColor.data() + 1;
+    const char* end = hexColor.data() + hexColor.size();
     std::uint32_t color;
-    iss >> std::hex >> color;
+    auto [parsedEnd, errorCode] = std::from_chars(begin, end, color, 16);
+    if (errorCode != std::errc{} || parsedEnd != end) {
+        throw std::ios_base::failure("Invalid hex color: " + hexColor);
+    }
 
     red = (color >> 16) & 0xff;
     green = (color >> 8) & 0xff;
@@ -23,10 +28,7 @@ Color::Color(const std::string& hexColor) {
 }
 
 std::string Color::toHex() const {
-    std::stringstream stream;
-    stream << "#" << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(red) << std::setw(2)
-           << static_cast<int>(green) << std::setw(2) << static_cast<int>(blue);
-    return stream.str();
+    return fmt::format("#{:02x}{:02x}{:02x}", red, green, blue);
 }
 
 bool Color::operator==(const Color& other) const = default;
@@ -52,6 +54,9 @@ Reward::Reward(
       id(id), imageUrl(imageUrl), canManage(canManage) {}
 
 Reward::Reward(const Reward& reward, const RewardData& newRewardData)
-    : RewardData(newRewardData), id(reward.id), imageUrl(reward.imageUrl), canManage(reward.canManage) {}
+    : RewardData(newRewardData), id(reward.id), imageUrl(reward.imageUrl), canManage(reward.canManage),
+      isPaused(reward.isPaused) {}
 
-bool RewardRedemption::operator==(const RewardRedemption& other) const = default;
+bool RewardRedemption::operator==(const RewardRedemption& other) const {
+    return *reward == *other.reward && redemptionId == other.redemptionId;
+}
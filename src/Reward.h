@@ -4,10 +4,14 @@
 #pragma once
 
 #include <boost/url.hpp>
+#include <chrono>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 
+#include "RedemptionTrace.h"
+
 struct Color {
     std::uint8_t red;
     std::uint8_t green;
@@ -38,6 +42,8 @@ struct Reward : RewardData {
     std::string id;
     boost::urls::url imageUrl;
     bool canManage;
+    /// Whether the reward is paused on Twitch. Only known for the rewards loaded from Helix.
+    bool isPaused = false;
 
     bool operator==(const Reward& other) const;
 
@@ -59,8 +65,13 @@ struct Reward : RewardData {
 };
 
 struct RewardRedemption {
-    Reward reward;
+    /// Shared with the other redemptions of the same reward, see RewardRegistry. Never null.
+    std::shared_ptr<const Reward> reward;
     std::string redemptionId;
+    /// Null if the redemption isn't traced. Not taken into account by operator==.
+    std::shared_ptr<RedemptionTrace> trace;
+    /// Not taken into account by operator==.
+    std::chrono::steady_clock::time_point receivedAt;
 
     bool operator==(const RewardRedemption& other) const;
 };
@@ -3,13 +3,14 @@
 
 #include "RewardRedemptionQueue.h"
 
-#include <util/darray.h>
-#include <util/threading.h>
+#include <fmt/core.h>
 
 #include <algorithm>
+#include <array>
 #include <boost/system/system_error.hpp>
+#include <cmath>
 #include <cstdint>
-#include <cstring>
+#include <iterator>
 #include <utility>
 
 #include "ConditionVariable.h"
@@ -18,47 +19,124 @@
 namespace asio = boost::asio;
 using namespace std::chrono_literals;
 
-RewardRedemptionQueue::RewardRedemptionQueue(Settings& settings, TwitchRewardsApi& twitchRewardsApi)
-    : settings(settings), twitchRewardsApi(twitchRewardsApi), rewardRedemptionQueueThread(1),
-      ioContext(rewardRedemptionQueueThread.ioContext), rewardPlaybackPaused(false),
-      rewardRedemptionQueueCondVar(ioContext, POS_INFINITY), playObsSourceState(0), libVlc(LibVlc::createSafe()),
+RewardRedemptionQueue::RewardRedemptionQueue(
+    ObsApi& obsApi,
+    Settings& settings,
+    RedemptionStatusApi& redemptionStatusApi,
+    PluginMetrics& pluginMetrics,
+    MediaIndex& mediaIndex,
+    MediaProber& mediaProber,
+    IoThreadPool::Strand executor
+)
+    : obsApi(obsApi), settings(settings), redemptionStatusApi(redemptionStatusApi), pluginMetrics(pluginMetrics),
+      mediaIndex(mediaIndex), mediaProber(mediaProber), executor(executor),
+      incomingRewardRedemptionsDrainScheduled(false), rewardPlaybackPaused(false),
+      rewardRedemptionQueueCondVar(executor, POS_INFINITY), queueBusyDuration(0), playedRewardRedemptionCount(0),
+      redemptionCountState(0), backpressureActive(false),
+      rewardIdsPausedOnTwitch(settings.getRewardIdsPausedOnTwitch()), playObsSourceState(0),
+      sourcePool(obsApi, settings),
       randomEngine(std::random_device()()) {
-    asio::co_spawn(ioContext, asyncPlayRewardRedemptionsFromQueue(), asio::detached);
+    asio::co_spawn(executor, asyncPlayRewardRedemptionsFromQueue(), asio::detached);
 }
 
-RewardRedemptionQueue::~RewardRedemptionQueue() {
-    rewardRedemptionQueueThread.stop();
-}
+RewardRedemptionQueue::~RewardRedemptionQueue() = default;
 
 std::vector<RewardRedemption> RewardRedemptionQueue::getRewardRedemptionQueue() const {
     std::lock_guard<std::mutex> guard(rewardRedemptionQueueMutex);
     return rewardRedemptionQueue;
 }
 
-void RewardRedemptionQueue::queueRewardRedemption(const RewardRedemption& rewardRedemption) {
-    std::optional<std::string> obsSourceName = settings.getObsSourceName(rewardRedemption.reward.id);
-    if (!obsSourceName.has_value()) {
+static void stampTrace(const std::shared_ptr<RedemptionTrace>& trace, RedemptionTrace::Stage stage) {
+    if (trace) {
+        trace->stamp(stage);
+    }
+}
+
+/// Only the trace of the first redemption is passed to the playback, so the coalesced redemptions get its playback
+/// stages. Otherwise they would go from DEQUEUED straight to STATUS_ACKNOWLEDGED in the stage histograms.
+static void copyPlaybackStages(const std::vector<RewardRedemption>& rewardRedemptions) {
+    static constexpr std::array PLAYBACK_STAGES = {
+        RedemptionTrace::Stage::SOURCE_STARTED,
+        RedemptionTrace::Stage::MEDIA_STARTED,
+        RedemptionTrace::Stage::VISIBLE,
+        RedemptionTrace::Stage::ENDED,
+    };
+    const std::shared_ptr<RedemptionTrace>& playedTrace = rewardRedemptions.front().trace;
+    if (!playedTrace) {
         return;
     }
-    if (isRewardPlaybackPaused()) {
-        twitchRewardsApi.updateRedemptionStatus(rewardRedemption, TwitchRewardsApi::RedemptionStatus::CANCELED);
+    for (RedemptionTrace::Stage stage : PLAYBACK_STAGES) {
+        std::optional<std::chrono::steady_clock::time_point> time = playedTrace->getStageTime(stage);
+        if (!time.has_value()) {
+            continue;
+        }
+        for (auto it = std::next(rewardRedemptions.begin()); it != rewardRedemptions.end(); ++it) {
+            if (it->trace) {
+                it->trace->stamp(stage, time.value());
+            }
+        }
+    }
+}
+
+void RewardRedemptionQueue::queueRewardRedemption(const RewardRedemption& rewardRedemption) {
+    if (!incomingRewardRedemptions.tryPush(rewardRedemption)) {
+        log(LOG_ERROR, "Too many incoming reward redemptions, canceling {}", rewardRedemption.redemptionId);
+        redemptionStatusApi.updateRedemptionStatus(rewardRedemption, RedemptionStatusApi::RedemptionStatus::CANCELED);
         return;
     }
-    if (!settings.isRewardRedemptionQueueEnabled()) {
-        playObsSource(
-            rewardRedemption.reward.id,
-            obsSourceName.value(),
-            settings.getSourcePlaybackSettings(rewardRedemption.reward.id)
-        );
+    if (!incomingRewardRedemptionsDrainScheduled.exchange(true)) {
+        asio::post(executor, [this]() {
+            drainIncomingRewardRedemptions();
+        });
+    }
+}
+
+void RewardRedemptionQueue::drainIncomingRewardRedemptions() {
+    // Reset the flag before draining, so that a redemption pushed during the drain schedules another one.
+    incomingRewardRedemptionsDrainScheduled = false;
+    std::vector<RewardRedemption> admittedRewardRedemptions;
+    while (std::optional<RewardRedemption> rewardRedemption = incomingRewardRedemptions.tryPop()) {
+        if (admitRewardRedemption(rewardRedemption.value())) {
+            admittedRewardRedemptions.push_back(std::move(rewardRedemption.value()));
+        }
+    }
+    if (admittedRewardRedemptions.empty()) {
         return;
     }
 
     {
         std::lock_guard<std::mutex> guard(rewardRedemptionQueueMutex);
-        rewardRedemptionQueue.push_back(rewardRedemption);
+        std::ranges::move(admittedRewardRedemptions, std::back_inserter(rewardRedemptionQueue));
+        updateQueueBusyDuration();
+        updateRewardsPausedOnTwitch();
+        pluginMetrics.setRewardRedemptionQueueLength(rewardRedemptionQueue.size());
         emit onRewardRedemptionQueueUpdated(rewardRedemptionQueue);
     }
-    notifyRewardRedemptionQueueCondVar();
+    // We're on the executor already, so there's no need to post.
+    rewardRedemptionQueueCondVar.cancel();
+}
+
+bool RewardRedemptionQueue::admitRewardRedemption(const RewardRedemption& rewardRedemption) {
+    std::optional<std::string> obsSourceName = settings.getObsSourceName(rewardRedemption.reward->id);
+    if (!obsSourceName.has_value()) {
+        return false;
+    }
+    if (isRewardPlaybackPaused()) {
+        redemptionStatusApi.updateRedemptionStatus(rewardRedemption, RedemptionStatusApi::RedemptionStatus::CANCELED);
+        return false;
+    }
+    stampTrace(rewardRedemption.trace, RedemptionTrace::Stage::ENQUEUED);
+    if (!settings.isRewardRedemptionQueueEnabled()) {
+        stampTrace(rewardRedemption.trace, RedemptionTrace::Stage::DEQUEUED);
+        playObsSource(
+            rewardRedemption.reward->id,
+            obsSourceName.value(),
+            settings.getSourcePlaybackSettings(rewardRedemption.reward->id),
+            rewardRedemption.trace
+        );
+        return false;
+    }
+    return true;
 }
 
 void RewardRedemptionQueue::removeRewardRedemption(const RewardRedemption& rewardRedemption) {
@@ -71,30 +149,164 @@ void RewardRedemptionQueue::removeRewardRedemption(const RewardRedemption& rewar
         }
         shouldStopSource = (position == rewardRedemptionQueue.begin());
         rewardRedemptionQueue.erase(position);
+        updateQueueBusyDuration();
+        updateRewardsPausedOnTwitch();
+        pluginMetrics.setRewardRedemptionQueueLength(rewardRedemptionQueue.size());
         emit onRewardRedemptionQueueUpdated(rewardRedemptionQueue);
     }
 
     if (shouldStopSource) {
-        obs_source_media_stop(getObsSource(rewardRedemption));
+        asio::post(executor, [this, rewardRedemption]() {
+            cancelQueuedPlayback(rewardRedemption);
+        });
     }
-    twitchRewardsApi.updateRedemptionStatus(rewardRedemption, TwitchRewardsApi::RedemptionStatus::CANCELED);
+    redemptionStatusApi.updateRedemptionStatus(rewardRedemption, RedemptionStatusApi::RedemptionStatus::CANCELED);
 }
 
 std::vector<std::string> RewardRedemptionQueue::enumObsSources() {
     std::vector<std::string> sources;
+    for (const ObsSourceRef& source : obsApi.enumSources()) {
+        if (isMediaSource(source.get())) {
+            sources.push_back(obsApi.getSourceName(source.get()));
+        }
+    }
+    return sources;
+}
 
-    struct AddToSourcesCallback {
-        static bool addToSources(void* param, obs_source_t* source) {
-            if (isMediaSource(source)) {
-                auto& sources = *static_cast<std::vector<std::string>*>(param);
-                sources.emplace_back(obs_source_get_name(source));
-            }
-            return true;
+std::optional<double> RewardRedemptionQueue::getRewardRedemptionsPerHour() const {
+    std::lock_guard guard(rewardRedemptionQueueMutex);
+    return calculateRewardRedemptionsPerHour();
+}
+
+std::optional<std::chrono::seconds> RewardRedemptionQueue::getProjectedDrainTime() const {
+    std::lock_guard guard(rewardRedemptionQueueMutex);
+    return calculateProjectedDrainTime();
+}
+
+std::optional<double> RewardRedemptionQueue::calculateRewardRedemptionsPerHour() const {
+    std::chrono::steady_clock::duration busyDuration = queueBusyDuration;
+    if (queueBusySince.has_value()) {
+        busyDuration += std::chrono::steady_clock::now() - queueBusySince.value();
+    }
+    double busyHours = std::chrono::duration<double, std::ratio<3600>>(busyDuration).count();
+    if (playedRewardRedemptionCount == 0 || busyHours <= 0) {
+        return std::nullopt;
+    }
+    return static_cast<double>(playedRewardRedemptionCount) / busyHours;
+}
+
+std::optional<std::chrono::seconds> RewardRedemptionQueue::calculateProjectedDrainTime() const {
+    std::optional<double> rewardRedemptionsPerHour = calculateRewardRedemptionsPerHour();
+    if (!rewardRedemptionsPerHour.has_value()) {
+        return std::nullopt;
+    }
+    double drainTimeSeconds =
+        3600 * static_cast<double>(rewardRedemptionQueue.size()) / rewardRedemptionsPerHour.value();
+    return std::chrono::seconds(std::llround(drainTimeSeconds));
+}
+
+void RewardRedemptionQueue::updateQueueBusyDuration() {
+    auto now = std::chrono::steady_clock::now();
+    if (rewardRedemptionQueue.empty() && queueBusySince.has_value()) {
+        queueBusyDuration += now - queueBusySince.value();
+        queueBusySince.reset();
+    } else if (!rewardRedemptionQueue.empty() && !queueBusySince.has_value()) {
+        queueBusySince = now;
+    }
+}
+
+void RewardRedemptionQueue::updateRewardsPausedOnTwitch() {
+    std::size_t queueLength = rewardRedemptionQueue.size();
+    std::optional<std::chrono::seconds> drainTime = calculateProjectedDrainTime();
+    unsigned highWaterMark = settings.getBackpressureHighWaterMark();
+    unsigned highWaterMarkSeconds = settings.getBackpressureHighWaterMarkSeconds();
+    bool aboveHighWaterMark = (highWaterMark != 0 && queueLength > highWaterMark) ||
+                              (highWaterMarkSeconds != 0 && drainTime.has_value() &&
+                               drainTime.value() > std::chrono::seconds(highWaterMarkSeconds));
+    // A low water mark above the high one would pause and resume the rewards on every change of the queue.
+    unsigned lowWaterMark = std::min(settings.getBackpressureLowWaterMark(), highWaterMark);
+    unsigned lowWaterMarkSeconds = std::min(settings.getBackpressureLowWaterMarkSeconds(), highWaterMarkSeconds);
+    bool belowLowWaterMark = (highWaterMark == 0 || queueLength <= lowWaterMark) &&
+                             (highWaterMarkSeconds == 0 || !drainTime.has_value() ||
+                              drainTime.value() <= std::chrono::seconds(lowWaterMarkSeconds));
+    if (!backpressureActive && aboveHighWaterMark) {
+        log(LOG_INFO, "The queue is {} rewards long, pausing the rewards on Twitch", queueLength);
+        backpressureActive = true;
+    } else if (backpressureActive && belowLowWaterMark) {
+        log(LOG_INFO, "The queue is {} rewards long, resuming the rewards on Twitch", queueLength);
+        backpressureActive = false;
+    }
+
+    if (rewardPlaybackPaused || backpressureActive) {
+        // Also pauses the rewards that were mapped to a source since the rewards were paused.
+        pauseRewardsOnTwitch();
+    } else if (!rewardIdsPausedOnTwitch.empty()) {
+        redemptionStatusApi.setRewardsPaused(rewardIdsPausedOnTwitch, false);
+        rewardIdsPausedOnTwitch.clear();
+        settings.setRewardIdsPausedOnTwitch(rewardIdsPausedOnTwitch);
+    }
+}
+
+void RewardRedemptionQueue::pauseRewardsOnTwitch() {
+    std::vector<std::string> rewardIdsToPause;
+    for (const std::string& rewardId : manageableRewardIds) {
+        if (settings.getObsSourceName(rewardId).has_value() &&
+            std::ranges::find(rewardIdsPausedOnTwitch, rewardId) == rewardIdsPausedOnTwitch.end()) {
+            rewardIdsToPause.push_back(rewardId);
         }
-    };
+    }
+    if (rewardIdsToPause.empty()) {
+        return;
+    }
+    redemptionStatusApi.setRewardsPaused(rewardIdsToPause, true);
+    std::ranges::move(rewardIdsToPause, std::back_inserter(rewardIdsPausedOnTwitch));
+    settings.setRewardIdsPausedOnTwitch(rewardIdsPausedOnTwitch);
+}
 
-    obs_enum_sources(&AddToSourcesCallback::addToSources, &sources);
-    return sources;
+void RewardRedemptionQueue::saveManageableRewardIds(
+    const std::variant<std::exception_ptr, std::vector<Reward>>& rewards
+) {
+    if (!std::holds_alternative<std::vector<Reward>>(rewards)) {
+        return;
+    }
+    std::lock_guard guard(rewardRedemptionQueueMutex);
+    manageableRewardIds.clear();
+    for (const Reward& reward : std::get<std::vector<Reward>>(rewards)) {
+        // The rewards that the user has paused themselves are neither paused nor resumed.
+        bool pausedByUser =
+            reward.isPaused && std::ranges::find(rewardIdsPausedOnTwitch, reward.id) == rewardIdsPausedOnTwitch.end();
+        if (reward.canManage && !pausedByUser) {
+            manageableRewardIds.push_back(reward.id);
+        }
+    }
+    updateRewardsPausedOnTwitch();
+}
+
+double RewardRedemptionQueue::getDrainLoad() const {
+    unsigned threshold = settings.getAdaptiveDrainThreshold();
+    if (threshold == 0) {
+        return 0;
+    }
+    std::size_t queueLength;
+    {
+        std::lock_guard guard(rewardRedemptionQueueMutex);
+        queueLength = rewardRedemptionQueue.size();
+    }
+    if (queueLength <= threshold) {
+        return 0;
+    }
+    return std::min(1.0, static_cast<double>(queueLength - threshold) / threshold);
+}
+
+std::chrono::milliseconds RewardRedemptionQueue::getIntervalBetweenRewards(
+    double minIntervalSeconds,
+    double drainLoad
+) const {
+    double intervalSeconds = settings.getIntervalBetweenRewardsSeconds();
+    double drainIntervalSeconds = std::min(intervalSeconds, settings.getAdaptiveDrainMinIntervalSeconds());
+    intervalSeconds -= drainLoad * (intervalSeconds - drainIntervalSeconds);
+    intervalSeconds = std::max(minIntervalSeconds, intervalSeconds);
+    return std::chrono::milliseconds(static_cast<long long>(1000 * intervalSeconds));
 }
 
 bool RewardRedemptionQueue::isRewardPlaybackPaused() const {
@@ -106,6 +318,7 @@ void RewardRedemptionQueue::setRewardPlaybackPaused(bool paused) {
     {
         std::lock_guard guard(rewardRedemptionQueueMutex);
         rewardPlaybackPaused = paused;
+        updateRewardsPausedOnTwitch();
     }
     notifyRewardRedemptionQueueCondVar();
 }
@@ -128,40 +341,223 @@ void RewardRedemptionQueue::testObsSource(
     const std::string& rewardId,
     const std::string& obsSourceName,
     const SourcePlaybackSettings& sourcePlaybackSettings,
-    QObject* receiver,
-    const char* member
+    QObjectCallback<std::exception_ptr> callback
 ) {
     asio::co_spawn(
-        ioContext,
-        asyncTestObsSource(
-            rewardId, obsSourceName, sourcePlaybackSettings, *(new QObjectCallback(this, receiver, member))
-        ),
+        executor,
+        asyncTestObsSource(rewardId, obsSourceName, sourcePlaybackSettings, std::move(callback)),
         asio::detached
     );
 }
 
+void RewardRedemptionQueue::testObsSource(
+    const std::string& rewardId,
+    const std::string& obsSourceName,
+    const SourcePlaybackSettings& sourcePlaybackSettings,
+    QObject* receiver,
+    const char* member
+) {
+    testObsSource(
+        rewardId,
+        obsSourceName,
+        sourcePlaybackSettings,
+        QObjectCallback<std::exception_ptr>(receiver, member, "std::exception_ptr")
+    );
+}
+
 bool RewardRedemptionQueue::sourceSupportsLoopVideo(const std::string& obsSourceName) const {
-    return sourceSupportsLoopVideo(getObsSource(obsSourceName));
+    return sourceSupportsLoopVideo(getObsSource(obsSourceName).get());
+}
+
+bool RewardRedemptionQueue::sourceSupportsMediaDirectory(const std::string& obsSourceName) const {
+    ObsSourceRef source = getObsSource(obsSourceName);
+    return !source || !isVlcSource(source.get());
+}
+
+void RewardRedemptionQueue::probeMediaInBackground(const std::string& rewardId) {
+    std::optional<std::string> obsSourceName = settings.getObsSourceName(rewardId);
+    if (!obsSourceName.has_value()) {
+        return;
+    }
+    mediaProber.probeInBackground(obsSourceName.value(), settings.getMediaDirectory(rewardId));
+    asio::post(executor, [this, rewardId, obsSourceName = obsSourceName.value()] {
+        ObsSourceRef source = getObsSource(obsSourceName);
+        if (!source || !sourceSupportsLoopVideo(source.get())) {
+            return;
+        }
+        SourcePlaybackSettings sourcePlaybackSettings = settings.getSourcePlaybackSettings(rewardId);
+        sourcePool.prewarm(
+            source.get(),
+            sourcePlaybackSettings.loopVideoEnabled,
+            playsMediaDirectory(source.get(), sourcePlaybackSettings)
+        );
+    });
+}
+
+void RewardRedemptionQueue::probeRewardsMediaInBackground(
+    const std::variant<std::exception_ptr, std::vector<Reward>>& rewards
+) {
+    if (!std::holds_alternative<std::vector<Reward>>(rewards)) {
+        return;
+    }
+    for (const Reward& reward : std::get<std::vector<Reward>>(rewards)) {
+        probeMediaInBackground(reward.id);
+    }
 }
 
 asio::awaitable<void> RewardRedemptionQueue::asyncPlayRewardRedemptionsFromQueue() {
     while (true) {
         RewardRedemption nextRewardRedemption = co_await asyncGetNextRewardRedemption();
+        std::erase_if(unfinishedPlaybacks, [](const std::shared_ptr<QueuedPlayback>& playback) {
+            return playback->finished.isSet;
+        });
+        if (settings.isPipelinedPlaybackEnabled()) {
+            co_await asyncPlayPipelined(nextRewardRedemption);
+            continue;
+        }
+        for (const std::shared_ptr<QueuedPlayback>& playback : unfinishedPlaybacks) {
+            co_await playback->finished.asyncWait();
+        }
+        // Registered before the first suspension, so that a removal of the redemption finds it.
+        auto playback = std::make_shared<QueuedPlayback>(
+            executor, nextRewardRedemption, settings.getObsSourceName(nextRewardRedemption.reward->id).value_or("")
+        );
+        unfinishedPlaybacks = {playback};
+
+        std::vector<RewardRedemption> rewardRedemptions = getCoalescedRewardRedemptions(nextRewardRedemption);
+        for (const RewardRedemption& rewardRedemption : rewardRedemptions) {
+            stampTrace(rewardRedemption.trace, RedemptionTrace::Stage::DEQUEUED);
+        }
+        double drainLoad = getDrainLoad();
+        unsigned redemptionCountState = showRedemptionCount(rewardRedemptions.size());
         try {
-            const std::string& rewardId = nextRewardRedemption.reward.id;
+            const std::string& rewardId = nextRewardRedemption.reward->id;
             co_await asyncPlayObsSource(
-                rewardId, getObsSource(nextRewardRedemption), settings.getSourcePlaybackSettings(rewardId)
+                rewardId,
+                getObsSource(nextRewardRedemption),
+                settings.getSourcePlaybackSettings(rewardId),
+                nextRewardRedemption.trace,
+                playback.get(),
+                drainLoad
             );
         } catch (const ObsSourceNoVideoException&) {}
-        co_await popPlayedRewardRedemptionFromQueue(nextRewardRedemption);
+        playback->finished.set();
+        hideRedemptionCount(redemptionCountState);
+        copyPlaybackStages(rewardRedemptions);
+        co_await popPlayedRewardRedemptionsFromQueue(rewardRedemptions);
+
+        auto timeBeforeNextReward = getIntervalBetweenRewards(0.1, drainLoad);
+        co_await asio::steady_timer(executor, timeBeforeNextReward).async_wait(asio::use_awaitable);
+    }
+}
+
+asio::awaitable<void> RewardRedemptionQueue::asyncPlayPipelined(const RewardRedemption& rewardRedemption) {
+    auto playback = std::make_shared<QueuedPlayback>(
+        executor, rewardRedemption, settings.getObsSourceName(rewardRedemption.reward->id).value_or("")
+    );
+    // The earlier playbacks are copied, because the vector may grow while this one waits for them.
+    std::vector<std::shared_ptr<QueuedPlayback>> earlierPlaybacks = unfinishedPlaybacks;
+    unfinishedPlaybacks.push_back(playback);
+    ObsSourceRef source = getObsSource(rewardRedemption);
+    SourcePlaybackSettings sourcePlaybackSettings = settings.getSourcePlaybackSettings(rewardRedemption.reward->id);
+    for (const std::shared_ptr<QueuedPlayback>& unfinishedPlayback : earlierPlaybacks) {
+        if (unfinishedPlayback->obsSourceName != playback->obsSourceName) {
+            continue;
+        }
+        // An instance can't be shown while it's being hidden, so wait for the earlier playbacks of the same source
+        // to finish until one of its instances is free.
+        if (source &&
+            sourcePool.hasFreeInstance(source.get(), playsMediaDirectory(source.get(), sourcePlaybackSettings))) {
+            break;
+        }
+        co_await unfinishedPlayback->finished.asyncWait();
+    }
+    if (playback->canceled) {
+        // The user removed the redemption while it was waiting, so it has been canceled already.
+        playback->hidingStarted.set();
+        playback->finished.set();
+        co_return;
+    }
+    std::vector<RewardRedemption> rewardRedemptions = getCoalescedRewardRedemptions(rewardRedemption);
+    for (const RewardRedemption& coalescedRewardRedemption : rewardRedemptions) {
+        stampTrace(coalescedRewardRedemption.trace, RedemptionTrace::Stage::DEQUEUED);
+    }
+    double drainLoad = getDrainLoad();
+    asio::co_spawn(executor, asyncPlayPipelinedObsSource(rewardRedemptions, playback, drainLoad), asio::detached);
+    co_await playback->hidingStarted.asyncWait();
+    copyPlaybackStages(rewardRedemptions);
+    co_await popPlayedRewardRedemptionsFromQueue(rewardRedemptions);
+
+    // Unlike in the sequential mode, there's no minimum interval: the next source is a different one, or it waits for
+    // this one to finish.
+    auto timeBeforeNextReward = getIntervalBetweenRewards(0, drainLoad);
+    co_await asio::steady_timer(executor, timeBeforeNextReward).async_wait(asio::use_awaitable);
+}
+
+asio::awaitable<void> RewardRedemptionQueue::asyncPlayPipelinedObsSource(
+    std::vector<RewardRedemption> rewardRedemptions,
+    std::shared_ptr<QueuedPlayback> playback,
+    double drainLoad
+) {
+    const RewardRedemption& rewardRedemption = rewardRedemptions.front();
+    unsigned redemptionCountState = showRedemptionCount(rewardRedemptions.size());
+    try {
+        const std::string& rewardId = rewardRedemption.reward->id;
+        co_await asyncPlayObsSource(
+            rewardId,
+            getObsSource(rewardRedemption),
+            settings.getSourcePlaybackSettings(rewardId),
+            rewardRedemption.trace,
+            playback.get(),
+            drainLoad
+        );
+    } catch (const ObsSourceNoVideoException&) {
+    } catch (const std::exception& exception) {
+        // The playback is detached, so the queue would wait for it forever if the events weren't set.
+        log(LOG_ERROR, "Exception in asyncPlayPipelinedObsSource: {}", exception.what());
+    }
+    hideRedemptionCount(redemptionCountState);
+    playback->hidingStarted.set();
+    playback->finished.set();
+}
+
+void RewardRedemptionQueue::cancelQueuedPlayback(const RewardRedemption& rewardRedemption) {
+    for (const std::shared_ptr<QueuedPlayback>& playback : unfinishedPlaybacks) {
+        if (playback->finished.isSet || playback->rewardRedemption != rewardRedemption) {
+            continue;
+        }
+        playback->canceled = true;
+        if (playback->playedSource) {
+            obsApi.stopMedia(playback->playedSource);
+        }
+    }
+}
+
+RewardRedemptionQueue::PlaybackEvent::PlaybackEvent(IoThreadPool::Strand executor) : condVar(executor, POS_INFINITY) {}
+
+void RewardRedemptionQueue::PlaybackEvent::set() {
+    isSet = true;
+    condVar.cancel();
+}
 
-        double intervalBetweenRewardsSeconds = std::max(0.1, settings.getIntervalBetweenRewardsSeconds());
-        auto timeBeforeNextReward =
-            std::chrono::milliseconds(static_cast<long long>(1000 * intervalBetweenRewardsSeconds));
-        co_await asio::steady_timer(ioContext, timeBeforeNextReward).async_wait(asio::use_awaitable);
+asio::awaitable<void> RewardRedemptionQueue::PlaybackEvent::asyncWait() {
+    while (!isSet) {
+        try {
+            co_await condVar.async_wait(asio::use_awaitable);
+        } catch (const boost::system::system_error&) {
+            // Condition variable notified.
+        }
     }
 }
 
+RewardRedemptionQueue::QueuedPlayback::QueuedPlayback(
+    IoThreadPool::Strand executor,
+    RewardRedemption rewardRedemption,
+    std::string obsSourceName
+)
+    : rewardRedemption(std::move(rewardRedemption)), obsSourceName(std::move(obsSourceName)), hidingStarted(executor),
+      finished(executor) {}
+
 asio::awaitable<RewardRedemption> RewardRedemptionQueue::asyncGetNextRewardRedemption() {
     while (true) {
         {
@@ -179,56 +575,161 @@ asio::awaitable<RewardRedemption> RewardRedemptionQueue::asyncGetNextRewardRedem
 }
 
 void RewardRedemptionQueue::notifyRewardRedemptionQueueCondVar() {
-    asio::post(ioContext, [this]() {
+    asio::post(executor, [this]() {
         rewardRedemptionQueueCondVar.cancel();  // Equivalent to notify_all() for a condition variable
     });
 }
 
-asio::awaitable<void> RewardRedemptionQueue::popPlayedRewardRedemptionFromQueue(const RewardRedemption& rewardRedemption
+std::vector<RewardRedemption> RewardRedemptionQueue::getCoalescedRewardRedemptions(
+    const RewardRedemption& firstRewardRedemption
+) const {
+    std::vector<RewardRedemption> rewardRedemptions{firstRewardRedemption};
+    std::chrono::duration<double> coalescingWindow(settings.getRedemptionCoalescingWindowSeconds());
+    if (coalescingWindow.count() <= 0) {
+        return rewardRedemptions;
+    }
+    {
+        std::lock_guard guard(rewardRedemptionQueueMutex);
+        if (rewardRedemptionQueue.empty() || rewardRedemptionQueue.front() != firstRewardRedemption) {
+            return rewardRedemptions;
+        }
+        for (auto it = std::next(rewardRedemptionQueue.begin()); it != rewardRedemptionQueue.end(); ++it) {
+            if (it->reward->id != firstRewardRedemption.reward->id ||
+                it->receivedAt - firstRewardRedemption.receivedAt > coalescingWindow) {
+                break;
+            }
+            rewardRedemptions.push_back(*it);
+        }
+    }
+    if (rewardRedemptions.size() > 1) {
+        log(LOG_INFO,
+            "Playing {} redemptions of {} at once",
+            rewardRedemptions.size(),
+            firstRewardRedemption.reward->title);
+    }
+    return rewardRedemptions;
+}
+
+asio::awaitable<void> RewardRedemptionQueue::popPlayedRewardRedemptionsFromQueue(
+    const std::vector<RewardRedemption>& rewardRedemptions
 ) {
+    std::vector<RewardRedemption> playedRewardRedemptions;
     {
         std::lock_guard guard(rewardRedemptionQueueMutex);
-        if (rewardRedemptionQueue.empty() || rewardRedemptionQueue.front() != rewardRedemption) {
-            // The reward was removed and canceled by the user.
-            // Wait for a bit so that the cancellation doesn't affect the next reward.
-            co_await asio::steady_timer(ioContext, 500ms).async_wait(asio::use_awaitable);
-            co_return;
+        bool removedByUser =
+            rewardRedemptionQueue.empty() || rewardRedemptionQueue.front() != rewardRedemptions.front();
+        if (!removedByUser) {
+            // The user may have removed some of the other redemptions, which are canceled then.
+            for (const RewardRedemption& rewardRedemption : rewardRedemptions) {
+                auto position = std::find(rewardRedemptionQueue.begin(), rewardRedemptionQueue.end(), rewardRedemption);
+                if (position != rewardRedemptionQueue.end()) {
+                    rewardRedemptionQueue.erase(position);
+                    playedRewardRedemptions.push_back(rewardRedemption);
+                }
+            }
+            playedRewardRedemptionCount += playedRewardRedemptions.size();
+            updateQueueBusyDuration();
+            updateRewardsPausedOnTwitch();
+            pluginMetrics.setRewardRedemptionQueueLength(rewardRedemptionQueue.size());
         }
-        rewardRedemptionQueue.erase(rewardRedemptionQueue.begin());
     }
-    twitchRewardsApi.updateRedemptionStatus(rewardRedemption, TwitchRewardsApi::RedemptionStatus::FULFILLED);
+    if (playedRewardRedemptions.empty()) {
+        // The reward was removed and canceled by the user.
+        // Wait for a bit so that the cancellation doesn't affect the next reward.
+        co_await asio::steady_timer(executor, 500ms).async_wait(asio::use_awaitable);
+        co_return;
+    }
+    redemptionStatusApi.updateRedemptionStatus(
+        playedRewardRedemptions, RedemptionStatusApi::RedemptionStatus::FULFILLED
+    );
     emit onRewardRedemptionQueueUpdated(rewardRedemptionQueue);
 }
 
+unsigned RewardRedemptionQueue::showRedemptionCount(std::size_t rewardRedemptionCount) {
+    unsigned state = ++redemptionCountState;
+    std::string text;
+    if (rewardRedemptionCount > 1) {
+        text = fmt::format(fmt::runtime(obsApi.getLocaleText("RedemptionCount")), rewardRedemptionCount);
+    }
+    setRedemptionCountText(text);
+    return state;
+}
+
+void RewardRedemptionQueue::hideRedemptionCount(unsigned state) {
+    if (state == redemptionCountState) {
+        setRedemptionCountText("");
+    }
+}
+
+void RewardRedemptionQueue::setRedemptionCountText(const std::string& text) {
+    std::optional<std::string> textSourceName = settings.getRedemptionCountTextSourceName();
+    if (!textSourceName.has_value()) {
+        return;
+    }
+    ObsSourceRef textSource = obsApi.getSourceByName(textSourceName.value());
+    if (!textSource) {
+        log(LOG_WARNING, "Text source {} for the redemption count not found", textSourceName.value());
+        return;
+    }
+    boost::json::object changedSettings;
+    if (setSetting(changedSettings, obsApi.getSourceSettings(textSource.get()), "text", boost::json::string(text))) {
+        obsApi.updateSourceSettings(textSource.get(), changedSettings);
+    }
+}
+
 void RewardRedemptionQueue::playObsSource(
     const std::string& rewardId,
     const std::string& obsSourceName,
-    const SourcePlaybackSettings& sourcePlaybackSettings
+    const SourcePlaybackSettings& sourcePlaybackSettings,
+    std::shared_ptr<RedemptionTrace> trace
 ) {
-    playObsSource(rewardId, getObsSource(obsSourceName), sourcePlaybackSettings);
+    playObsSource(rewardId, getObsSource(obsSourceName), sourcePlaybackSettings, std::move(trace));
 }
 
 void RewardRedemptionQueue::playObsSource(
     const std::string& rewardId,
-    OBSSourceAutoRelease source,
-    const SourcePlaybackSettings& sourcePlaybackSettings
+    ObsSourceRef source,
+    const SourcePlaybackSettings& sourcePlaybackSettings,
+    std::shared_ptr<RedemptionTrace> trace
 ) {
-    asio::co_spawn(ioContext, asyncPlayObsSource(rewardId, std::move(source), sourcePlaybackSettings), asio::detached);
+    // Redemptions played outside of the queue never get their status updated, so finish their trace right here.
+    asio::co_spawn(
+        executor,
+        asyncPlayObsSource(rewardId, std::move(source), sourcePlaybackSettings, trace),
+        [trace](std::exception_ptr) {
+            if (trace) {
+                trace->finish();
+            }
+        }
+    );
 }
 
 template <class T>
 class ObsSignalWithCallback {
 public:
-    ObsSignalWithCallback(obs_source_t* source, const char* signal, signal_callback_t callback, T& param)
-        : signal(obs_source_get_signal_handler(source), signal, callback, &param), param(param) {}
+    ObsSignalWithCallback(
+        ObsApi& obsApi,
+        obs_source_t* source,
+        const char* signal,
+        void (T::*callback)(),
+        const std::shared_ptr<T>& param
+    )
+        : signal(obsApi.connectSourceSignal(
+              source,
+              signal,
+              [param, callback]() {
+                  ((*param).*callback)();
+              }
+          )),
+          param(param) {}
 
     ~ObsSignalWithCallback() {
         param->enabled = false;
     }
 
 private:
-    OBSSignal signal;
-    T& param;
+    std::unique_ptr<ObsApi::SignalConnection> signal;
+    std::shared_ptr<T> param;
 };
 
 /// First the function sets the deadline timer for the source to start and waits for it.
@@ -236,31 +737,80 @@ private:
 /// The deadline timer is cancelled when the source stops, therefore control returns to the function again.
 asio::awaitable<void> RewardRedemptionQueue::asyncPlayObsSource(
     std::string rewardId,
-    OBSSourceAutoRelease source,
-    SourcePlaybackSettings sourcePlaybackSettings
+    ObsSourceRef source,
+    SourcePlaybackSettings sourcePlaybackSettings,
+    std::shared_ptr<RedemptionTrace> trace,
+    QueuedPlayback* playback,
+    double drainLoad
 ) {
     if (!source) {
         co_return;
     }
+    std::optional<std::string> mediaFile;
+    if (playsMediaDirectory(source.get(), sourcePlaybackSettings)) {
+        const std::string& mediaDirectory = sourcePlaybackSettings.mediaDirectory.value();
+        mediaFile = co_await mediaIndex.asyncPickFile(mediaDirectory);
+        if (!mediaFile.has_value()) {
+            log(LOG_ERROR, "No videos found in {}", mediaDirectory);
+            throw ObsSourceNoVideoException(obsApi.getSourceName(source.get()));
+        }
+    } else if (sourcePlaybackSettings.mediaDirectory.has_value()) {
+        log(
+            LOG_WARNING,
+            "Video folders are only supported by the Media Source, ignoring {}",
+            sourcePlaybackSettings.mediaDirectory.value()
+        );
+    }
+    if (playback && playback->canceled) {
+        co_return;
+    }
+    // The video from the folder is played on a duplicate, so that the file of the user's source stays the same.
+    SourcePool::Lease lease =
+        sourcePool.acquire(source.get(), sourcePlaybackSettings.loopVideoEnabled, mediaFile.has_value());
+    obs_source_t* playedSource = lease.getSource();
+    if (mediaFile.has_value() && playedSource == source.get()) {
+        throw ObsSourceNoVideoException(obsApi.getSourceName(source.get()));
+    }
+    if (playback) {
+        playback->playedSource = playedSource;
+    }
     unsigned state = playObsSourceState++;
-    sourcePlayedByState[source] = state;
+    sourcePlayedByState[playedSource] = state;
 
-    asio::steady_timer deadlineTimer(ioContext);
-    auto mediaStartedCallback = std::make_shared<MediaStartedCallback>(ioContext);
-    auto mediaEndedCallback = std::make_shared<MediaEndedCallback>(ioContext, deadlineTimer);
+    asio::steady_timer deadlineTimer(executor);
+    auto mediaStartedCallback = std::make_shared<MediaStartedCallback>(obsApi, executor, playedSource, trace);
+    auto mediaEndedCallback = std::make_shared<MediaEndedCallback>(executor, deadlineTimer);
     ObsSignalWithCallback mediaStartedSignal(
-        source, "media_started", &MediaStartedCallback::setMediaStarted, mediaStartedCallback
+        obsApi, playedSource, "media_started", &MediaStartedCallback::setMediaStarted, mediaStartedCallback
+    );
+    ObsSignalWithCallback activateSignal(
+        obsApi, playedSource, "activate", &MediaStartedCallback::stampVisibleIfMediaStarted, mediaStartedCallback
     );
     ObsSignalWithCallback mediaStoppedSignal(
-        source, "media_stopped", &MediaEndedCallback::stopDeadlineTimer, mediaEndedCallback
+        obsApi, playedSource, "media_stopped", &MediaEndedCallback::stopDeadlineTimer, mediaEndedCallback
     );
-    std::optional<ObsSignalWithCallback<decltype(mediaEndedCallback)>> mediaEndedSignal;
-    if (!(sourceSupportsLoopVideo(source) && sourcePlaybackSettings.loopVideoEnabled)) {
-        mediaEndedSignal.emplace(source, "media_ended", &MediaEndedCallback::stopDeadlineTimer, mediaEndedCallback);
+    std::optional<ObsSignalWithCallback<MediaEndedCallback>> mediaEndedSignal;
+    if (!(sourceSupportsLoopVideo(playedSource) && sourcePlaybackSettings.loopVideoEnabled)) {
+        mediaEndedSignal.emplace(
+            obsApi, playedSource, "media_ended", &MediaEndedCallback::stopDeadlineTimer, mediaEndedCallback
+        );
     };
 
-    SourcePlayback sourcePlayback{state, rewardId, source, sourcePlaybackSettings, 0, 1};
+    SourcePlayback sourcePlayback{
+        state,
+        rewardId,
+        playedSource,
+        source.get(),
+        obsApi.getSourceName(source.get()),
+        sourcePlaybackSettings,
+        0,
+        1,
+        mediaFile,
+        getSpeedPercent(source.get(), drainLoad),
+        getMaxPlayTime(sourcePlaybackSettings, drainLoad),
+    };
     startObsSource(sourcePlayback);
+    stampTrace(trace, RedemptionTrace::Stage::SOURCE_STARTED);
 
     // Give some time for the source to start, otherwise stop it.
     deadlineTimer.expires_after(std::chrono::milliseconds(500));
@@ -277,29 +827,53 @@ asio::awaitable<void> RewardRedemptionQueue::asyncPlayObsSource(
     try {
         co_await deadlineTimer.async_wait(asio::use_awaitable);
     } catch (const boost::system::system_error&) {}
+    stampTrace(trace, RedemptionTrace::Stage::ENDED);
+    if (playback) {
+        // The hide transition starts right away, before the first suspension.
+        playback->hidingStarted.set();
+    }
     co_await asyncStopObsSourceIfPlayedByState(sourcePlayback, true);
 }
 
-RewardRedemptionQueue::MediaStartedCallback::MediaStartedCallback(asio::io_context& ioContext) : ioContext(ioContext) {}
+RewardRedemptionQueue::MediaStartedCallback::MediaStartedCallback(
+    ObsApi& obsApi,
+    IoThreadPool::Strand executor,
+    obs_source_t* source,
+    std::shared_ptr<RedemptionTrace> trace
+)
+    : obsApi(obsApi), executor(executor), source(source), trace(std::move(trace)) {}
+
+// The callbacks are called on the OBS threads while the signals are connected, so they hold a reference to themselves
+// until they have run on the executor.
 
-void RewardRedemptionQueue::MediaStartedCallback::setMediaStarted(void* param, [[maybe_unused]] calldata_t* data) {
-    std::shared_ptr<MediaStartedCallback> callback = *static_cast<std::shared_ptr<MediaStartedCallback>*>(param);
-    asio::post(callback->ioContext, [callback] {
+void RewardRedemptionQueue::MediaStartedCallback::setMediaStarted() {
+    if (trace) {
+        trace->stamp(RedemptionTrace::Stage::MEDIA_STARTED);
+        if (obsApi.isSourceActive(source)) {
+            trace->stamp(RedemptionTrace::Stage::VISIBLE);
+        }
+    }
+    asio::post(executor, [callback = shared_from_this()] {
         if (callback->enabled) {
             callback->mediaStarted = true;
         }
     });
 }
 
+void RewardRedemptionQueue::MediaStartedCallback::stampVisibleIfMediaStarted() {
+    if (trace && trace->getStageTime(RedemptionTrace::Stage::MEDIA_STARTED).has_value()) {
+        trace->stamp(RedemptionTrace::Stage::VISIBLE);
+    }
+}
+
 RewardRedemptionQueue::MediaEndedCallback::MediaEndedCallback(
-    asio::io_context& ioContext,
+    IoThreadPool::Strand executor,
     asio::steady_timer& deadlineTimer
 )
-    : ioContext(ioContext), deadlineTimer(deadlineTimer) {}
+    : executor(executor), deadlineTimer(deadlineTimer) {}
 
-void RewardRedemptionQueue::MediaEndedCallback::stopDeadlineTimer(void* param, [[maybe_unused]] calldata_t* data) {
-    std::shared_ptr<MediaEndedCallback> callback = *static_cast<std::shared_ptr<MediaEndedCallback>*>(param);
-    asio::post(callback->ioContext, [callback] {
+void RewardRedemptionQueue::MediaEndedCallback::stopDeadlineTimer() {
+    asio::post(executor, [callback = shared_from_this()] {
         if (callback->enabled) {
             callback->mediaEnded = true;
             callback->deadlineTimer.cancel();
@@ -313,39 +887,95 @@ boost::asio::awaitable<void> RewardRedemptionQueue::asyncCheckMediaStarted(
 ) {
     if (!mediaStartedCallback.mediaStarted) {
         co_await asyncStopObsSourceIfPlayedByState(sourcePlayback, false);
-        auto sourceName = obs_source_get_name(sourcePlayback.source);
+        std::string sourceName = obsApi.getSourceName(sourcePlayback.source);
         log(LOG_ERROR, "Source failed to start in time: {}", sourceName);
         throw ObsSourceNoVideoException(sourceName);
     }
 }
 
 void RewardRedemptionQueue::saveLastVideoSize(SourcePlayback& sourcePlayback) {
-    std::uint32_t width = obs_source_get_width(sourcePlayback.source);
-    std::uint32_t height = obs_source_get_height(sourcePlayback.source);
+    auto [width, height] = obsApi.getSourceSize(sourcePlayback.source);
     if (width == 0 || height == 0) {
         return;
     }
+    std::optional<std::string> mediaFile = getMediaFile(sourcePlayback);
+    if (mediaFile.has_value()) {
+        std::int64_t durationMilliseconds = obsApi.getMediaDurationMilliseconds(sourcePlayback.source);
+        mediaIndex.setMediaInfo(
+            mediaFile.value(),
+            {width, height, std::chrono::milliseconds(std::max<std::int64_t>(0, durationMilliseconds))}
+        );
+    }
+    if (sourcePlayback.mediaFile.has_value()) {
+        return;
+    }
     settings.setLastVideoSize(
         sourcePlayback.rewardId,
-        obs_source_get_name(sourcePlayback.source),
+        sourcePlayback.obsSourceName,
         sourcePlayback.playlistIndex,
         sourcePlayback.playlistSize,
         std::make_pair(width, height)
     );
 }
 
+std::optional<std::pair<std::uint32_t, std::uint32_t>> RewardRedemptionQueue::getLastVideoSize(
+    const SourcePlayback& sourcePlayback
+) {
+    std::optional<MediaInfo> mediaInfo = getMediaInfo(sourcePlayback);
+    if (mediaInfo.has_value()) {
+        return std::make_pair(mediaInfo->width, mediaInfo->height);
+    }
+    if (sourcePlayback.mediaFile.has_value()) {
+        return std::nullopt;
+    }
+    return settings.getLastVideoSize(
+        sourcePlayback.rewardId, sourcePlayback.obsSourceName, sourcePlayback.playlistIndex
+    );
+}
+
+std::optional<std::string> RewardRedemptionQueue::getMediaFile(const SourcePlayback& sourcePlayback) {
+    if (sourcePlayback.mediaFile.has_value()) {
+        return sourcePlayback.mediaFile;
+    }
+    std::vector<std::string> sourceFiles = MediaProber::getSourceFiles(
+        obsApi.getSourceId(sourcePlayback.source), obsApi.getSourceSettings(sourcePlayback.source)
+    );
+    if (sourcePlayback.playlistIndex >= sourceFiles.size()) {
+        return std::nullopt;
+    }
+    return sourceFiles[sourcePlayback.playlistIndex];
+}
+
+std::optional<MediaInfo> RewardRedemptionQueue::getMediaInfo(const SourcePlayback& sourcePlayback) {
+    std::optional<std::string> mediaFile = getMediaFile(sourcePlayback);
+    if (!mediaFile.has_value()) {
+        return std::nullopt;
+    }
+    return mediaIndex.getMediaInfo(mediaFile.value());
+}
+
 std::chrono::milliseconds RewardRedemptionQueue::getMediaEndDeadline(SourcePlayback& sourcePlayback) {
+    std::chrono::milliseconds deadline = POS_INFINITY;
     if (sourceSupportsLoopVideo(sourcePlayback.source) && sourcePlayback.settings.loopVideoEnabled) {
-        return std::chrono::milliseconds(static_cast<long long>(1000 * sourcePlayback.settings.loopVideoDurationSeconds)
-        );
-    }
-    std::int64_t durationMilliseconds = obs_source_media_get_duration(sourcePlayback.source);
-    if (durationMilliseconds != -1) {
-        std::int64_t deadlineMilliseconds = durationMilliseconds + durationMilliseconds / 2 + 3000;
-        return std::chrono::milliseconds(deadlineMilliseconds);
+        deadline =
+            std::chrono::milliseconds(static_cast<long long>(1000 * sourcePlayback.settings.loopVideoDurationSeconds));
     } else {
-        return POS_INFINITY;
+        std::int64_t durationMilliseconds = obsApi.getMediaDurationMilliseconds(sourcePlayback.source);
+        if (durationMilliseconds == -1) {
+            std::optional<MediaInfo> mediaInfo = getMediaInfo(sourcePlayback);
+            if (mediaInfo.has_value() && mediaInfo->duration.count() > 0) {
+                durationMilliseconds = mediaInfo->duration.count();
+            }
+        }
+        if (durationMilliseconds != -1) {
+            std::int64_t deadlineMilliseconds = durationMilliseconds + durationMilliseconds / 2 + 3000;
+            deadline = std::chrono::milliseconds(deadlineMilliseconds);
+        }
     }
+    if (sourcePlayback.maxPlayTime.has_value()) {
+        deadline = std::min(deadline, sourcePlayback.maxPlayTime.value());
+    }
+    return deadline;
 }
 
 asio::awaitable<void> RewardRedemptionQueue::asyncStopObsSourceIfPlayedByState(
@@ -364,17 +994,65 @@ bool RewardRedemptionQueue::isSourcePlayedByState(const SourcePlayback& sourcePl
     return sourcePlayedByState[sourcePlayback.source] == sourcePlayback.state;
 }
 
+std::optional<int> RewardRedemptionQueue::getSpeedPercent(obs_source_t* source, double drainLoad) const {
+    if (!isMediaSource(source) || isVlcSource(source)) {
+        return std::nullopt;
+    }
+    int ownSpeedPercent = getOwnSpeedPercent(source);
+    unsigned maxSpeedPercent = settings.getAdaptiveDrainMaxSpeedPercent();
+    if (maxSpeedPercent <= 100) {
+        return ownSpeedPercent;
+    }
+    // The speed is raised in steps, so that slightly different queue lengths don't reconfigure the source every time.
+    double speedUpSteps = drainLoad * (maxSpeedPercent - 100) / SPEED_UP_STEP_PERCENT;
+    int speedUpPercent = static_cast<int>(std::floor(speedUpSteps)) * SPEED_UP_STEP_PERCENT;
+    // The Media Source only supports speeds up to 200%.
+    return std::min(200, ownSpeedPercent * (100 + speedUpPercent) / 100);
+}
+
+int RewardRedemptionQueue::getOwnSpeedPercent(obs_source_t* source) const {
+    if (auto it = sourceOwnSpeedPercents.find(source); it != sourceOwnSpeedPercents.end()) {
+        return it->second;
+    }
+    boost::json::object sourceSettings = obsApi.getSourceSettings(source);
+    const boost::json::value* speedPercent = sourceSettings.if_contains("speed_percent");
+    if (!speedPercent || !speedPercent->is_int64()) {
+        return 100;
+    }
+    return static_cast<int>(speedPercent->as_int64());
+}
+
+void RewardRedemptionQueue::restoreOwnSpeedPercent(obs_source_t* source) {
+    auto it = sourceOwnSpeedPercents.find(source);
+    if (it == sourceOwnSpeedPercents.end()) {
+        return;
+    }
+    obsApi.updateSourceSettings(source, {{"speed_percent", std::int64_t{it->second}}});
+    sourceOwnSpeedPercents.erase(it);
+}
+
+std::optional<std::chrono::milliseconds> RewardRedemptionQueue::getMaxPlayTime(
+    const SourcePlaybackSettings& sourcePlaybackSettings,
+    double drainLoad
+) {
+    if (drainLoad <= 0 || !sourcePlaybackSettings.maxPlayTimeUnderLoadSeconds.has_value()) {
+        return std::nullopt;
+    }
+    double maxPlayTimeSeconds = sourcePlaybackSettings.maxPlayTimeUnderLoadSeconds.value();
+    return std::chrono::milliseconds(static_cast<long long>(1000 * maxPlayTimeSeconds));
+}
+
 asio::awaitable<void> RewardRedemptionQueue::asyncTestObsSource(
     std::string rewardId,
     std::string obsSourceName,
     SourcePlaybackSettings sourcePlaybackSettings,
-    QObjectCallback& callback
+    QObjectCallback<std::exception_ptr> callback
 ) {
     try {
         co_await asyncTestObsSource(rewardId, obsSourceName, sourcePlaybackSettings);
     } catch (const std::exception& exception) {
         log(LOG_ERROR, "Exception in asyncTestObsSource: {}", exception.what());
-        callback("std::exception_ptr", std::current_exception());
+        callback(std::current_exception());
     }
 }
 
@@ -383,32 +1061,39 @@ asio::awaitable<void> RewardRedemptionQueue::asyncTestObsSource(
     const std::string& obsSourceName,
     const SourcePlaybackSettings& sourcePlaybackSettings
 ) {
-    OBSSourceAutoRelease obsSource = getObsSource(obsSourceName);
+    ObsSourceRef obsSource = getObsSource(obsSourceName);
     if (!obsSource) {
         throw ObsSourceNotFoundException(obsSourceName);
     }
     co_await asyncPlayObsSource(rewardId, std::move(obsSource), sourcePlaybackSettings);
 }
 
-bool RewardRedemptionQueue::sourceSupportsLoopVideo(obs_source_t* source) {
+bool RewardRedemptionQueue::playsMediaDirectory(
+    obs_source_t* source,
+    const SourcePlaybackSettings& sourcePlaybackSettings
+) const {
+    return sourcePlaybackSettings.mediaDirectory.has_value() && !isVlcSource(source);
+}
+
+bool RewardRedemptionQueue::sourceSupportsLoopVideo(obs_source_t* source) const {
     if (!source) {
         // Return true if source doesn't exist as per the method contract, see header file.
         return true;
     }
-    return !isVlcSource(source) || getVlcPlaylistSize(source) == 1;
+    return !isVlcSource(source) || obsApi.getVlcPlaylistSize(source) == 1;
 }
 
-OBSSourceAutoRelease RewardRedemptionQueue::getObsSource(const RewardRedemption& rewardRedemption) const {
-    std::optional<std::string> obsSourceName = settings.getObsSourceName(rewardRedemption.reward.id);
+ObsSourceRef RewardRedemptionQueue::getObsSource(const RewardRedemption& rewardRedemption) const {
+    std::optional<std::string> obsSourceName = settings.getObsSourceName(rewardRedemption.reward->id);
     if (!obsSourceName) {
         return {};
     }
     return getObsSource(obsSourceName.value());
 }
 
-OBSSourceAutoRelease RewardRedemptionQueue::getObsSource(const std::string& obsSourceName) {
-    OBSSourceAutoRelease source = obs_get_source_by_name(obsSourceName.c_str());
-    if (!isMediaSource(source)) {
+ObsSourceRef RewardRedemptionQueue::getObsSource(const std::string& obsSourceName) const {
+    ObsSourceRef source = obsApi.getSourceByName(obsSourceName);
+    if (!isMediaSource(source.get())) {
         return {};
     }
     return source;
@@ -424,180 +1109,117 @@ void RewardRedemptionQueue::startObsSource(SourcePlayback& sourcePlayback) {
     showObsSource(sourcePlayback);
 }
 
-// See https://github.com/obsproject/obs-studio/blob/a1fbf1015f4079b79dc9ef4f6abecf67920e93cf/libobs/obs-internal.h#L547
-struct obs_context_data {
-    char* name;
-    const char* uuid;
-    void* data;
-    // Other fields
-};
-
-// See https://github.com/obsproject/obs-studio/blob/a1fbf1015f4079b79dc9ef4f6abecf67920e93cf/libobs/obs-internal.h#L693
-struct obs_source {
-    struct obs_context_data context;
-    // Other fields
-};
-
-// See
-// https://github.com/obsproject/obs-studio/blob/a1fbf1015f4079b79dc9ef4f6abecf67920e93cf/plugins/vlc-video/vlc-video-source.c#L56
-typedef DARRAY(struct media_file_data) media_file_array_t;
-
-struct vlc_source {
-    obs_source_t* source;
-
-    void* media_player;
-    libvlc_media_list_player_t* media_list_player;
-
-    struct obs_source_frame frame;
-    struct obs_source_audio audio;
-    size_t audio_capacity;
-
-    pthread_mutex_t mutex;
-    media_file_array_t files;
-    // Other fields
-};
-
-static vlc_source* getVlcSourceData(obs_source_t* source) {
-    if (!source) {
-        return nullptr;
-    }
-    obs_source* sourceInternal = reinterpret_cast<obs_source*>(source);
-    void* data = sourceInternal->context.data;
-    if (!data) {
-        return nullptr;
-    }
-    vlc_source* vlcSource = static_cast<vlc_source*>(data);
-    return vlcSource;
-}
-
 void RewardRedemptionQueue::startVlcSource(SourcePlayback& sourcePlayback) {
-    if (!libVlc.has_value()) {
+    if (!obsApi.isVlcAvailable()) {
         log(LOG_ERROR, "Cannot play VLC Source because libvlc wasn't loaded");
         return;
     }
     if (updateVlcSourceSettings(sourcePlayback)) {
         // VLC media player is going to be re-initialized after settings are changed which breaks the "play item at
         // index" for some reason.
-        obs_source_media_restart(sourcePlayback.source);
+        obsApi.restartMedia(sourcePlayback.source);
         return;
     }
 
-    sourcePlayback.playlistSize = getVlcPlaylistSize(sourcePlayback.source);
+    sourcePlayback.playlistSize = obsApi.getVlcPlaylistSize(sourcePlayback.source);
     if (sourcePlayback.playlistSize == 0) {
         log(LOG_ERROR, "VLC Source has an empty playlist");
         return;
     }
     std::uniform_int_distribution<std::size_t> randomSourceIndex(0, sourcePlayback.playlistSize - 1);
     sourcePlayback.playlistIndex = randomSourceIndex(randomEngine);
-
-    vlc_source* vlcSource = getVlcSourceData(sourcePlayback.source);
-    if (!vlcSource || !vlcSource->media_list_player) {
-        log(LOG_ERROR, "Could not get VLC player from source");
-        return;
-    }
-    libVlc->libvlc_media_list_player_play_item_at_index(
-        vlcSource->media_list_player, static_cast<int>(sourcePlayback.playlistIndex)
-    );
+    obsApi.playVlcPlaylistItem(sourcePlayback.source, sourcePlayback.playlistIndex);
 }
 
 void RewardRedemptionQueue::startMediaSource(SourcePlayback& sourcePlayback) {
     updateMediaSourceSettings(sourcePlayback);
-    obs_source_media_restart(sourcePlayback.source);
-}
-
-std::size_t RewardRedemptionQueue::getVlcPlaylistSize(obs_source_t* source) {
-    vlc_source* vlcSource = getVlcSourceData(source);
-    if (!vlcSource) {
-        log(LOG_ERROR, "Could not get VLC player from source");
-        return 0;
-    }
-    pthread_mutex_lock(&vlcSource->mutex);
-    std::size_t size = vlcSource->files.num;
-    pthread_mutex_unlock(&vlcSource->mutex);
-    return size;
+    obsApi.restartMedia(sourcePlayback.source);
 }
 
 bool RewardRedemptionQueue::updateVlcSourceSettings(SourcePlayback& sourcePlayback) {
-    OBSDataAutoRelease sourceSettings = obs_source_get_settings(sourcePlayback.source);
-    if (!sourceSettings) {
-        log(LOG_ERROR, "VLC Source settings are null");
+    boost::json::object sourceSettings = obsApi.getSourceSettings(sourcePlayback.source);
+    boost::json::object changedSettings;
+    setSetting(changedSettings, sourceSettings, "loop", sourcePlayback.settings.loopVideoEnabled);
+    setSetting(changedSettings, sourceSettings, "shuffle", false);
+    setSetting(changedSettings, sourceSettings, "playback_behavior", "stop_restart");
+    if (changedSettings.empty()) {
         return false;
     }
-    bool settingsChanged = false;
-    settingsChanged |= setObsDataBool(sourceSettings, "loop", sourcePlayback.settings.loopVideoEnabled);
-    settingsChanged |= setObsDataBool(sourceSettings, "shuffle", false);
-    settingsChanged |= setObsDataString(sourceSettings, "playback_behavior", "stop_restart");
-    if (settingsChanged) {
-        obs_source_update(sourcePlayback.source, sourceSettings);
-    }
-    return settingsChanged;
+    obsApi.updateSourceSettings(sourcePlayback.source, changedSettings);
+    return true;
 }
 
 bool RewardRedemptionQueue::updateMediaSourceSettings(SourcePlayback& sourcePlayback) {
-    OBSDataAutoRelease sourceSettings = obs_source_get_settings(sourcePlayback.source);
-    if (!sourceSettings) {
-        log(LOG_ERROR, "Media settings are null");
-        return false;
+    boost::json::object sourceSettings = obsApi.getSourceSettings(sourcePlayback.source);
+    boost::json::object changedSettings;
+    setSetting(changedSettings, sourceSettings, "looping", sourcePlayback.settings.loopVideoEnabled);
+    setSetting(changedSettings, sourceSettings, "clear_on_media_end", false);
+    setSetting(changedSettings, sourceSettings, "restart_on_activate", true);
+    if (sourcePlayback.mediaFile.has_value()) {
+        setSetting(changedSettings, sourceSettings, "is_local_file", true);
+        setSetting(changedSettings, sourceSettings, "local_file", boost::json::string(*sourcePlayback.mediaFile));
+    } else if (sourcePlayback.source != sourcePlayback.originalSource) {
+        // SourcePool doesn't copy the file, because the duplicate may have played a video from a folder before.
+        boost::json::object originalSettings = obsApi.getSourceSettings(sourcePlayback.originalSource);
+        for (const char* name : {"is_local_file", "local_file"}) {
+            if (const boost::json::value* value = originalSettings.if_contains(name)) {
+                setSetting(changedSettings, sourceSettings, name, *value);
+            }
+        }
     }
-    bool settingsChanged = false;
-    settingsChanged |= setObsDataBool(sourceSettings, "looping", sourcePlayback.settings.loopVideoEnabled);
-    settingsChanged |= setObsDataBool(sourceSettings, "clear_on_media_end", false);
-    settingsChanged |= setObsDataBool(sourceSettings, "restart_on_activate", true);
-    if (settingsChanged) {
-        obs_source_update(sourcePlayback.source, sourceSettings);
+    if (sourcePlayback.speedPercent.has_value()) {
+        if (sourcePlayback.source == sourcePlayback.originalSource &&
+            sourcePlayback.speedPercent.value() != getOwnSpeedPercent(sourcePlayback.source)) {
+            // Restored once the source stops, so that the user's source keeps its speed.
+            sourceOwnSpeedPercents.try_emplace(sourcePlayback.source, getOwnSpeedPercent(sourcePlayback.source));
+        }
+        setSetting(
+            changedSettings, sourceSettings, "speed_percent", std::int64_t{sourcePlayback.speedPercent.value()}
+        );
     }
-    return settingsChanged;
-}
-
-bool RewardRedemptionQueue::setObsDataBool(obs_data_t* data, const char* name, bool value) {
-    bool oldValue = obs_data_get_bool(data, name);
-    if (oldValue == value) {
+    if (changedSettings.empty()) {
         return false;
     }
-    obs_data_set_bool(data, name, value);
+    obsApi.updateSourceSettings(sourcePlayback.source, changedSettings);
     return true;
 }
 
-bool RewardRedemptionQueue::setObsDataString(obs_data_t* data, const char* name, const char* value) {
-    const char* oldValue = obs_data_get_string(data, name);
-    if (oldValue && std::strcmp(oldValue, value) == 0) {
+bool RewardRedemptionQueue::setSetting(
+    boost::json::object& changedSettings,
+    const boost::json::object& settings,
+    const char* name,
+    const boost::json::value& value
+) {
+    const boost::json::value* oldValue = settings.if_contains(name);
+    bool unchanged;
+    if (oldValue) {
+        unchanged = *oldValue == value;
+    } else {
+        // A missing setting reads as false, 0 or "" in OBS.
+        unchanged = (value.is_bool() && !value.get_bool()) || (value.is_int64() && value.get_int64() == 0) ||
+                    (value.is_string() && value.get_string().empty());
+    }
+    if (unchanged) {
         return false;
     }
-    obs_data_set_string(data, name, value);
+    changedSettings[name] = value;
     return true;
 }
 
 void RewardRedemptionQueue::showObsSource(SourcePlayback& sourcePlayback) {
-    struct ShowObsSourceCallback {
-        SourcePlayback& sourcePlayback;
-        std::map<std::string, vec2>& sourcePositionOnScenes;
-        Settings& settings;
-        std::default_random_engine& randomEngine;
-
-        static bool showObsSourceOnScene(void* param, obs_source_t* sceneSource) {
-            auto& [sourcePlayback, sourcePositionOnScenes, settings, randomEngine] =
-                *static_cast<ShowObsSourceCallback*>(param);
-            obs_scene_t* scene = obs_scene_from_source(sceneSource);
-            std::string sceneUuid = obs_source_get_uuid(sceneSource);
-            obs_sceneitem_t* sceneItem = findObsSource(scene, sourcePlayback.source);
-            if (!sceneItem) {
-                return true;
-            }
-
-            if (sourcePlayback.settings.randomPositionEnabled) {
-                if (!sourcePositionOnScenes.contains(sceneUuid)) {
-                    sourcePositionOnScenes[sceneUuid] = getSourcePosition(scene, sceneItem);
-                }
-                RewardRedemptionQueue::setSourceRandomPosition(
-                    sourcePlayback, scene, sceneItem, settings, randomEngine
-                );
+    std::map<std::string, ObsApi::Vec2>& sourcePositions = sourcePositionOnScenes[sourcePlayback.source];
+    std::optional<std::pair<std::uint32_t, std::uint32_t>> videoSize = getLastVideoSize(sourcePlayback);
+    SceneItemUpdatePlan plan(obsApi);
+    for (const ObsApi::SceneItem& sceneItem : obsApi.findSceneItems(sourcePlayback.source)) {
+        if (sourcePlayback.settings.randomPositionEnabled) {
+            if (!sourcePositions.contains(sceneItem.sceneUuid)) {
+                sourcePositions[sceneItem.sceneUuid] = obsApi.getSceneItemPosition(sceneItem);
             }
-            obs_sceneitem_set_visible(sceneItem, true);
-            return true;
+            setSourceRandomPosition(plan, sourcePlayback, sceneItem, videoSize);
         }
-    } callback{sourcePlayback, sourcePositionOnScenes[sourcePlayback.source], settings, randomEngine};
-
-    obs_enum_scenes(&ShowObsSourceCallback::showObsSourceOnScene, &callback);
+        plan.setVisible(sceneItem, true);
+    }
+    plan.apply();
 }
 
 asio::awaitable<void> RewardRedemptionQueue::asyncStopObsSource(
@@ -605,7 +1227,8 @@ asio::awaitable<void> RewardRedemptionQueue::asyncStopObsSource(
     bool waitForHideTransition
 ) {
     co_await asyncHideObsSource(sourcePlayback, waitForHideTransition);
-    obs_source_media_stop(sourcePlayback.source);
+    obsApi.stopMedia(sourcePlayback.source);
+    restoreOwnSpeedPercent(sourcePlayback.source);
 }
 
 asio::awaitable<void> RewardRedemptionQueue::asyncHideObsSource(
@@ -616,162 +1239,81 @@ asio::awaitable<void> RewardRedemptionQueue::asyncHideObsSource(
     // so there's no good way to show the hide transition.
     bool removeHideTransition = isVlcSource(sourcePlayback.source) && sourcePlayback.playlistSize > 1;
 
-    struct HideObsSourceCallback {
-        obs_source_t* source;
-        bool removeHideTransition;
-        uint32_t hideTransitionDurationMs = 0;
-
-        static bool hideObsSourceOnScene(void* param, obs_source_t* sceneSource) {
-            auto& [source, removeHideTransition, hideTransitionDurationMs] =
-                *static_cast<HideObsSourceCallback*>(param);
-            obs_scene_t* scene = obs_scene_from_source(sceneSource);
-            obs_sceneitem_t* sceneItem = findObsSource(scene, source);
-            if (!sceneItem) {
-                return true;
-            }
-
-            obs_sceneitem_set_visible(sceneItem, false);
-            if (obs_sceneitem_get_transition(sceneItem, false)) {
-                if (removeHideTransition) {
-                    obs_sceneitem_set_transition(sceneItem, false, nullptr);
-                } else {
-                    hideTransitionDurationMs =
-                        std::max(hideTransitionDurationMs, obs_sceneitem_get_transition_duration(sceneItem, false));
-                }
+    SceneItemUpdatePlan plan(obsApi);
+    std::chrono::milliseconds hideTransitionDuration{0};
+    for (const ObsApi::SceneItem& sceneItem : obsApi.findSceneItems(sourcePlayback.source)) {
+        plan.setVisible(sceneItem, false);
+        std::optional<std::chrono::milliseconds> transitionDuration =
+            obsApi.getSceneItemTransitionDuration(sceneItem.sceneItem.get(), false);
+        if (transitionDuration.has_value()) {
+            if (removeHideTransition) {
+                plan.removeHideTransition(sceneItem);
+            } else {
+                hideTransitionDuration = std::max(hideTransitionDuration, transitionDuration.value());
             }
-            return true;
         }
-    } callback{sourcePlayback.source, removeHideTransition};
-
-    obs_enum_scenes(&HideObsSourceCallback::hideObsSourceOnScene, &callback);
+    }
 
     if (waitForHideTransition) {
-        std::chrono::milliseconds hideTransitionDuration{callback.hideTransitionDurationMs};
-        co_await asio::steady_timer(ioContext, hideTransitionDuration).async_wait(asio::use_awaitable);
+        plan.apply();
+        co_await asio::steady_timer(executor, hideTransitionDuration).async_wait(asio::use_awaitable);
     }
-    restoreSourcePosition(sourcePlayback.source);
+    // Without waiting, the item is hidden and moved back in the same frame.
+    restoreSourcePosition(sourcePlayback.source, plan);
+    plan.apply();
 }
 
-void RewardRedemptionQueue::restoreSourcePosition(obs_source_t* source) {
-    struct RestoreSourcePositionCallback {
-        obs_source_t* source;
-        std::map<std::string, vec2>& sourcePositionOnScenes;
-
-        static bool restoreSourcePositionOnScene(void* param, obs_source_t* sceneSource) {
-            auto& [source, sourcePositionOnScenes] = *static_cast<RestoreSourcePositionCallback*>(param);
-            obs_scene_t* scene = obs_scene_from_source(sceneSource);
-            std::string sceneUuid = obs_source_get_uuid(sceneSource);
-            if (!sourcePositionOnScenes.contains(sceneUuid)) {
-                return true;
-            }
-            obs_sceneitem_t* sceneItem = findObsSource(scene, source);
-            if (sceneItem) {
-                setSourcePosition(scene, sceneItem, sourcePositionOnScenes[sceneUuid]);
-            }
-            return true;
+void RewardRedemptionQueue::restoreSourcePosition(obs_source_t* source, SceneItemUpdatePlan& plan) {
+    std::map<std::string, ObsApi::Vec2>& sourcePositions = sourcePositionOnScenes[source];
+    for (const ObsApi::SceneItem& sceneItem : obsApi.findSceneItems(source)) {
+        auto sourcePosition = sourcePositions.find(sceneItem.sceneUuid);
+        if (sourcePosition != sourcePositions.end()) {
+            plan.setPosition(sceneItem, sourcePosition->second);
         }
-    } callback{source, sourcePositionOnScenes[source]};
-
-    obs_enum_scenes(&RestoreSourcePositionCallback::restoreSourcePositionOnScene, &callback);
-}
-
-obs_sceneitem_t* RewardRedemptionQueue::findObsSource(obs_scene_t* scene, const obs_source_t* source) {
-    return obs_scene_find_source_recursive(scene, obs_source_get_name(source));
+    }
 }
 
 void RewardRedemptionQueue::setSourceRandomPosition(
+    SceneItemUpdatePlan& plan,
     SourcePlayback& sourcePlayback,
-    obs_scene_t* scene,
-    obs_scene_item* sceneItem,
-    Settings& settings,
-    std::default_random_engine& randomEngine
+    const ObsApi::SceneItem& sceneItem,
+    const std::optional<std::pair<std::uint32_t, std::uint32_t>>& videoSize
 ) {
-    obs_source_t* source = obs_sceneitem_get_source(sceneItem);
-    std::string sourceName = obs_source_get_name(source);
-    std::optional<std::pair<std::uint32_t, std::uint32_t>> size =
-        settings.getLastVideoSize(sourcePlayback.rewardId, sourceName, sourcePlayback.playlistIndex);
-    if (!size.has_value()) {
-        log(LOG_INFO, "Couldn't set random position for source {} - no size saved", sourceName);
+    if (!videoSize.has_value()) {
+        log(LOG_INFO, "Couldn't set random position for source {} - no size saved", sourcePlayback.obsSourceName);
         return;
     }
 
-    auto [width, height] = size.value();
-    obs_sceneitem_crop crop;
-    obs_sceneitem_get_crop(sceneItem, &crop);
+    auto [width, height] = videoSize.value();
+    ObsApi::Crop crop = obsApi.getSceneItemCrop(sceneItem.sceneItem.get());
     width -= crop.left + crop.right;
     height -= crop.top + crop.bottom;
 
-    vec2 scale = getSourceScale(scene, sceneItem);
+    ObsApi::Vec2 scale = obsApi.getSceneItemScale(sceneItem);
     float scaledWidth = width * scale.x;
     float scaledHeight = height * scale.y;
 
-    obs_video_info obsVideoInfo;
-    obs_get_video_info(&obsVideoInfo);
-    float maxX = std::max(0.f, obsVideoInfo.base_width - scaledWidth);
-    float maxY = std::max(0.f, obsVideoInfo.base_height - scaledHeight);
+    auto [baseWidth, baseHeight] = obsApi.getBaseVideoSize();
+    float maxX = std::max(0.f, baseWidth - scaledWidth);
+    float maxY = std::max(0.f, baseHeight - scaledHeight);
     std::uniform_real_distribution<float> xDistribution(0, maxX);
     std::uniform_real_distribution<float> yDistribution(0, maxY);
 
-    vec2 newPosition{xDistribution(randomEngine), yDistribution(randomEngine)};
-    setSourcePosition(scene, sceneItem, newPosition);
-}
-
-vec2 RewardRedemptionQueue::getSourcePosition(obs_scene_t* scene, obs_scene_item* sceneItem) {
-    vec2 position;
-    obs_sceneitem_get_pos(sceneItem, &position);
-
-    obs_scene_item* parentGroup = obs_sceneitem_get_group(scene, sceneItem);
-    if (parentGroup) {
-        vec2 parentPosition, parentScale;
-        obs_sceneitem_get_pos(parentGroup, &parentPosition);
-        obs_sceneitem_get_scale(parentGroup, &parentScale);
-
-        vec2_mul(&position, &position, &parentScale);
-        vec2_add(&position, &position, &parentPosition);
-    }
-    return position;
-}
-
-void RewardRedemptionQueue::setSourcePosition(obs_scene_t* scene, obs_scene_item* sceneItem, vec2 position) {
-    obs_scene_item* parentGroup = obs_sceneitem_get_group(scene, sceneItem);
-    if (parentGroup) {
-        vec2 parentPosition, parentScale;
-        obs_sceneitem_get_pos(parentGroup, &parentPosition);
-        obs_sceneitem_get_scale(parentGroup, &parentScale);
-
-        vec2_sub(&position, &position, &parentPosition);
-        vec2_div(&position, &position, &parentScale);
-    }
-    obs_sceneitem_set_pos(sceneItem, &position);
+    ObsApi::Vec2 newPosition{xDistribution(randomEngine), yDistribution(randomEngine)};
+    plan.setPosition(sceneItem, newPosition);
 }
 
-vec2 RewardRedemptionQueue::getSourceScale(obs_scene_t* scene, obs_scene_item* sceneItem) {
-    vec2 scale;
-    obs_sceneitem_get_scale(sceneItem, &scale);
-    obs_scene_item* parentGroup = obs_sceneitem_get_group(scene, sceneItem);
-    if (parentGroup) {
-        vec2 parentScale;
-        obs_sceneitem_get_scale(parentGroup, &parentScale);
-        vec2_mul(&scale, &scale, &parentScale);
-    }
-    return scale;
-}
-
-bool RewardRedemptionQueue::isMediaSource(const obs_source_t* source) {
+bool RewardRedemptionQueue::isMediaSource(obs_source_t* source) const {
     if (!source) {
         return false;
     }
-    if (isVlcSource(source)) {
-        return true;
-    }
-    const char* sourceId = obs_source_get_id(source);
-    return std::strcmp(sourceId, "ffmpeg_source") == 0;
+    std::string sourceId = obsApi.getSourceId(source);
+    return sourceId == "ffmpeg_source" || sourceId == "vlc_source";
 }
 
-bool RewardRedemptionQueue::isVlcSource(const obs_source_t* source) {
+bool RewardRedemptionQueue::isVlcSource(obs_source_t* source) const {
     if (!source) {
         return false;
     }
-    const char* sourceId = obs_source_get_id(source);
-    return std::strcmp(sourceId, "vlc_source") == 0;
+    return obsApi.getSourceId(source) == "vlc_source";
 }
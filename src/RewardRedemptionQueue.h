@@ -4,40 +4,66 @@
 #pragma once
 
 #include <QObject>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <future>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <obs.hpp>
 #include <optional>
 #include <random>
 #include <string>
 #include <thread>
+#include <utility>
+#include <variant>
 #include <vector>
 
 #include "BoostAsio.h"
 #include "IoThreadPool.h"
-#include "LibVlc.h"
+#include "MediaIndex.h"
+#include "MediaProber.h"
+#include "MpscRingBuffer.h"
+#include "ObsApi.h"
+#include "PluginMetrics.h"
+#include "QObjectCallback.h"
+#include "RedemptionStatusApi.h"
+#include "RedemptionTrace.h"
 #include "Reward.h"
+#include "SceneItemUpdatePlan.h"
 #include "Settings.h"
-#include "TwitchRewardsApi.h"
+#include "SourcePool.h"
 
 class RewardRedemptionQueue : public QObject {
     Q_OBJECT
 
 public:
-    RewardRedemptionQueue(Settings& settings, TwitchRewardsApi& twitchRewardsApi);
+    RewardRedemptionQueue(
+        ObsApi& obsApi,
+        Settings& settings,
+        RedemptionStatusApi& redemptionStatusApi,
+        PluginMetrics& pluginMetrics,
+        MediaIndex& mediaIndex,
+        MediaProber& mediaProber,
+        IoThreadPool::Strand executor
+    );
     ~RewardRedemptionQueue() override;
 
     std::vector<RewardRedemption> getRewardRedemptionQueue() const;
+    /// Doesn't take any locks: the redemption is put into a ring buffer and handled later on the executor.
     void queueRewardRedemption(const RewardRedemption& rewardRedemption);
     void removeRewardRedemption(const RewardRedemption& rewardRedemption);
 
-    static std::vector<std::string> enumObsSources();
+    std::vector<std::string> enumObsSources();
 
+    /// Rewards played from the queue per hour of the time it wasn't empty. std::nullopt until a reward is played.
+    std::optional<double> getRewardRedemptionsPerHour() const;
+    /// Time until the queue is empty at the current throughput. std::nullopt if it's unknown.
+    std::optional<std::chrono::seconds> getProjectedDrainTime() const;
+
+    /// While the playback is paused, the mapped rewards are paused on Twitch too.
     bool isRewardPlaybackPaused() const;
     void setRewardPlaybackPaused(bool paused);
 
@@ -55,7 +81,13 @@ public:
         const std::string obsSourceName;
     };
 
-    /// Plays back the source as a test. Calls the receiver with an std::exception_ptr if an exception happens.
+    /// Plays back the source as a test. Calls the callback with an std::exception_ptr if an exception happens.
+    void testObsSource(
+        const std::string& rewardId,
+        const std::string& obsSourceName,
+        const SourcePlaybackSettings& sourcePlaybackSettings,
+        QObjectCallback<std::exception_ptr> callback
+    );
     void testObsSource(
         const std::string& rewardId,
         const std::string& obsSourceName,
@@ -66,59 +98,166 @@ public:
 
     // Returns false if the loopVideoEnabled setting will be ignored. If no source with such name exists, returns true.
     bool sourceSupportsLoopVideo(const std::string& obsSourceName) const;
+    // Returns false if SourcePlaybackSettings::mediaDirectory will be ignored. If no source with such name exists,
+    // returns true.
+    bool sourceSupportsMediaDirectory(const std::string& obsSourceName) const;
+    /// Probes the videos that the reward plays in the background, so that random positioning works on the first play,
+    /// and prepares an instance of the source that the reward can play on.
+    void probeMediaInBackground(const std::string& rewardId);
 
 signals:
     void onRewardRedemptionQueueUpdated(const std::vector<RewardRedemption> rewardRedemptionQueue);
 
+public slots:
+    // Connected to TwitchRewardsApi::onRewardsUpdated.
+    void probeRewardsMediaInBackground(const std::variant<std::exception_ptr, std::vector<Reward>>& rewards);
+    void saveManageableRewardIds(const std::variant<std::exception_ptr, std::vector<Reward>>& rewards);
+
 private:
+    static constexpr std::size_t INCOMING_REWARD_REDEMPTIONS_CAPACITY = 1024;
+    static constexpr int SPEED_UP_STEP_PERCENT = 25;
+
+    void drainIncomingRewardRedemptions();
+    /// Returns true if the redemption should be put into the queue.
+    bool admitRewardRedemption(const RewardRedemption& rewardRedemption);
+    /// Set once by a playback and awaited by the queue. The timer is cancelled to notify, as in a condition variable.
+    struct PlaybackEvent {
+        boost::asio::steady_timer condVar;
+        bool isSet = false;
+
+        PlaybackEvent(IoThreadPool::Strand executor);
+        void set();
+        boost::asio::awaitable<void> asyncWait();
+    };
+
+    /// A playback of the redemption at the front of the queue. Only used on the executor.
+    struct QueuedPlayback {
+        const RewardRedemption rewardRedemption;
+        /// Name of the source that the reward is mapped to.
+        const std::string obsSourceName;
+        /// The instance of the source that plays the redemption, or null if it hasn't started yet.
+        obs_source_t* playedSource = nullptr;
+        /// Set when the user removes the redemption, so that it isn't started anymore.
+        bool canceled = false;
+        /// Also set if the playback finishes without hiding the source.
+        PlaybackEvent hidingStarted;
+        PlaybackEvent finished;
+
+        QueuedPlayback(IoThreadPool::Strand executor, RewardRedemption rewardRedemption, std::string obsSourceName);
+    };
+
     boost::asio::awaitable<void> asyncPlayRewardRedemptionsFromQueue();
+    /// Starts the redemption and returns once its source starts being hidden (and the interval has passed), so that
+    /// the next redemption can be shown during the hide transition. Waits for the earlier playbacks from
+    /// unfinishedPlaybacks that may still be hiding the same source.
+    boost::asio::awaitable<void> asyncPlayPipelined(const RewardRedemption& rewardRedemption);
+    boost::asio::awaitable<void> asyncPlayPipelinedObsSource(
+        std::vector<RewardRedemption> rewardRedemptions,
+        std::shared_ptr<QueuedPlayback> playback,
+        double drainLoad
+    );
+    /// Stops only the instance that plays the redemption, so that the earlier playbacks finish their hide transitions.
+    void cancelQueuedPlayback(const RewardRedemption& rewardRedemption);
     boost::asio::awaitable<RewardRedemption> asyncGetNextRewardRedemption();
     void notifyRewardRedemptionQueueCondVar();
-    boost::asio::awaitable<void> popPlayedRewardRedemptionFromQueue(const RewardRedemption& rewardRedemption);
+    /// Must be called with rewardRedemptionQueueMutex held after the queue is changed.
+    void updateQueueBusyDuration();
+    /// Must be called with rewardRedemptionQueueMutex held.
+    std::optional<double> calculateRewardRedemptionsPerHour() const;
+    /// Must be called with rewardRedemptionQueueMutex held.
+    std::optional<std::chrono::seconds> calculateProjectedDrainTime() const;
+    /// Pauses the mapped rewards on Twitch while the playback is paused or the queue is above the high water mark,
+    /// and resumes them once neither is the case. Must be called with rewardRedemptionQueueMutex held after the queue
+    /// or the pause is changed.
+    void updateRewardsPausedOnTwitch();
+    /// Must be called with rewardRedemptionQueueMutex held.
+    void pauseRewardsOnTwitch();
+    /// From 0 if the queue is at most Settings::getAdaptiveDrainThreshold() long, to 1 if it's twice as long or longer.
+    double getDrainLoad() const;
+    std::chrono::milliseconds getIntervalBetweenRewards(double minIntervalSeconds, double drainLoad) const;
+    /// The redemptions at the front of the queue that are played once: the consecutive redemptions of the same reward
+    /// that were received within Settings::getRedemptionCoalescingWindowSeconds() of the first one.
+    std::vector<RewardRedemption> getCoalescedRewardRedemptions(const RewardRedemption& firstRewardRedemption) const;
+    /// The first redemption must be the one at the front of the queue when the playback started.
+    boost::asio::awaitable<void> popPlayedRewardRedemptionsFromQueue(
+        const std::vector<RewardRedemption>& rewardRedemptions
+    );
+    /// Shows "×N" in the text source from Settings::getRedemptionCountTextSourceName(), or clears it if N is 1.
+    /// Returns the state to pass to hideRedemptionCount.
+    unsigned showRedemptionCount(std::size_t rewardRedemptionCount);
+    /// Clears the text unless another playback has shown its count since.
+    void hideRedemptionCount(unsigned state);
+    void setRedemptionCountText(const std::string& text);
 
     void playObsSource(
         const std::string& rewardId,
         const std::string& obsSourceName,
-        const SourcePlaybackSettings& sourcePlaybackSettings
+        const SourcePlaybackSettings& sourcePlaybackSettings,
+        std::shared_ptr<RedemptionTrace> trace
     );
     void playObsSource(
         const std::string& rewardId,
-        OBSSourceAutoRelease source,
-        const SourcePlaybackSettings& sourcePlaybackSettings
+        ObsSourceRef source,
+        const SourcePlaybackSettings& sourcePlaybackSettings,
+        std::shared_ptr<RedemptionTrace> trace = nullptr
     );
 
     boost::asio::awaitable<void> asyncPlayObsSource(
         std::string rewardId,
-        OBSSourceAutoRelease source,
-        SourcePlaybackSettings sourcePlaybackSettings
+        ObsSourceRef source,
+        SourcePlaybackSettings sourcePlaybackSettings,
+        std::shared_ptr<RedemptionTrace> trace = nullptr,
+        QueuedPlayback* playback = nullptr,
+        double drainLoad = 0
     );
 
     struct SourcePlayback {
         const unsigned state;
         const std::string rewardId;
+        /// Either the source that the reward is mapped to or its duplicate from SourcePool.
         obs_source_t* const source;
+        /// The source that the reward is mapped to.
+        obs_source_t* const originalSource;
+        /// Name of the source that the reward is mapped to.
+        const std::string obsSourceName;
         const SourcePlaybackSettings settings;
         std::size_t playlistIndex;
         std::size_t playlistSize;
+        /// The video picked from SourcePlaybackSettings::mediaDirectory, if it's set.
+        const std::optional<std::string> mediaFile;
+        /// Set for the Media Source.
+        const std::optional<int> speedPercent;
+        /// Set if the reward is cut short because the queue is long.
+        const std::optional<std::chrono::milliseconds> maxPlayTime;
     };
 
-    struct MediaStartedCallback {
-        boost::asio::io_context& ioContext;
+    struct MediaStartedCallback : std::enable_shared_from_this<MediaStartedCallback> {
+        ObsApi& obsApi;
+        IoThreadPool::Strand executor;
+        obs_source_t* const source;
+        const std::shared_ptr<RedemptionTrace> trace;
         bool mediaStarted = false;
         bool enabled = true;
 
-        MediaStartedCallback(boost::asio::io_context& ioContext);
-        static void setMediaStarted(void* param, calldata_t* data);
+        MediaStartedCallback(
+            ObsApi& obsApi,
+            IoThreadPool::Strand executor,
+            obs_source_t* source,
+            std::shared_ptr<RedemptionTrace> trace
+        );
+        void setMediaStarted();
+        /// The source is visible once it's both playing and shown on the program output.
+        void stampVisibleIfMediaStarted();
     };
 
-    struct MediaEndedCallback {
-        boost::asio::io_context& ioContext;
+    struct MediaEndedCallback : std::enable_shared_from_this<MediaEndedCallback> {
+        IoThreadPool::Strand executor;
         boost::asio::steady_timer& deadlineTimer;
         bool mediaEnded = false;
         bool enabled = true;
 
-        MediaEndedCallback(boost::asio::io_context& ioContext, boost::asio::steady_timer& deadlineTimer);
-        static void stopDeadlineTimer(void* param, calldata_t* data);
+        MediaEndedCallback(IoThreadPool::Strand executor, boost::asio::steady_timer& deadlineTimer);
+        void stopDeadlineTimer();
     };
 
     boost::asio::awaitable<void> asyncCheckMediaStarted(
@@ -126,72 +265,101 @@ private:
         MediaStartedCallback& mediaStartedCallback
     );
     void saveLastVideoSize(SourcePlayback& sourcePlayback);
+    std::optional<std::pair<std::uint32_t, std::uint32_t>> getLastVideoSize(const SourcePlayback& sourcePlayback);
+    /// The file that is played, if it's known.
+    std::optional<std::string> getMediaFile(const SourcePlayback& sourcePlayback);
+    std::optional<MediaInfo> getMediaInfo(const SourcePlayback& sourcePlayback);
     std::chrono::milliseconds getMediaEndDeadline(SourcePlayback& sourcePlayback);
     boost::asio::awaitable<void> asyncStopObsSourceIfPlayedByState(
         SourcePlayback& sourcePlayback,
         bool waitForHideTransition
     );
     bool isSourcePlayedByState(const SourcePlayback& sourcePlayback);
+    std::optional<int> getSpeedPercent(obs_source_t* source, double drainLoad) const;
+    /// The speed that the user set for the source, even while it's played faster.
+    int getOwnSpeedPercent(obs_source_t* source) const;
+    void restoreOwnSpeedPercent(obs_source_t* source);
+    static std::optional<std::chrono::milliseconds> getMaxPlayTime(
+        const SourcePlaybackSettings& sourcePlaybackSettings,
+        double drainLoad
+    );
 
     boost::asio::awaitable<void> asyncTestObsSource(
         std::string rewardId,
         std::string obsSourceName,
         SourcePlaybackSettings sourcePlaybackSettings,
-        QObjectCallback& callback
+        QObjectCallback<std::exception_ptr> callback
     );
     boost::asio::awaitable<void> asyncTestObsSource(
         const std::string& rewardId,
         const std::string& obsSourceName,
         const SourcePlaybackSettings& sourcePlaybackSettings
     );
-    static bool sourceSupportsLoopVideo(obs_source_t* source);
+    bool sourceSupportsLoopVideo(obs_source_t* source) const;
+    /// Returns true if the reward plays a video from SourcePlaybackSettings::mediaDirectory on the source.
+    bool playsMediaDirectory(obs_source_t* source, const SourcePlaybackSettings& sourcePlaybackSettings) const;
 
-    OBSSourceAutoRelease getObsSource(const RewardRedemption& rewardRedemption) const;
-    static OBSSourceAutoRelease getObsSource(const std::string& sourceName);
+    ObsSourceRef getObsSource(const RewardRedemption& rewardRedemption) const;
+    ObsSourceRef getObsSource(const std::string& sourceName) const;
 
     void startObsSource(SourcePlayback& sourcePlayback);
     void startVlcSource(SourcePlayback& sourcePlayback);
-    static void startMediaSource(SourcePlayback& sourcePlayback);
-    static std::size_t getVlcPlaylistSize(obs_source_t* source);
-    static bool updateVlcSourceSettings(SourcePlayback& sourcePlayback);
-    static bool updateMediaSourceSettings(SourcePlayback& sourcePlayback);
-    // Returns true if the value has been changed
-    static bool setObsDataBool(obs_data_t* data, const char* name, bool value);
-    static bool setObsDataString(obs_data_t* data, const char* name, const char* value);
+    void startMediaSource(SourcePlayback& sourcePlayback);
+    bool updateVlcSourceSettings(SourcePlayback& sourcePlayback);
+    bool updateMediaSourceSettings(SourcePlayback& sourcePlayback);
+    /// Adds the value to changedSettings if it differs from the one in settings. Returns true if it does.
+    static bool setSetting(
+        boost::json::object& changedSettings,
+        const boost::json::object& settings,
+        const char* name,
+        const boost::json::value& value
+    );
 
     void showObsSource(SourcePlayback& sourcePlayback);
     boost::asio::awaitable<void> asyncStopObsSource(SourcePlayback& sourcePlayback, bool waitForHideTransition);
     boost::asio::awaitable<void> asyncHideObsSource(SourcePlayback& sourcePlayback, bool waitForHideTransition);
-    void restoreSourcePosition(obs_source_t* source);
-    static obs_sceneitem_t* findObsSource(obs_scene_t* scene, const obs_source_t* source);
+    void restoreSourcePosition(obs_source_t* source, SceneItemUpdatePlan& plan);
 
-    static void setSourceRandomPosition(
+    void setSourceRandomPosition(
+        SceneItemUpdatePlan& plan,
         SourcePlayback& sourcePlayback,
-        obs_scene_t* scene,
-        obs_scene_item* sceneItem,
-        Settings& settings,
-        std::default_random_engine& randomEngine
+        const ObsApi::SceneItem& sceneItem,
+        const std::optional<std::pair<std::uint32_t, std::uint32_t>>& videoSize
     );
-    static vec2 getSourcePosition(obs_scene_t* scene, obs_scene_item* sceneItem);
-    static void setSourcePosition(obs_scene_t* scene, obs_scene_item* sceneItem, vec2 position);
-    static vec2 getSourceScale(obs_scene_t* scene, obs_scene_item* sceneItem);
-    static bool isMediaSource(const obs_source_t* source);
-    static bool isVlcSource(const obs_source_t* source);
+    bool isMediaSource(obs_source_t* source) const;
+    bool isVlcSource(obs_source_t* source) const;
 
+    ObsApi& obsApi;
     Settings& settings;
-    TwitchRewardsApi& twitchRewardsApi;
+    RedemptionStatusApi& redemptionStatusApi;
+    PluginMetrics& pluginMetrics;
+    MediaIndex& mediaIndex;
+    MediaProber& mediaProber;
 
-    IoThreadPool rewardRedemptionQueueThread;
-    boost::asio::io_context& ioContext;
+    IoThreadPool::Strand executor;
+    MpscRingBuffer<RewardRedemption, INCOMING_REWARD_REDEMPTIONS_CAPACITY> incomingRewardRedemptions;
+    std::atomic<bool> incomingRewardRedemptionsDrainScheduled;
     std::vector<RewardRedemption> rewardRedemptionQueue;
     bool rewardPlaybackPaused;
     mutable std::mutex rewardRedemptionQueueMutex;
     boost::asio::steady_timer rewardRedemptionQueueCondVar;
+    std::chrono::steady_clock::duration queueBusyDuration;
+    std::optional<std::chrono::steady_clock::time_point> queueBusySince;
+    std::uint64_t playedRewardRedemptionCount;
+    unsigned redemptionCountState;
+    bool backpressureActive;
+    /// The rewards that RewardsTheater may pause on Twitch, without the ones that the user has paused.
+    std::vector<std::string> manageableRewardIds;
+    std::vector<std::string> rewardIdsPausedOnTwitch;
 
     unsigned playObsSourceState;
     std::map<obs_source_t*, unsigned> sourcePlayedByState;
-    std::map<obs_source_t*, std::map<std::string, vec2>> sourcePositionOnScenes;
-    const std::optional<LibVlc> libVlc;
+    std::map<obs_source_t*, std::map<std::string, ObsApi::Vec2>> sourcePositionOnScenes;
+    /// The speeds that the user set for the sources that are played at another speed right now.
+    std::map<obs_source_t*, int> sourceOwnSpeedPercents;
+    SourcePool sourcePool;
+    /// Including the ones that still hide their sources in the pipelined mode.
+    std::vector<std::shared_ptr<QueuedPlayback>> unfinishedPlaybacks;
 
     std::default_random_engine randomEngine;
 };
@@ -3,6 +3,12 @@
 
 #include "RewardRedemptionQueueDialog.h"
 
+#include <fmt/core.h>
+#include <obs-module.h>
+
+#include <chrono>
+#include <cmath>
+
 #include "RewardRedemptionWidget.h"
 #include "ui_RewardRedemptionQueueDialog.h"
 
@@ -41,4 +47,32 @@ void RewardRedemptionQueueDialog::showRewardRedemptions(const std::vector<Reward
         );
         ui->rewardRedemptionsLayout->addWidget(rewardRedemptionWidget);
     }
+    showThroughput();
+    showDrainTime();
+}
+
+void RewardRedemptionQueueDialog::showThroughput() {
+    std::optional<double> rewardRedemptionsPerHour = rewardRedemptionQueue.getRewardRedemptionsPerHour();
+    if (!rewardRedemptionsPerHour.has_value()) {
+        ui->throughputLabel->clear();
+        return;
+    }
+    std::string throughput = fmt::format(
+        fmt::runtime(obs_module_text("RewardRedemptionQueueThroughput")), std::lround(rewardRedemptionsPerHour.value())
+    );
+    ui->throughputLabel->setText(QString::fromStdString(throughput));
+}
+
+void RewardRedemptionQueueDialog::showDrainTime() {
+    std::optional<std::chrono::seconds> drainTime = rewardRedemptionQueue.getProjectedDrainTime();
+    if (!drainTime.has_value() || drainTime->count() == 0) {
+        ui->drainTimeLabel->clear();
+        return;
+    }
+    std::string drainTimeText = fmt::format(
+        fmt::runtime(obs_module_text("RewardRedemptionQueueDrainTime")),
+        drainTime->count() / 60,
+        drainTime->count() % 60
+    );
+    ui->drainTimeLabel->setText(QString::fromStdString(drainTimeText));
 }
@@ -26,6 +26,9 @@ private slots:
     void showRewardRedemptions(const std::vector<RewardRedemption>& rewardRedemptionQueue);
 
 private:
+    void showThroughput();
+    void showDrainTime();
+
     RewardRedemptionQueue& rewardRedemptionQueue;
     std::unique_ptr<Ui::RewardRedemptionQueueDialog> ui;
 };
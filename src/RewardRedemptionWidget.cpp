@@ -9,7 +9,7 @@
 RewardRedemptionWidget::RewardRedemptionWidget(const RewardRedemption& rewardRedemption, QWidget* parent)
     : QWidget(parent), rewardRedemption(rewardRedemption), ui(std::make_unique<Ui::RewardRedemptionWidget>()) {
     ui->setupUi(this);
-    ui->titleLabel->setText(QString::fromStdString(rewardRedemption.reward.title));
+    ui->titleLabel->setText(QString::fromStdString(rewardRedemption.reward->title));
     connect(ui->deleteButton, &QToolButton::clicked, this, &RewardRedemptionWidget::emitRewardRedemptionRemoved);
 }
 
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "RewardRegistry.h"
+
+std::shared_ptr<const Reward> RewardRegistry::intern(const Reward& reward) {
+    std::lock_guard<std::mutex> guard(rewardByIdMutex);
+    std::shared_ptr<const Reward>& registeredReward = rewardById[reward.id];
+    if (!registeredReward || *registeredReward != reward) {
+        registeredReward = std::make_shared<const Reward>(reward);
+    }
+    return registeredReward;
+}
+
+std::shared_ptr<const Reward> RewardRegistry::internEventsubReward(const Reward& reward) {
+    std::lock_guard<std::mutex> guard(rewardByIdMutex);
+    std::shared_ptr<const Reward>& registeredReward = rewardById[reward.id];
+    if (!registeredReward || registeredReward->title != reward.title ||
+        registeredReward->description != reward.description || registeredReward->cost != reward.cost) {
+        registeredReward = std::make_shared<const Reward>(reward);
+    }
+    return registeredReward;
+}
+
+void RewardRegistry::remove(const std::string& rewardId) {
+    std::lock_guard<std::mutex> guard(rewardByIdMutex);
+    rewardById.erase(rewardId);
+}
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "Reward.h"
+
+/// Keeps one immutable copy of every known reward, so that redemptions share it instead of copying the reward.
+/// When a reward changes, its entry is replaced, and redemptions that are already queued keep the old copy.
+class RewardRegistry {
+public:
+    /// Returns the registered reward if it's equal to `reward`, otherwise registers `reward` in its place.
+    std::shared_ptr<const Reward> intern(const Reward& reward);
+
+    /// EventSub only provides the id, the title, the description and the cost of a reward. If they match the
+    /// registered reward, the registered reward (with all of its fields) is returned.
+    std::shared_ptr<const Reward> internEventsubReward(const Reward& reward);
+
+    void remove(const std::string& rewardId);
+
+private:
+    std::map<std::string, std::shared_ptr<const Reward>> rewardById;
+    std::mutex rewardByIdMutex;
+};
@@ -86,7 +86,7 @@ void RewardWidget::showReward() {
     ui->titleLabel->setText(QString::fromStdString(reward.title));
     std::string backgroundColorStyle = fmt::format("QFrame {{ background: {} }}", reward.backgroundColor.toHex());
     ui->costAndImageFrame->setStyleSheet(QString::fromStdString(backgroundColorStyle));
-    twitchRewardsApi.downloadImage(reward, this, "showImage");
+    twitchRewardsApi.downloadImage(reward, {this, &RewardWidget::showImage});
 }
 
 void RewardWidget::showEditRewardDialog() {
@@ -4,6 +4,7 @@
 #include <obs-frontend-api.h>
 #include <obs-module.h>
 
+#include <chrono>
 #include <exception>
 #include <memory>
 
@@ -21,8 +22,13 @@ static void on_frontend_event(obs_frontend_event event, void* data);
 bool obs_module_load() {
     log(LOG_INFO, "Loading plugin, version {}", REWARDS_THEATER_VERSION);
     try {
+        auto startTime = std::chrono::steady_clock::now();
         plugin = std::make_unique<RewardsTheaterPlugin>();
         obs_frontend_add_event_callback(on_frontend_event, nullptr);
+        auto loadTime = std::chrono::steady_clock::now() - startTime;
+        log(LOG_INFO,
+            "Loaded plugin in {} ms",
+            std::chrono::duration_cast<std::chrono::milliseconds>(loadTime).count());
         return true;
     } catch (const std::exception& exception) {
         log(LOG_ERROR, "Error while loading RewardsTheater: {}", exception.what());
@@ -8,13 +8,18 @@
 #include <obs-frontend-api.h>
 #include <obs-module.h>
 #include <obs.h>
+#include <util/platform.h>
+#include <util/util.hpp>
 
 #include <QAction>
 #include <QMainWindow>
 #include <QMessageBox>
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
+#include <fstream>
 #include <memory>
+#include <string>
 #include <thread>
 
 #include "Log.h"
@@ -29,28 +34,65 @@ static const int MIN_OBS_VERSION = MAKE_SEMANTIC_VERSION(31, 1, 1);
 static const char* const MIN_OBS_VERSION_STRING = "31.1.1";
 
 RewardsTheaterPlugin::RewardsTheaterPlugin()
-    : settings(getConfig()), ioThreadPool(std::max(2u, std::thread::hardware_concurrency())),
-      httpClient(ioThreadPool.ioContext), twitchAuth(
-                                              settings,
-                                              TWITCH_CLIENT_ID,
-                                              {"channel:read:redemptions", "channel:manage:redemptions"},
-                                              AUTH_SERVER_PORTS[std::random_device()() % AUTH_SERVER_PORTS.size()],
-                                              httpClient,
-                                              ioThreadPool.ioContext
-                                          ),
-      twitchRewardsApi(twitchAuth, httpClient, settings, ioThreadPool.ioContext),
-      githubUpdateApi(httpClient, ioThreadPool.ioContext), rewardRedemptionQueue(settings, twitchRewardsApi),
-      eventsubListener(twitchAuth, httpClient, rewardRedemptionQueue) {
+    : obsApi(getConfig()), settings(obsApi), ioThreadPool(getIoThreadCount(settings)), pluginMetrics(),
+      redemptionTracer(), prometheusExporter(pluginMetrics, redemptionTracer, ioThreadPool), httpClient(pluginMetrics),
+      twitchAuth(
+          obsApi,
+          settings,
+          TWITCH_CLIENT_ID,
+          {"channel:read:redemptions", "channel:manage:redemptions"},
+          AUTH_SERVER_PORTS[std::random_device()() % AUTH_SERVER_PORTS.size()],
+          httpClient,
+          prometheusExporter,
+          ioThreadPool.makeStrand("TwitchAuth")
+      ),
+      rewardRegistry(),
+      twitchRewardsApi(
+          twitchAuth,
+          httpClient,
+          settings,
+          rewardRegistry,
+          ioThreadPool.makeStrand("TwitchRewardsApi")
+      ),
+      replayRedemptionStatusApi(),
+      githubUpdateApi(httpClient, ioThreadPool.makeStrand("GithubUpdateApi")),
+      mediaIndex(getMediaIndexPath(), ioThreadPool.makeDedicatedStrand("MediaIndex")),
+      mediaProber(obsApi, mediaIndex, ioThreadPool.makeDedicatedStrand("MediaProber")),
+      rewardRedemptionQueue(
+          obsApi,
+          settings,
+          getRedemptionStatusApi(),
+          pluginMetrics,
+          mediaIndex,
+          mediaProber,
+          ioThreadPool.makeDedicatedStrand("RewardRedemptionQueue")
+      ),
+      eventsubListener(
+          twitchAuth,
+          httpClient,
+          rewardRedemptionQueue,
+          rewardRegistry,
+          redemptionTracer,
+          pluginMetrics,
+          ioThreadPool.makeStrand("EventsubListener")
+      ),
+      settingsDialog(nullptr) {
     checkMinObsVersion();
-
-    QMainWindow* mainWindow = static_cast<QMainWindow*>(obs_frontend_get_main_window());
-
-    obs_frontend_push_ui_translation(obs_module_get_string);
-    SettingsDialog* settingsDialog = new SettingsDialog(*this, mainWindow);
-    obs_frontend_pop_ui_translation();
-
-    QAction* action = static_cast<QAction*>(obs_frontend_add_tools_menu_qaction(obs_module_text("RewardsTheater")));
-    QObject::connect(action, &QAction::triggered, settingsDialog, &SettingsDialog::showAndActivate);
+    startExecutorMetricsLogging();
+    addToolsMenuAction();
+
+    QObject::connect(
+        &twitchRewardsApi,
+        &TwitchRewardsApi::onRewardsUpdated,
+        &rewardRedemptionQueue,
+        &RewardRedemptionQueue::probeRewardsMediaInBackground
+    );
+    QObject::connect(
+        &twitchRewardsApi,
+        &TwitchRewardsApi::onRewardsUpdated,
+        &rewardRedemptionQueue,
+        &RewardRedemptionQueue::saveManageableRewardIds
+    );
 
     twitchAuth.startService();
     githubUpdateApi.checkForUpdates();
@@ -60,6 +102,7 @@ RewardsTheaterPlugin::~RewardsTheaterPlugin() {
     // Stop the thread pool before destructing the objects that use it,
     // so that no callbacks are called on destructed objects.
     ioThreadPool.stop();
+    saveRedemptionTraces();
 }
 
 Settings& RewardsTheaterPlugin::getSettings() {
@@ -82,15 +125,111 @@ RewardRedemptionQueue& RewardsTheaterPlugin::getRewardRedemptionQueue() {
     return rewardRedemptionQueue;
 }
 
+RedemptionStatusApi& RewardsTheaterPlugin::getRedemptionStatusApi() {
+    if (EventsubListener::getReplayPath()) {
+        return replayRedemptionStatusApi;
+    }
+    return twitchRewardsApi;
+}
+
 const char* RewardsTheaterPlugin::UnsupportedObsVersionException::what() const noexcept {
     return "UnsupportedObsVersionException";
 }
 
+unsigned RewardsTheaterPlugin::getIoThreadCount(const Settings& settings) {
+    unsigned ioThreadCount = settings.getIoThreadCount();
+    if (ioThreadCount == 0) {
+        ioThreadCount = IoThreadPool::getDefaultThreadCount();
+    }
+    log(LOG_INFO, "Using {} IO threads", ioThreadCount);
+    return ioThreadCount;
+}
+
+void RewardsTheaterPlugin::startExecutorMetricsLogging() {
+    unsigned intervalSeconds = settings.getExecutorMetricsLogIntervalSeconds();
+    if (intervalSeconds != 0) {
+        ioThreadPool.startMetricsLogging(std::chrono::seconds(intervalSeconds), settings.getExecutorMetricsLogLevel());
+    }
+}
+
+void RewardsTheaterPlugin::addToolsMenuAction() {
+    QAction* action = static_cast<QAction*>(obs_frontend_add_tools_menu_qaction(obs_module_text("RewardsTheater")));
+    QObject::connect(action, &QAction::triggered, action, [this]() {
+        getSettingsDialog()->showAndActivate();
+    });
+
+    // Once the settings dialog exists, its TwitchAuthDialog shows these messages by itself.
+    QObject::connect(&twitchAuth, &TwitchAuth::onAuthenticationFailure, action, [this](std::exception_ptr reason) {
+        if (!settingsDialog) {
+            getSettingsDialog()->getTwitchAuthDialog()->showAuthenticationFailureMessage(reason);
+        }
+    });
+    QObject::connect(
+        &twitchAuth,
+        &TwitchAuth::onAccessTokenAboutToExpire,
+        action,
+        [this](std::chrono::seconds expiresIn) {
+            if (!settingsDialog) {
+                getSettingsDialog()->getTwitchAuthDialog()->showAccessTokenAboutToExpireMessage(expiresIn);
+            }
+        }
+    );
+}
+
+SettingsDialog* RewardsTheaterPlugin::getSettingsDialog() {
+    if (!settingsDialog) {
+        auto startTime = std::chrono::steady_clock::now();
+        QMainWindow* mainWindow = static_cast<QMainWindow*>(obs_frontend_get_main_window());
+        obs_frontend_push_ui_translation(obs_module_get_string);
+        settingsDialog = new SettingsDialog(*this, mainWindow);
+        obs_frontend_pop_ui_translation();
+        auto elapsed = std::chrono::steady_clock::now() - startTime;
+        log(LOG_INFO,
+            "Created the settings dialog in {} ms",
+            std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+    }
+    return settingsDialog;
+}
+
+void RewardsTheaterPlugin::saveRedemptionTraces() {
+    if (redemptionTracer.getSlowestTraces().empty()) {
+        return;
+    }
+    for (const RedemptionTracer::StageLatency& stageLatency : redemptionTracer.getStageLatencies()) {
+        log(LOG_INFO,
+            "Redemption stage {}: {}",
+            RedemptionTrace::getStageName(stageLatency.stage),
+            stageLatency.latency.toString());
+    }
+    log(LOG_INFO, "Redemption time to visible: {}", redemptionTracer.getTimeToVisibleLatency().toString());
+
+    BPtr<char> configPath = obs_module_config_path("");
+    BPtr<char> tracesPath = obs_module_config_path("redemption-traces.json");
+    if (!configPath || !tracesPath || os_mkdirs(configPath) == MKDIR_ERROR) {
+        log(LOG_ERROR, "Could not create the config directory to save redemption traces");
+        return;
+    }
+    std::ofstream tracesFile(tracesPath.Get());
+    tracesFile << redemptionTracer.exportChromeTrace();
+    log(LOG_INFO, "Saved the slowest redemption traces to {}", tracesPath.Get());
+}
+
 config_t* RewardsTheaterPlugin::getConfig() {
     // TODO: this should be obs_frontend_get_user_config, but then the settings must be migrated
     return obs_frontend_get_app_config();
 }
 
+std::filesystem::path RewardsTheaterPlugin::getMediaIndexPath() {
+    BPtr<char> configPath = obs_module_config_path("");
+    BPtr<char> mediaIndexPath = obs_module_config_path("media-index.json");
+    if (!configPath || !mediaIndexPath || os_mkdirs(configPath) == MKDIR_ERROR) {
+        log(LOG_ERROR, "Could not create the config directory to save the media index");
+        return {};
+    }
+    std::string path = mediaIndexPath.Get();
+    return std::filesystem::path(std::u8string(path.begin(), path.end()));
+}
+
 void RewardsTheaterPlugin::checkMinObsVersion() {
     if (obs_get_version() < MIN_OBS_VERSION) {
         std::string message = fmt::format(
@@ -6,16 +6,27 @@
 #include <util/config-file.h>
 
 #include <exception>
+#include <filesystem>
 
 #include "EventsubListener.h"
 #include "GithubUpdateApi.h"
 #include "HttpClient.h"
 #include "IoThreadPool.h"
+#include "LibObsApi.h"
+#include "MediaIndex.h"
+#include "MediaProber.h"
+#include "PluginMetrics.h"
+#include "PrometheusExporter.h"
+#include "RedemptionTracer.h"
+#include "ReplayRedemptionStatusApi.h"
 #include "RewardRedemptionQueue.h"
+#include "RewardRegistry.h"
 #include "Settings.h"
 #include "TwitchAuth.h"
 #include "TwitchRewardsApi.h"
 
+class SettingsDialog;
+
 class RewardsTheaterPlugin {
 public:
     RewardsTheaterPlugin();
@@ -32,14 +43,32 @@ private:
     };
 
     static config_t* getConfig();
+    static unsigned getIoThreadCount(const Settings& settings);
+    static std::filesystem::path getMediaIndexPath();
+    RedemptionStatusApi& getRedemptionStatusApi();
+    void startExecutorMetricsLogging();
+    void saveRedemptionTraces();
     void checkMinObsVersion();
+    void addToolsMenuAction();
+    /// The settings dialog is created when it's first needed, so that it doesn't slow down the OBS startup.
+    SettingsDialog* getSettingsDialog();
 
+    LibObsApi obsApi;
     Settings settings;
     IoThreadPool ioThreadPool;
+    PluginMetrics pluginMetrics;
+    RedemptionTracer redemptionTracer;
+    PrometheusExporter prometheusExporter;
     HttpClient httpClient;
     TwitchAuth twitchAuth;
+    RewardRegistry rewardRegistry;
     TwitchRewardsApi twitchRewardsApi;
+    ReplayRedemptionStatusApi replayRedemptionStatusApi;
     GithubUpdateApi githubUpdateApi;
+    MediaIndex mediaIndex;
+    MediaProber mediaProber;
     RewardRedemptionQueue rewardRedemptionQueue;
     EventsubListener eventsubListener;
+    // Owned by the OBS main window.
+    SettingsDialog* settingsDialog;
 };
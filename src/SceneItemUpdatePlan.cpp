@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "SceneItemUpdatePlan.h"
+
+#include <algorithm>
+#include <optional>
+
+SceneItemUpdatePlan::SceneItemUpdatePlan(ObsApi& obsApi) : obsApi(obsApi) {}
+
+void SceneItemUpdatePlan::setPosition(const ObsApi::SceneItem& sceneItem, ObsApi::Vec2 position) {
+    getSceneItemUpdate(sceneItem).position = position;
+}
+
+void SceneItemUpdatePlan::setVisible(const ObsApi::SceneItem& sceneItem, bool visible) {
+    getSceneItemUpdate(sceneItem).visible = visible;
+}
+
+void SceneItemUpdatePlan::removeHideTransition(const ObsApi::SceneItem& sceneItem) {
+    getSceneItemUpdate(sceneItem).removeHideTransition = true;
+}
+
+void SceneItemUpdatePlan::apply() {
+    for (const SceneUpdate& sceneUpdate : sceneUpdates) {
+        obsApi.updateSceneItems(sceneUpdate.scene.get(), sceneUpdate.sceneItemUpdates);
+    }
+    sceneUpdates.clear();
+}
+
+ObsApi::SceneItemUpdate& SceneItemUpdatePlan::getSceneItemUpdate(const ObsApi::SceneItem& sceneItem) {
+    auto sceneUpdate = std::find_if(sceneUpdates.begin(), sceneUpdates.end(), [&sceneItem](const SceneUpdate& update) {
+        return update.scene == sceneItem.scene;
+    });
+    if (sceneUpdate == sceneUpdates.end()) {
+        sceneUpdate = sceneUpdates.insert(sceneUpdates.end(), SceneUpdate{sceneItem.scene, {}});
+    }
+    std::vector<ObsApi::SceneItemUpdate>& sceneItemUpdates = sceneUpdate->sceneItemUpdates;
+    auto sceneItemUpdate = std::find_if(
+        sceneItemUpdates.begin(),
+        sceneItemUpdates.end(),
+        [&sceneItem](const ObsApi::SceneItemUpdate& update) {
+            return update.sceneItem == sceneItem.sceneItem;
+        }
+    );
+    if (sceneItemUpdate == sceneItemUpdates.end()) {
+        sceneItemUpdate = sceneItemUpdates.insert(
+            sceneItemUpdates.end(), ObsApi::SceneItemUpdate{sceneItem.sceneItem, false, std::nullopt, std::nullopt}
+        );
+    }
+    return *sceneItemUpdate;
+}
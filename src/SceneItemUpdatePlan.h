@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <vector>
+
+#include "ObsApi.h"
+
+/// Scene item changes that must show up in the same frame. They are collected first and then applied with one
+/// ObsApi::updateSceneItems per scene, so that a scene is never rendered with only some of them applied (for example,
+/// with an item already visible but still at its old position).
+class SceneItemUpdatePlan {
+public:
+    SceneItemUpdatePlan(ObsApi& obsApi);
+
+    /// The position is in the coordinates of the scene, even if the item is in a group.
+    void setPosition(const ObsApi::SceneItem& sceneItem, ObsApi::Vec2 position);
+    void setVisible(const ObsApi::SceneItem& sceneItem, bool visible);
+    void removeHideTransition(const ObsApi::SceneItem& sceneItem);
+
+    /// Applies the transitions, then the positions, then the visibility.
+    void apply();
+
+private:
+    struct SceneUpdate {
+        ObsSceneRef scene;
+        std::vector<ObsApi::SceneItemUpdate> sceneItemUpdates;
+    };
+
+    ObsApi::SceneItemUpdate& getSceneItemUpdate(const ObsApi::SceneItem& sceneItem);
+
+    ObsApi& obsApi;
+    std::vector<SceneUpdate> sceneUpdates;
+};
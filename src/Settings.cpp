@@ -3,42 +3,218 @@
 
 #include "Settings.h"
 
+#include <algorithm>
+
+#include "Log.h"
+
 static const char* const PLUGIN_NAME = "RewardsTheater";
 static const char* const REWARD_REDEMPTIONS_QUEUE_ENABLED_KEY = "REWARD_REDEMPTIONS_QUEUE_ENABLED_KEY";
 static const char* const INTERVAL_BETWEEN_REWARDS_SECONDS_KEY = "INTERVAL_BETWEEN_REWARDS_SECONDS_KEY";
+static const char* const PIPELINED_PLAYBACK_ENABLED_KEY = "PIPELINED_PLAYBACK_ENABLED_KEY";
+static const char* const ADAPTIVE_DRAIN_THRESHOLD_KEY = "ADAPTIVE_DRAIN_THRESHOLD_KEY";
+static const char* const ADAPTIVE_DRAIN_MIN_INTERVAL_SECONDS_KEY = "ADAPTIVE_DRAIN_MIN_INTERVAL_SECONDS_KEY";
+static const char* const ADAPTIVE_DRAIN_MAX_SPEED_PERCENT_KEY = "ADAPTIVE_DRAIN_MAX_SPEED_PERCENT_KEY";
+static const char* const REDEMPTION_COALESCING_WINDOW_SECONDS_KEY = "REDEMPTION_COALESCING_WINDOW_SECONDS_KEY";
+static const char* const REDEMPTION_COUNT_TEXT_SOURCE_KEY = "REDEMPTION_COUNT_TEXT_SOURCE_KEY";
+static const char* const BACKPRESSURE_HIGH_WATER_MARK_KEY = "BACKPRESSURE_HIGH_WATER_MARK_KEY";
+static const char* const BACKPRESSURE_LOW_WATER_MARK_KEY = "BACKPRESSURE_LOW_WATER_MARK_KEY";
+static const char* const BACKPRESSURE_HIGH_WATER_MARK_SECONDS_KEY = "BACKPRESSURE_HIGH_WATER_MARK_SECONDS_KEY";
+static const char* const BACKPRESSURE_LOW_WATER_MARK_SECONDS_KEY = "BACKPRESSURE_LOW_WATER_MARK_SECONDS_KEY";
+static const char* const REWARD_IDS_PAUSED_ON_TWITCH_KEY = "REWARD_IDS_PAUSED_ON_TWITCH_KEY";
+static const char* const IO_THREAD_COUNT_KEY = "IO_THREAD_COUNT_KEY";
+static const char* const EXECUTOR_METRICS_LOG_INTERVAL_SECONDS_KEY = "EXECUTOR_METRICS_LOG_INTERVAL_SECONDS_KEY";
+static const char* const EXECUTOR_METRICS_LOG_LEVEL_KEY = "EXECUTOR_METRICS_LOG_LEVEL_KEY";
+static const char* const MAX_SOURCE_INSTANCES_KEY = "MAX_SOURCE_INSTANCES_KEY";
 static const char* const TWITCH_ACCESS_TOKEN_KEY = "TWITCH_ACCESS_TOKEN_KEY";
+static const char* const TWITCH_USER_ID_KEY = "TWITCH_USER_ID_KEY";
+static const char* const TWITCH_USERNAME_KEY = "TWITCH_USERNAME_KEY";
 static const char* const RANDOM_POSITION_ENABLED_KEY = "RANDOM_POSITION_ENABLED_KEY";
 static const char* const LOOP_VIDEO_ENABLED_KEY = "LOOP_VIDEO_ENABLED_KEY";
 static const char* const LOOP_VIDEO_DURATION_KEY = "LOOP_VIDEO_DURATION_KEY";
+static const char* const MEDIA_DIRECTORY_KEY = "MEDIA_DIRECTORY_KEY";
+static const char* const MAX_PLAY_TIME_UNDER_LOAD_KEY = "MAX_PLAY_TIME_UNDER_LOAD_KEY";
 static const char* const LAST_OBS_SOURCE_NAME_KEY = "LAST_OBS_SOURCE_NAME_KEY";
 static const char* const LAST_VIDEO_WIDTH_KEY = "LAST_VIDEO_WIDTH_KEY";
 static const char* const LAST_VIDEO_HEIGHT_KEY = "LAST_VIDEO_HEIGHT_KEY";
 static const char* const LAST_PLAYLIST_SIZE_KEY = "LAST_PLAYLIST_SIZE_KEY";
 
-Settings::Settings(config_t* config) : config(config) {}
+Settings::Settings(ObsApi& obsApi) : obsApi(obsApi) {
+    // Defaults of the per-reward keys aren't registered, because that would grow the config with every reward.
+    // Their getters fall back to the default themselves.
+    obsApi.setConfigDefaultBool(PLUGIN_NAME, REWARD_REDEMPTIONS_QUEUE_ENABLED_KEY, true);
+    obsApi.setConfigDefaultDouble(PLUGIN_NAME, INTERVAL_BETWEEN_REWARDS_SECONDS_KEY, 0);
+    obsApi.setConfigDefaultBool(PLUGIN_NAME, PIPELINED_PLAYBACK_ENABLED_KEY, false);
+    obsApi.setConfigDefaultUint(PLUGIN_NAME, ADAPTIVE_DRAIN_THRESHOLD_KEY, 0);
+    obsApi.setConfigDefaultDouble(PLUGIN_NAME, ADAPTIVE_DRAIN_MIN_INTERVAL_SECONDS_KEY, 0);
+    obsApi.setConfigDefaultUint(PLUGIN_NAME, ADAPTIVE_DRAIN_MAX_SPEED_PERCENT_KEY, 100);
+    obsApi.setConfigDefaultDouble(PLUGIN_NAME, REDEMPTION_COALESCING_WINDOW_SECONDS_KEY, 0);
+    obsApi.setConfigDefaultUint(PLUGIN_NAME, BACKPRESSURE_HIGH_WATER_MARK_KEY, 0);
+    obsApi.setConfigDefaultUint(PLUGIN_NAME, BACKPRESSURE_LOW_WATER_MARK_KEY, 0);
+    obsApi.setConfigDefaultUint(PLUGIN_NAME, BACKPRESSURE_HIGH_WATER_MARK_SECONDS_KEY, 0);
+    obsApi.setConfigDefaultUint(PLUGIN_NAME, BACKPRESSURE_LOW_WATER_MARK_SECONDS_KEY, 0);
+    obsApi.setConfigDefaultString(PLUGIN_NAME, REWARD_IDS_PAUSED_ON_TWITCH_KEY, "");
+    obsApi.setConfigDefaultUint(PLUGIN_NAME, IO_THREAD_COUNT_KEY, 0);
+    obsApi.setConfigDefaultUint(PLUGIN_NAME, EXECUTOR_METRICS_LOG_INTERVAL_SECONDS_KEY, 0);
+    obsApi.setConfigDefaultInt(PLUGIN_NAME, EXECUTOR_METRICS_LOG_LEVEL_KEY, LOG_DEBUG);
+    obsApi.setConfigDefaultUint(PLUGIN_NAME, MAX_SOURCE_INSTANCES_KEY, 3);
+    obsApi.setConfigDefaultString(PLUGIN_NAME, TWITCH_ACCESS_TOKEN_KEY, "");
+}
 
 bool Settings::isRewardRedemptionQueueEnabled() const {
-    config_set_default_bool(config, PLUGIN_NAME, REWARD_REDEMPTIONS_QUEUE_ENABLED_KEY, true);
-    return config_get_bool(config, PLUGIN_NAME, REWARD_REDEMPTIONS_QUEUE_ENABLED_KEY);
+    return obsApi.getConfigBool(PLUGIN_NAME, REWARD_REDEMPTIONS_QUEUE_ENABLED_KEY);
 }
 
 void Settings::setRewardRedemptionQueueEnabled(bool rewardRedemptionQueueEnabled) {
-    config_set_bool(config, PLUGIN_NAME, REWARD_REDEMPTIONS_QUEUE_ENABLED_KEY, rewardRedemptionQueueEnabled);
+    obsApi.setConfigBool(PLUGIN_NAME, REWARD_REDEMPTIONS_QUEUE_ENABLED_KEY, rewardRedemptionQueueEnabled);
 }
 
 double Settings::getIntervalBetweenRewardsSeconds() const {
-    config_set_default_double(config, PLUGIN_NAME, INTERVAL_BETWEEN_REWARDS_SECONDS_KEY, 0);
-    return config_get_double(config, PLUGIN_NAME, INTERVAL_BETWEEN_REWARDS_SECONDS_KEY);
+    return obsApi.getConfigDouble(PLUGIN_NAME, INTERVAL_BETWEEN_REWARDS_SECONDS_KEY);
 }
 
 void Settings::setIntervalBetweenRewardsSeconds(double intervalBetweenRewardsSeconds) {
-    config_set_double(config, PLUGIN_NAME, INTERVAL_BETWEEN_REWARDS_SECONDS_KEY, intervalBetweenRewardsSeconds);
+    obsApi.setConfigDouble(PLUGIN_NAME, INTERVAL_BETWEEN_REWARDS_SECONDS_KEY, intervalBetweenRewardsSeconds);
+}
+
+bool Settings::isPipelinedPlaybackEnabled() const {
+    return obsApi.getConfigBool(PLUGIN_NAME, PIPELINED_PLAYBACK_ENABLED_KEY);
+}
+
+void Settings::setPipelinedPlaybackEnabled(bool pipelinedPlaybackEnabled) {
+    obsApi.setConfigBool(PLUGIN_NAME, PIPELINED_PLAYBACK_ENABLED_KEY, pipelinedPlaybackEnabled);
+}
+
+unsigned Settings::getAdaptiveDrainThreshold() const {
+    return static_cast<unsigned>(obsApi.getConfigUint(PLUGIN_NAME, ADAPTIVE_DRAIN_THRESHOLD_KEY));
+}
+
+void Settings::setAdaptiveDrainThreshold(unsigned adaptiveDrainThreshold) {
+    obsApi.setConfigUint(PLUGIN_NAME, ADAPTIVE_DRAIN_THRESHOLD_KEY, adaptiveDrainThreshold);
+}
+
+double Settings::getAdaptiveDrainMinIntervalSeconds() const {
+    return obsApi.getConfigDouble(PLUGIN_NAME, ADAPTIVE_DRAIN_MIN_INTERVAL_SECONDS_KEY);
+}
+
+void Settings::setAdaptiveDrainMinIntervalSeconds(double adaptiveDrainMinIntervalSeconds) {
+    obsApi.setConfigDouble(PLUGIN_NAME, ADAPTIVE_DRAIN_MIN_INTERVAL_SECONDS_KEY, adaptiveDrainMinIntervalSeconds);
+}
+
+unsigned Settings::getAdaptiveDrainMaxSpeedPercent() const {
+    return static_cast<unsigned>(obsApi.getConfigUint(PLUGIN_NAME, ADAPTIVE_DRAIN_MAX_SPEED_PERCENT_KEY));
+}
+
+void Settings::setAdaptiveDrainMaxSpeedPercent(unsigned adaptiveDrainMaxSpeedPercent) {
+    obsApi.setConfigUint(PLUGIN_NAME, ADAPTIVE_DRAIN_MAX_SPEED_PERCENT_KEY, adaptiveDrainMaxSpeedPercent);
+}
+
+double Settings::getRedemptionCoalescingWindowSeconds() const {
+    return obsApi.getConfigDouble(PLUGIN_NAME, REDEMPTION_COALESCING_WINDOW_SECONDS_KEY);
+}
+
+void Settings::setRedemptionCoalescingWindowSeconds(double redemptionCoalescingWindowSeconds) {
+    obsApi.setConfigDouble(PLUGIN_NAME, REDEMPTION_COALESCING_WINDOW_SECONDS_KEY, redemptionCoalescingWindowSeconds);
+}
+
+std::optional<std::string> Settings::getRedemptionCountTextSourceName() const {
+    return getOptionalString(REDEMPTION_COUNT_TEXT_SOURCE_KEY);
+}
+
+void Settings::setRedemptionCountTextSourceName(const std::optional<std::string>& redemptionCountTextSourceName) {
+    setOptionalString(REDEMPTION_COUNT_TEXT_SOURCE_KEY, redemptionCountTextSourceName);
+}
+
+unsigned Settings::getBackpressureHighWaterMark() const {
+    return static_cast<unsigned>(obsApi.getConfigUint(PLUGIN_NAME, BACKPRESSURE_HIGH_WATER_MARK_KEY));
+}
+
+void Settings::setBackpressureHighWaterMark(unsigned backpressureHighWaterMark) {
+    obsApi.setConfigUint(PLUGIN_NAME, BACKPRESSURE_HIGH_WATER_MARK_KEY, backpressureHighWaterMark);
+}
+
+unsigned Settings::getBackpressureLowWaterMark() const {
+    return static_cast<unsigned>(obsApi.getConfigUint(PLUGIN_NAME, BACKPRESSURE_LOW_WATER_MARK_KEY));
+}
+
+void Settings::setBackpressureLowWaterMark(unsigned backpressureLowWaterMark) {
+    obsApi.setConfigUint(PLUGIN_NAME, BACKPRESSURE_LOW_WATER_MARK_KEY, backpressureLowWaterMark);
+}
+
+unsigned Settings::getBackpressureHighWaterMarkSeconds() const {
+    return static_cast<unsigned>(obsApi.getConfigUint(PLUGIN_NAME, BACKPRESSURE_HIGH_WATER_MARK_SECONDS_KEY));
+}
+
+void Settings::setBackpressureHighWaterMarkSeconds(unsigned backpressureHighWaterMarkSeconds) {
+    obsApi.setConfigUint(PLUGIN_NAME, BACKPRESSURE_HIGH_WATER_MARK_SECONDS_KEY, backpressureHighWaterMarkSeconds);
+}
+
+unsigned Settings::getBackpressureLowWaterMarkSeconds() const {
+    return static_cast<unsigned>(obsApi.getConfigUint(PLUGIN_NAME, BACKPRESSURE_LOW_WATER_MARK_SECONDS_KEY));
+}
+
+void Settings::setBackpressureLowWaterMarkSeconds(unsigned backpressureLowWaterMarkSeconds) {
+    obsApi.setConfigUint(PLUGIN_NAME, BACKPRESSURE_LOW_WATER_MARK_SECONDS_KEY, backpressureLowWaterMarkSeconds);
+}
+
+std::vector<std::string> Settings::getRewardIdsPausedOnTwitch() const {
+    // Comma-separated, reward IDs are UUIDs.
+    std::string rewardIds = obsApi.getConfigString(PLUGIN_NAME, REWARD_IDS_PAUSED_ON_TWITCH_KEY);
+    std::vector<std::string> result;
+    std::size_t start = 0;
+    while (start < rewardIds.size()) {
+        std::size_t end = std::min(rewardIds.find(',', start), rewardIds.size());
+        result.push_back(rewardIds.substr(start, end - start));
+        start = end + 1;
+    }
+    return result;
+}
+
+void Settings::setRewardIdsPausedOnTwitch(const std::vector<std::string>& rewardIdsPausedOnTwitch) {
+    std::string rewardIds;
+    for (const std::string& rewardId : rewardIdsPausedOnTwitch) {
+        if (!rewardIds.empty()) {
+            rewardIds += ',';
+        }
+        rewardIds += rewardId;
+    }
+    obsApi.setConfigString(PLUGIN_NAME, REWARD_IDS_PAUSED_ON_TWITCH_KEY, rewardIds.c_str());
+}
+
+unsigned Settings::getIoThreadCount() const {
+    return static_cast<unsigned>(obsApi.getConfigUint(PLUGIN_NAME, IO_THREAD_COUNT_KEY));
+}
+
+void Settings::setIoThreadCount(unsigned ioThreadCount) {
+    obsApi.setConfigUint(PLUGIN_NAME, IO_THREAD_COUNT_KEY, ioThreadCount);
+}
+
+unsigned Settings::getExecutorMetricsLogIntervalSeconds() const {
+    return static_cast<unsigned>(obsApi.getConfigUint(PLUGIN_NAME, EXECUTOR_METRICS_LOG_INTERVAL_SECONDS_KEY));
+}
+
+void Settings::setExecutorMetricsLogIntervalSeconds(unsigned executorMetricsLogIntervalSeconds) {
+    obsApi.setConfigUint(PLUGIN_NAME, EXECUTOR_METRICS_LOG_INTERVAL_SECONDS_KEY, executorMetricsLogIntervalSeconds);
+}
+
+int Settings::getExecutorMetricsLogLevel() const {
+    return static_cast<int>(obsApi.getConfigInt(PLUGIN_NAME, EXECUTOR_METRICS_LOG_LEVEL_KEY));
+}
+
+void Settings::setExecutorMetricsLogLevel(int executorMetricsLogLevel) {
+    obsApi.setConfigInt(PLUGIN_NAME, EXECUTOR_METRICS_LOG_LEVEL_KEY, executorMetricsLogLevel);
+}
+
+unsigned Settings::getMaxSourceInstances() const {
+    return static_cast<unsigned>(obsApi.getConfigUint(PLUGIN_NAME, MAX_SOURCE_INSTANCES_KEY));
+}
+
+void Settings::setMaxSourceInstances(unsigned maxSourceInstances) {
+    obsApi.setConfigUint(PLUGIN_NAME, MAX_SOURCE_INSTANCES_KEY, maxSourceInstances);
 }
 
 std::optional<std::string> Settings::getTwitchAccessToken() const {
     std::lock_guard lock(configMutex);
-    config_set_default_string(config, PLUGIN_NAME, TWITCH_ACCESS_TOKEN_KEY, "");
-    std::string result = config_get_string(config, PLUGIN_NAME, TWITCH_ACCESS_TOKEN_KEY);
+    std::string result = obsApi.getConfigString(PLUGIN_NAME, TWITCH_ACCESS_TOKEN_KEY);
     if (result.empty()) {
         return {};
     } else {
@@ -49,16 +225,31 @@ std::optional<std::string> Settings::getTwitchAccessToken() const {
 void Settings::setTwitchAccessToken(const std::optional<std::string>& accessToken) {
     std::lock_guard lock(configMutex);
     if (accessToken) {
-        config_set_string(config, PLUGIN_NAME, TWITCH_ACCESS_TOKEN_KEY, accessToken.value().c_str());
+        obsApi.setConfigString(PLUGIN_NAME, TWITCH_ACCESS_TOKEN_KEY, accessToken.value().c_str());
     } else {
-        config_remove_value(config, PLUGIN_NAME, TWITCH_ACCESS_TOKEN_KEY);
+        obsApi.removeConfigValue(PLUGIN_NAME, TWITCH_ACCESS_TOKEN_KEY);
     }
 }
 
+std::optional<std::string> Settings::getTwitchUserId() const {
+    return getOptionalString(TWITCH_USER_ID_KEY);
+}
+
+void Settings::setTwitchUserId(const std::optional<std::string>& userId) {
+    setOptionalString(TWITCH_USER_ID_KEY, userId);
+}
+
+std::optional<std::string> Settings::getTwitchUsername() const {
+    return getOptionalString(TWITCH_USERNAME_KEY);
+}
+
+void Settings::setTwitchUsername(const std::optional<std::string>& username) {
+    setOptionalString(TWITCH_USERNAME_KEY, username);
+}
+
 std::optional<std::string> Settings::getObsSourceName(const std::string& rewardId) const {
     std::lock_guard lock(configMutex);
-    config_set_default_string(config, PLUGIN_NAME, rewardId.c_str(), "");
-    std::string result = config_get_string(config, PLUGIN_NAME, rewardId.c_str());
+    std::string result = obsApi.getConfigString(PLUGIN_NAME, rewardId.c_str());
     if (result.empty()) {
         return {};
     } else {
@@ -69,50 +260,89 @@ std::optional<std::string> Settings::getObsSourceName(const std::string& rewardI
 void Settings::setObsSourceName(const std::string& rewardId, const std::optional<std::string>& obsSourceName) {
     std::lock_guard lock(configMutex);
     if (obsSourceName.has_value()) {
-        config_set_string(config, PLUGIN_NAME, rewardId.c_str(), obsSourceName.value().c_str());
+        obsApi.setConfigString(PLUGIN_NAME, rewardId.c_str(), obsSourceName.value().c_str());
     } else {
-        config_remove_value(config, PLUGIN_NAME, rewardId.c_str());
+        obsApi.removeConfigValue(PLUGIN_NAME, rewardId.c_str());
     }
 }
 
 static std::string getRandomPositionEnabledKey(const std::string& rewardId);
 
 bool Settings::isRandomPositionEnabled(const std::string& rewardId) const {
-    config_set_default_bool(config, PLUGIN_NAME, getRandomPositionEnabledKey(rewardId).c_str(), false);
-    return config_get_bool(config, PLUGIN_NAME, getRandomPositionEnabledKey(rewardId).c_str());
+    return obsApi.getConfigBool(PLUGIN_NAME, getRandomPositionEnabledKey(rewardId).c_str());
 }
 
 void Settings::setRandomPositionEnabled(const std::string& rewardId, bool randomPositionEnabled) {
-    config_set_bool(config, PLUGIN_NAME, getRandomPositionEnabledKey(rewardId).c_str(), randomPositionEnabled);
+    obsApi.setConfigBool(PLUGIN_NAME, getRandomPositionEnabledKey(rewardId).c_str(), randomPositionEnabled);
 }
 
 static std::string getLoopVideoEnabledKey(const std::string& rewardId);
 
 bool Settings::isLoopVideoEnabled(const std::string& rewardId) const {
-    config_set_default_bool(config, PLUGIN_NAME, getLoopVideoEnabledKey(rewardId).c_str(), false);
-    return config_get_bool(config, PLUGIN_NAME, getLoopVideoEnabledKey(rewardId).c_str());
+    return obsApi.getConfigBool(PLUGIN_NAME, getLoopVideoEnabledKey(rewardId).c_str());
 }
 
 void Settings::setLoopVideoEnabled(const std::string& rewardId, bool loopVideoEnabled) {
-    config_set_bool(config, PLUGIN_NAME, getLoopVideoEnabledKey(rewardId).c_str(), loopVideoEnabled);
+    obsApi.setConfigBool(PLUGIN_NAME, getLoopVideoEnabledKey(rewardId).c_str(), loopVideoEnabled);
 }
 
 static std::string getLoopVideoDurationKey(const std::string& rewardId);
 
 double Settings::getLoopVideoDurationSeconds(const std::string& rewardId) const {
-    config_set_default_double(config, PLUGIN_NAME, getLoopVideoDurationKey(rewardId).c_str(), 5);
-    return config_get_double(config, PLUGIN_NAME, getLoopVideoDurationKey(rewardId).c_str());
+    std::string loopVideoDurationKey = getLoopVideoDurationKey(rewardId);
+    if (!obsApi.hasConfigUserValue(PLUGIN_NAME, loopVideoDurationKey.c_str())) {
+        return 5;
+    }
+    return obsApi.getConfigDouble(PLUGIN_NAME, loopVideoDurationKey.c_str());
 }
 
 void Settings::setLoopVideoDurationSeconds(const std::string& rewardId, double loopVideoDuration) {
-    config_set_double(config, PLUGIN_NAME, getLoopVideoDurationKey(rewardId).c_str(), loopVideoDuration);
+    obsApi.setConfigDouble(PLUGIN_NAME, getLoopVideoDurationKey(rewardId).c_str(), loopVideoDuration);
+}
+
+static std::string getMediaDirectoryKey(const std::string& rewardId);
+
+std::optional<std::string> Settings::getMediaDirectory(const std::string& rewardId) const {
+    return getOptionalString(getMediaDirectoryKey(rewardId).c_str());
+}
+
+void Settings::setMediaDirectory(const std::string& rewardId, const std::optional<std::string>& mediaDirectory) {
+    setOptionalString(getMediaDirectoryKey(rewardId).c_str(), mediaDirectory);
+}
+
+static std::string getMaxPlayTimeUnderLoadKey(const std::string& rewardId);
+
+std::optional<double> Settings::getMaxPlayTimeUnderLoadSeconds(const std::string& rewardId) const {
+    std::string maxPlayTimeUnderLoadKey = getMaxPlayTimeUnderLoadKey(rewardId);
+    if (!obsApi.hasConfigUserValue(PLUGIN_NAME, maxPlayTimeUnderLoadKey.c_str())) {
+        return {};
+    }
+    return obsApi.getConfigDouble(PLUGIN_NAME, maxPlayTimeUnderLoadKey.c_str());
+}
+
+void Settings::setMaxPlayTimeUnderLoadSeconds(
+    const std::string& rewardId,
+    const std::optional<double>& maxPlayTimeUnderLoadSeconds
+) {
+    std::string maxPlayTimeUnderLoadKey = getMaxPlayTimeUnderLoadKey(rewardId);
+    if (maxPlayTimeUnderLoadSeconds.has_value()) {
+        obsApi.setConfigDouble(PLUGIN_NAME, maxPlayTimeUnderLoadKey.c_str(), maxPlayTimeUnderLoadSeconds.value());
+    } else {
+        obsApi.removeConfigValue(PLUGIN_NAME, maxPlayTimeUnderLoadKey.c_str());
+    }
 }
 
 static std::string getLastVideoWidthKey(const std::string& rewardId, std::size_t playlistIndex);
 static std::string getLastVideoHeightKey(const std::string& rewardId, std::size_t playlistIndex);
 
 SourcePlaybackSettings Settings::getSourcePlaybackSettings(const std::string& rewardId) const {
-    return {isRandomPositionEnabled(rewardId), isLoopVideoEnabled(rewardId), getLoopVideoDurationSeconds(rewardId)};
+    return {
+        isRandomPositionEnabled(rewardId),
+        isLoopVideoEnabled(rewardId),
+        getLoopVideoDurationSeconds(rewardId),
+        getMediaDirectory(rewardId),
+        getMaxPlayTimeUnderLoadSeconds(rewardId),
+    };
 }
 
 void Settings::setSourcePlaybackSettings(
@@ -122,6 +352,8 @@ void Settings::setSourcePlaybackSettings(
     setRandomPositionEnabled(rewardId, sourcePlaybackSettings.randomPositionEnabled);
     setLoopVideoEnabled(rewardId, sourcePlaybackSettings.loopVideoEnabled);
     setLoopVideoDurationSeconds(rewardId, sourcePlaybackSettings.loopVideoDurationSeconds);
+    setMediaDirectory(rewardId, sourcePlaybackSettings.mediaDirectory);
+    setMaxPlayTimeUnderLoadSeconds(rewardId, sourcePlaybackSettings.maxPlayTimeUnderLoadSeconds);
 }
 
 std::optional<std::pair<std::uint32_t, std::uint32_t>> Settings::getLastVideoSize(
@@ -136,12 +368,10 @@ std::optional<std::pair<std::uint32_t, std::uint32_t>> Settings::getLastVideoSiz
 
     std::string lastVideoWidthKey = getLastVideoWidthKey(rewardId, playlistIndex);
     std::string lastVideoHeightKey = getLastVideoHeightKey(rewardId, playlistIndex);
-    config_set_default_uint(config, PLUGIN_NAME, lastVideoWidthKey.c_str(), 0);
-    config_set_default_uint(config, PLUGIN_NAME, lastVideoHeightKey.c_str(), 0);
     std::uint32_t lastVideoWidth =
-        static_cast<std::uint32_t>(config_get_uint(config, PLUGIN_NAME, lastVideoWidthKey.c_str()));
+        static_cast<std::uint32_t>(obsApi.getConfigUint(PLUGIN_NAME, lastVideoWidthKey.c_str()));
     std::uint32_t lastVideoHeight =
-        static_cast<std::uint32_t>(config_get_uint(config, PLUGIN_NAME, lastVideoHeightKey.c_str()));
+        static_cast<std::uint32_t>(obsApi.getConfigUint(PLUGIN_NAME, lastVideoHeightKey.c_str()));
     if (lastVideoWidth == 0 || lastVideoHeight == 0) {
         return {};
     } else {
@@ -164,11 +394,11 @@ void Settings::setLastVideoSize(
     std::string lastVideoWidthKey = getLastVideoWidthKey(rewardId, playlistIndex);
     std::string lastVideoHeightKey = getLastVideoHeightKey(rewardId, playlistIndex);
     if (lastVideoSize.has_value()) {
-        config_set_uint(config, PLUGIN_NAME, lastVideoWidthKey.c_str(), lastVideoSize.value().first);
-        config_set_uint(config, PLUGIN_NAME, lastVideoHeightKey.c_str(), lastVideoSize.value().second);
+        obsApi.setConfigUint(PLUGIN_NAME, lastVideoWidthKey.c_str(), lastVideoSize.value().first);
+        obsApi.setConfigUint(PLUGIN_NAME, lastVideoHeightKey.c_str(), lastVideoSize.value().second);
     } else {
-        config_remove_value(config, PLUGIN_NAME, lastVideoWidthKey.c_str());
-        config_remove_value(config, PLUGIN_NAME, lastVideoHeightKey.c_str());
+        obsApi.removeConfigValue(PLUGIN_NAME, lastVideoWidthKey.c_str());
+        obsApi.removeConfigValue(PLUGIN_NAME, lastVideoHeightKey.c_str());
     }
 }
 
@@ -178,40 +408,43 @@ static std::string getLastObsSourceKey(const std::string& rewardId);
 
 void Settings::deleteReward(const std::string& rewardId) {
     std::lock_guard lock(configMutex);
-    config_remove_value(config, PLUGIN_NAME, rewardId.c_str());
-    config_remove_value(config, PLUGIN_NAME, getRandomPositionEnabledKey(rewardId).c_str());
-    config_remove_value(config, PLUGIN_NAME, getLastObsSourceKey(rewardId).c_str());
+    obsApi.removeConfigValue(PLUGIN_NAME, rewardId.c_str());
+    obsApi.removeConfigValue(PLUGIN_NAME, getRandomPositionEnabledKey(rewardId).c_str());
+    obsApi.removeConfigValue(PLUGIN_NAME, getLastObsSourceKey(rewardId).c_str());
+    obsApi.removeConfigValue(PLUGIN_NAME, getMediaDirectoryKey(rewardId).c_str());
+    obsApi.removeConfigValue(PLUGIN_NAME, getMaxPlayTimeUnderLoadKey(rewardId).c_str());
 
     setLastPlaylistSize(rewardId, 0);  // Removes the (width, height) pairs internally
-    config_remove_value(config, PLUGIN_NAME, getLastPlaylistSizeKey(rewardId).c_str());
+    obsApi.removeConfigValue(PLUGIN_NAME, getLastPlaylistSizeKey(rewardId).c_str());
 }
 
 std::string Settings::getLastObsSourceName(const std::string& rewardId) const {
     std::lock_guard lock(configMutex);
     std::string lastObsSourceKey = getLastObsSourceKey(rewardId);
-    config_set_default_string(config, PLUGIN_NAME, lastObsSourceKey.c_str(), "");
-    return config_get_string(config, PLUGIN_NAME, lastObsSourceKey.c_str());
+    return obsApi.getConfigString(PLUGIN_NAME, lastObsSourceKey.c_str());
 }
 
 void Settings::setLastObsSourceName(const std::string& rewardId, const std::string& obsSourceName) {
     std::lock_guard lock(configMutex);
-    config_set_string(config, PLUGIN_NAME, getLastObsSourceKey(rewardId).c_str(), obsSourceName.c_str());
+    obsApi.setConfigString(PLUGIN_NAME, getLastObsSourceKey(rewardId).c_str(), obsSourceName.c_str());
 }
 
 std::size_t Settings::getLastPlaylistSize(const std::string& rewardId) const {
     std::string lastPlaylistSizeKey = getLastPlaylistSizeKey(rewardId);
-    config_set_default_uint(config, PLUGIN_NAME, lastPlaylistSizeKey.c_str(), 1);
-    return config_get_uint(config, PLUGIN_NAME, lastPlaylistSizeKey.c_str());
+    if (!obsApi.hasConfigUserValue(PLUGIN_NAME, lastPlaylistSizeKey.c_str())) {
+        return 1;
+    }
+    return obsApi.getConfigUint(PLUGIN_NAME, lastPlaylistSizeKey.c_str());
 }
 
 void Settings::setLastPlaylistSize(const std::string& rewardId, std::size_t lastPlaylistSize) {
     std::size_t oldPlaylistSize = getLastPlaylistSize(rewardId);
     for (std::size_t i = lastPlaylistSize; i < oldPlaylistSize; i++) {
-        config_remove_value(config, PLUGIN_NAME, getLastVideoWidthKey(rewardId, i).c_str());
-        config_remove_value(config, PLUGIN_NAME, getLastVideoHeightKey(rewardId, i).c_str());
+        obsApi.removeConfigValue(PLUGIN_NAME, getLastVideoWidthKey(rewardId, i).c_str());
+        obsApi.removeConfigValue(PLUGIN_NAME, getLastVideoHeightKey(rewardId, i).c_str());
     }
 
-    config_set_uint(config, PLUGIN_NAME, getLastPlaylistSizeKey(rewardId).c_str(), lastPlaylistSize);
+    obsApi.setConfigUint(PLUGIN_NAME, getLastPlaylistSizeKey(rewardId).c_str(), lastPlaylistSize);
 }
 
 std::string getRandomPositionEnabledKey(const std::string& rewardId) {
@@ -226,6 +459,14 @@ std::string getLoopVideoDurationKey(const std::string& rewardId) {
     return rewardId + LOOP_VIDEO_DURATION_KEY;
 }
 
+std::string getMediaDirectoryKey(const std::string& rewardId) {
+    return rewardId + MEDIA_DIRECTORY_KEY;
+}
+
+std::string getMaxPlayTimeUnderLoadKey(const std::string& rewardId) {
+    return rewardId + MAX_PLAY_TIME_UNDER_LOAD_KEY;
+}
+
 std::string getLastVideoWidthKey(const std::string& rewardId, std::size_t playlistIndex) {
     std::string lastVideoWidthKey = rewardId + LAST_VIDEO_WIDTH_KEY;
     if (playlistIndex > 0) {
@@ -249,3 +490,22 @@ std::string getLastPlaylistSizeKey(const std::string& rewardId) {
 std::string getLastObsSourceKey(const std::string& rewardId) {
     return rewardId + LAST_OBS_SOURCE_NAME_KEY;
 }
+
+std::optional<std::string> Settings::getOptionalString(const char* key) const {
+    std::lock_guard lock(configMutex);
+    std::string result = obsApi.getConfigString(PLUGIN_NAME, key);
+    if (result.empty()) {
+        return {};
+    } else {
+        return result;
+    }
+}
+
+void Settings::setOptionalString(const char* key, const std::optional<std::string>& value) {
+    std::lock_guard lock(configMutex);
+    if (value) {
+        obsApi.setConfigString(PLUGIN_NAME, key, value.value().c_str());
+    } else {
+        obsApi.removeConfigValue(PLUGIN_NAME, key);
+    }
+}
@@ -3,23 +3,29 @@
 
 #pragma once
 
-#include <util/config-file.h>
-
 #include <cstdint>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
+
+#include "ObsApi.h"
 
 struct SourcePlaybackSettings {
     bool randomPositionEnabled;
     bool loopVideoEnabled;
     double loopVideoDurationSeconds;
+    /// If set, every redemption plays a random video from this directory through the Media Source.
+    std::optional<std::string> mediaDirectory;
+    /// If set, the reward is stopped after this time while the queue is longer than
+    /// Settings::getAdaptiveDrainThreshold().
+    std::optional<double> maxPlayTimeUnderLoadSeconds;
 };
 
 class Settings {
 public:
-    Settings(config_t* config);
+    Settings(ObsApi& obsApi);
 
     /// Whether to play a reward immediately (possibly simultaneously with other rewards) or put it in a queue.
     bool isRewardRedemptionQueueEnabled() const;
@@ -29,9 +35,84 @@ public:
     double getIntervalBetweenRewardsSeconds() const;
     void setIntervalBetweenRewardsSeconds(double intervalBetweenRewardsSeconds);
 
+    /// Whether the next reward in the queue starts while the previous one is still being hidden, if they are played
+    /// by different sources. The interval between rewards is then counted from the start of the hide transition.
+    bool isPipelinedPlaybackEnabled() const;
+    void setPipelinedPlaybackEnabled(bool pipelinedPlaybackEnabled);
+
+    /// Queue length above which the rewards are played faster, so that the queue drains sooner. The longer the queue,
+    /// the faster they are played, up to the limits below at twice the threshold. 0 disables this, which is the
+    /// default.
+    unsigned getAdaptiveDrainThreshold() const;
+    void setAdaptiveDrainThreshold(unsigned adaptiveDrainThreshold);
+
+    /// The interval between rewards shrinks down to this value under load.
+    double getAdaptiveDrainMinIntervalSeconds() const;
+    void setAdaptiveDrainMinIntervalSeconds(double adaptiveDrainMinIntervalSeconds);
+
+    /// The own speed of the mapped Media Sources is multiplied by up to this percentage under load, in steps of 25%,
+    /// but the speed doesn't go above 200%. 100 (the default) keeps the speed as is.
+    unsigned getAdaptiveDrainMaxSpeedPercent() const;
+    void setAdaptiveDrainMaxSpeedPercent(unsigned adaptiveDrainMaxSpeedPercent);
+
+    /// Consecutive redemptions of the same reward are played once if they are received within this time of the first
+    /// one. 0 disables this, which is the default.
+    double getRedemptionCoalescingWindowSeconds() const;
+    void setRedemptionCoalescingWindowSeconds(double redemptionCoalescingWindowSeconds);
+
+    /// Text source that shows how many redemptions are played at once, e.g. "×5".
+    std::optional<std::string> getRedemptionCountTextSourceName() const;
+    void setRedemptionCountTextSourceName(const std::optional<std::string>& redemptionCountTextSourceName);
+
+    /// Queue length above which the rewards are paused on Twitch, so that viewers can't redeem them until the queue is
+    /// at most getBackpressureLowWaterMark() long. 0 disables this, which is the default.
+    unsigned getBackpressureHighWaterMark() const;
+    void setBackpressureHighWaterMark(unsigned backpressureHighWaterMark);
+
+    unsigned getBackpressureLowWaterMark() const;
+    void setBackpressureLowWaterMark(unsigned backpressureLowWaterMark);
+
+    /// Same as getBackpressureHighWaterMark(), but for the projected time until the queue is played.
+    unsigned getBackpressureHighWaterMarkSeconds() const;
+    void setBackpressureHighWaterMarkSeconds(unsigned backpressureHighWaterMarkSeconds);
+
+    unsigned getBackpressureLowWaterMarkSeconds() const;
+    void setBackpressureLowWaterMarkSeconds(unsigned backpressureLowWaterMarkSeconds);
+
+    /// The rewards that RewardsTheater has paused on Twitch, so that exactly these are resumed, even if OBS was closed
+    /// before that.
+    std::vector<std::string> getRewardIdsPausedOnTwitch() const;
+    void setRewardIdsPausedOnTwitch(const std::vector<std::string>& rewardIdsPausedOnTwitch);
+
+    /// Number of threads that run network requests and EventSub. 0 means choose automatically. The reward queue,
+    /// the media prober and the media index have a thread each on top of these. Takes effect after OBS is restarted.
+    unsigned getIoThreadCount() const;
+    void setIoThreadCount(unsigned ioThreadCount);
+
+    /// How often to write the IO thread pool metrics to the OBS log. 0 disables the metrics, which is the default.
+    /// Takes effect after OBS is restarted.
+    unsigned getExecutorMetricsLogIntervalSeconds() const;
+    void setExecutorMetricsLogIntervalSeconds(unsigned executorMetricsLogIntervalSeconds);
+
+    /// OBS log level (LOG_DEBUG, LOG_INFO, ...) at which the IO thread pool metrics are written.
+    int getExecutorMetricsLogLevel() const;
+    void setExecutorMetricsLogLevel(int executorMetricsLogLevel);
+
+    /// How many instances of one OBS source (the source itself and its private duplicates) may play at once.
+    /// 1 disables the duplicates, so a redemption restarts the source if it's already playing.
+    unsigned getMaxSourceInstances() const;
+    void setMaxSourceInstances(unsigned maxSourceInstances);
+
     std::optional<std::string> getTwitchAccessToken() const;
     void setTwitchAccessToken(const std::optional<std::string>& accessToken);
 
+    /// The user ID and the username of the last validated access token. They're used at startup before the token is
+    /// validated again.
+    std::optional<std::string> getTwitchUserId() const;
+    void setTwitchUserId(const std::optional<std::string>& userId);
+    std::optional<std::string> getTwitchUsername() const;
+    void setTwitchUsername(const std::optional<std::string>& username);
+
     std::optional<std::string> getObsSourceName(const std::string& rewardId) const;
     void setObsSourceName(const std::string& rewardId, const std::optional<std::string>& obsSourceName);
 
@@ -44,6 +125,15 @@ public:
     double getLoopVideoDurationSeconds(const std::string& rewardId) const;
     void setLoopVideoDurationSeconds(const std::string& rewardId, double loopVideoDuration);
 
+    std::optional<std::string> getMediaDirectory(const std::string& rewardId) const;
+    void setMediaDirectory(const std::string& rewardId, const std::optional<std::string>& mediaDirectory);
+
+    std::optional<double> getMaxPlayTimeUnderLoadSeconds(const std::string& rewardId) const;
+    void setMaxPlayTimeUnderLoadSeconds(
+        const std::string& rewardId,
+        const std::optional<double>& maxPlayTimeUnderLoadSeconds
+    );
+
     SourcePlaybackSettings getSourcePlaybackSettings(const std::string& rewardId) const;
     void setSourcePlaybackSettings(const std::string& rewardId, const SourcePlaybackSettings& sourcePlaybackSettings);
 
@@ -64,14 +154,16 @@ public:
     void deleteReward(const std::string& rewardId);
 
 private:
+    std::optional<std::string> getOptionalString(const char* key) const;
+    void setOptionalString(const char* key, const std::optional<std::string>& value);
+
     std::string getLastObsSourceName(const std::string& rewardId) const;
     void setLastObsSourceName(const std::string& rewardId, const std::string& lastObsSource);
 
     std::size_t getLastPlaylistSize(const std::string& rewardId) const;
     void setLastPlaylistSize(const std::string& rewardId, std::size_t lastPlaylistSize);
 
-    config_t* config;
-    // config_get_string returns a char* which we copy to a std::string.
-    // But that char* can be freed - therefore we need a mutex for string get/set operations.
+    ObsApi& obsApi;
+    // Keeps the values that are read and written together, like the sizes of the videos of a playlist, consistent.
     mutable std::recursive_mutex configMutex;
 };
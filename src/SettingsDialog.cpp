@@ -22,12 +22,27 @@
 SettingsDialog::SettingsDialog(RewardsTheaterPlugin& plugin, QWidget* parent)
     : OnTopDialog(parent), plugin(plugin), ui(std::make_unique<Ui::SettingsDialog>()),
       twitchAuthDialog(new TwitchAuthDialog(this, plugin.getTwitchAuth())),
-      rewardRedemptionQueueDialog(new RewardRedemptionQueueDialog(plugin.getRewardRedemptionQueue(), this)),
+      rewardRedemptionQueueDialog(nullptr),
       errorMessageBox(new ErrorMessageBox(this)) {
     ui->setupUi(this);
     showGithubLink();
     ui->rewardRedemptionQueueEnabledCheckBox->setChecked(plugin.getSettings().isRewardRedemptionQueueEnabled());
     ui->intervalBetweenRewardsSpinBox->setValue(plugin.getSettings().getIntervalBetweenRewardsSeconds());
+    ui->pipelinedPlaybackEnabledCheckBox->setChecked(plugin.getSettings().isPipelinedPlaybackEnabled());
+    ui->adaptiveDrainThresholdSpinBox->setValue(static_cast<int>(plugin.getSettings().getAdaptiveDrainThreshold()));
+    ui->adaptiveDrainMinIntervalSpinBox->setValue(plugin.getSettings().getAdaptiveDrainMinIntervalSeconds());
+    ui->adaptiveDrainMaxSpeedSpinBox->setValue(
+        static_cast<int>(plugin.getSettings().getAdaptiveDrainMaxSpeedPercent())
+    );
+    ui->redemptionCoalescingWindowSpinBox->setValue(plugin.getSettings().getRedemptionCoalescingWindowSeconds());
+    ui->redemptionCountTextSourceEdit->setText(
+        QString::fromStdString(plugin.getSettings().getRedemptionCountTextSourceName().value_or(""))
+    );
+    ui->backpressureHighWaterMarkSpinBox->setValue(
+        static_cast<int>(plugin.getSettings().getBackpressureHighWaterMark())
+    );
+    updateBackpressureLowWaterMarkMaximum();
+    ui->backpressureLowWaterMarkSpinBox->setValue(static_cast<int>(plugin.getSettings().getBackpressureLowWaterMark()));
 
     connect(ui->authButton, &QPushButton::clicked, this, &SettingsDialog::logInOrLogOut);
     connect(
@@ -52,6 +67,54 @@ SettingsDialog::SettingsDialog(RewardsTheaterPlugin& plugin, QWidget* parent)
         this,
         &SettingsDialog::saveIntervalBetweenRewards
     );
+    connect(
+        ui->pipelinedPlaybackEnabledCheckBox,
+        &QCheckBox::checkStateChangedCompat,
+        this,
+        &SettingsDialog::savePipelinedPlaybackEnabled
+    );
+    connect(
+        ui->adaptiveDrainThresholdSpinBox,
+        &QSpinBox::valueChanged,
+        this,
+        &SettingsDialog::saveAdaptiveDrainThreshold
+    );
+    connect(
+        ui->adaptiveDrainMinIntervalSpinBox,
+        &QDoubleSpinBox::valueChanged,
+        this,
+        &SettingsDialog::saveAdaptiveDrainMinInterval
+    );
+    connect(
+        ui->adaptiveDrainMaxSpeedSpinBox,
+        &QSpinBox::valueChanged,
+        this,
+        &SettingsDialog::saveAdaptiveDrainMaxSpeed
+    );
+    connect(
+        ui->redemptionCoalescingWindowSpinBox,
+        &QDoubleSpinBox::valueChanged,
+        this,
+        &SettingsDialog::saveRedemptionCoalescingWindow
+    );
+    connect(
+        ui->redemptionCountTextSourceEdit,
+        &QLineEdit::editingFinished,
+        this,
+        &SettingsDialog::saveRedemptionCountTextSourceName
+    );
+    connect(
+        ui->backpressureHighWaterMarkSpinBox,
+        &QSpinBox::valueChanged,
+        this,
+        &SettingsDialog::saveBackpressureHighWaterMark
+    );
+    connect(
+        ui->backpressureLowWaterMarkSpinBox,
+        &QSpinBox::valueChanged,
+        this,
+        &SettingsDialog::saveBackpressureLowWaterMark
+    );
     connect(
         ui->openRewardRedemptionQueueButton, &QPushButton::clicked, this, &SettingsDialog::openRewardRedemptionQueue
     );
@@ -69,10 +132,21 @@ SettingsDialog::SettingsDialog(RewardsTheaterPlugin& plugin, QWidget* parent)
         this,
         &SettingsDialog::showUpdateAvailableLink
     );
+
+    // The dialog is created on first use, so catch up with what happened before that.
+    updateAuthButtonText(plugin.getTwitchAuth().getUsername());
+    if (plugin.getGithubUpdateApi().isUpdateFound()) {
+        showUpdateAvailableLink();
+    }
+    plugin.getTwitchRewardsApi().reloadRewards();
 }
 
 SettingsDialog::~SettingsDialog() = default;
 
+TwitchAuthDialog* SettingsDialog::getTwitchAuthDialog() {
+    return twitchAuthDialog;
+}
+
 void SettingsDialog::logInOrLogOut() {
     TwitchAuth& auth = plugin.getTwitchAuth();
     if (auth.isAuthenticated()) {
@@ -156,7 +230,54 @@ void SettingsDialog::saveIntervalBetweenRewards(double interval) {
     plugin.getSettings().setIntervalBetweenRewardsSeconds(interval);
 }
 
+void SettingsDialog::savePipelinedPlaybackEnabled(int checkState) {
+    plugin.getSettings().setPipelinedPlaybackEnabled(checkState == Qt::Checked);
+}
+
+void SettingsDialog::saveAdaptiveDrainThreshold(int threshold) {
+    plugin.getSettings().setAdaptiveDrainThreshold(static_cast<unsigned>(threshold));
+}
+
+void SettingsDialog::saveAdaptiveDrainMinInterval(double minInterval) {
+    plugin.getSettings().setAdaptiveDrainMinIntervalSeconds(minInterval);
+}
+
+void SettingsDialog::saveAdaptiveDrainMaxSpeed(int maxSpeedPercent) {
+    plugin.getSettings().setAdaptiveDrainMaxSpeedPercent(static_cast<unsigned>(maxSpeedPercent));
+}
+
+void SettingsDialog::saveRedemptionCoalescingWindow(double window) {
+    plugin.getSettings().setRedemptionCoalescingWindowSeconds(window);
+}
+
+void SettingsDialog::saveRedemptionCountTextSourceName() {
+    QString textSourceName = ui->redemptionCountTextSourceEdit->text().trimmed();
+    if (textSourceName.isEmpty()) {
+        plugin.getSettings().setRedemptionCountTextSourceName({});
+    } else {
+        plugin.getSettings().setRedemptionCountTextSourceName(textSourceName.toStdString());
+    }
+}
+
+void SettingsDialog::saveBackpressureHighWaterMark(int highWaterMark) {
+    plugin.getSettings().setBackpressureHighWaterMark(static_cast<unsigned>(highWaterMark));
+    updateBackpressureLowWaterMarkMaximum();
+}
+
+void SettingsDialog::saveBackpressureLowWaterMark(int lowWaterMark) {
+    plugin.getSettings().setBackpressureLowWaterMark(static_cast<unsigned>(lowWaterMark));
+}
+
+void SettingsDialog::updateBackpressureLowWaterMarkMaximum() {
+    // The low water mark can't be above the high one. Lowering the maximum lowers the value as well, which saves it.
+    int highWaterMark = ui->backpressureHighWaterMarkSpinBox->value();
+    ui->backpressureLowWaterMarkSpinBox->setMaximum(highWaterMark == 0 ? 999 : highWaterMark);
+}
+
 void SettingsDialog::openRewardRedemptionQueue() {
+    if (!rewardRedemptionQueueDialog) {
+        rewardRedemptionQueueDialog = new RewardRedemptionQueueDialog(plugin.getRewardRedemptionQueue(), this);
+    }
     rewardRedemptionQueueDialog->showAndActivate();
 }
 
@@ -24,6 +24,7 @@ class SettingsDialog : public OnTopDialog {
 public:
     SettingsDialog(RewardsTheaterPlugin& plugin, QWidget* parent);
     ~SettingsDialog() override;
+    TwitchAuthDialog* getTwitchAuthDialog();
 
 private slots:
     void logInOrLogOut();
@@ -36,6 +37,14 @@ private slots:
     void setRewardPlaybackPaused(int checkState);
     void saveRewardRedemptionQueueEnabled(int checkState);
     void saveIntervalBetweenRewards(double interval);
+    void savePipelinedPlaybackEnabled(int checkState);
+    void saveAdaptiveDrainThreshold(int threshold);
+    void saveAdaptiveDrainMinInterval(double minInterval);
+    void saveAdaptiveDrainMaxSpeed(int maxSpeedPercent);
+    void saveRedemptionCoalescingWindow(double window);
+    void saveRedemptionCountTextSourceName();
+    void saveBackpressureHighWaterMark(int highWaterMark);
+    void saveBackpressureLowWaterMark(int lowWaterMark);
     void openRewardRedemptionQueue();
 
 private:
@@ -44,6 +53,7 @@ private:
     void showRewardWidgets();
     void showRewardLoadException(std::exception_ptr exception);
     void showGithubLink();
+    void updateBackpressureLowWaterMarkMaximum();
     void showRewardsTheaterLink(
         const std::string& linkText,
         const std::string& url,
@@ -53,6 +63,7 @@ private:
     RewardsTheaterPlugin& plugin;
     std::unique_ptr<Ui::SettingsDialog> ui;
     TwitchAuthDialog* twitchAuthDialog;
+    // Created the first time the queue is opened.
     RewardRedemptionQueueDialog* rewardRedemptionQueueDialog;
     ErrorMessageBox* errorMessageBox;
 
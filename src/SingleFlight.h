@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BoostAsio.h"
+#include "ConditionVariable.h"
+
+/// Lets concurrent identical operations share one execution: the first caller with a key runs the operation, and the
+/// callers that come while it's running wait for its result instead of running their own. All the callers get the
+/// same result object rather than copies of it. Thread-safe, but the callers must run on strands.
+template <typename T>
+class SingleFlight {
+public:
+    /// `makeOperation` returns a boost::asio::awaitable<T>. It's only called if no operation with the key is running.
+    template <typename MakeOperation>
+    boost::asio::awaitable<std::shared_ptr<const T>> run(const std::string& key, MakeOperation makeOperation) {
+        auto timer = std::make_shared<boost::asio::steady_timer>(co_await boost::asio::this_coro::executor);
+        timer->expires_after(POS_INFINITY);
+        std::shared_ptr<Flight> flight;
+        bool isLeader = false;
+        {
+            std::lock_guard guard(mutex);
+            std::shared_ptr<Flight>& existingFlight = flights[key];
+            if (!existingFlight) {
+                existingFlight = std::make_shared<Flight>();
+                isLeader = true;
+            } else {
+                // The leader wakes the timer through this strand, so it can't happen before async_wait below.
+                existingFlight->waiters.push_back(timer);
+            }
+            flight = existingFlight;
+        }
+
+        if (isLeader) {
+            co_return co_await runAsLeader(key, flight, makeOperation());
+        }
+
+        while (true) {
+            boost::system::error_code errorCode;
+            co_await timer->async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, errorCode));
+            boost::asio::cancellation_state cancellationState = co_await boost::asio::this_coro::cancellation_state;
+            std::lock_guard guard(mutex);
+            if (flight->isDone) {
+                if (flight->exception) {
+                    std::rethrow_exception(flight->exception);
+                }
+                co_return flight->result;
+            }
+            if (cancellationState.cancelled() != boost::asio::cancellation_type::none) {
+                throw boost::system::system_error(boost::asio::error::operation_aborted);
+            }
+        }
+    }
+
+    /// The callers that come after this call run new operations instead of waiting for the running ones with the keys
+    /// that start with `keyPrefix`, e.g. because their results may be outdated. The callers that are already waiting
+    /// still get the results of the running operations.
+    void forget(const std::string& keyPrefix) {
+        std::lock_guard guard(mutex);
+        auto flight = flights.lower_bound(keyPrefix);
+        while (flight != flights.end() && flight->first.starts_with(keyPrefix)) {
+            flight = flights.erase(flight);
+        }
+    }
+
+private:
+    struct Flight {
+        std::vector<std::shared_ptr<boost::asio::steady_timer>> waiters;
+        bool isDone = false;
+        std::shared_ptr<const T> result;
+        std::exception_ptr exception;
+    };
+
+    boost::asio::awaitable<std::shared_ptr<const T>> runAsLeader(
+        const std::string& key,
+        std::shared_ptr<Flight> flight,
+        boost::asio::awaitable<T> operation
+    ) {
+        std::shared_ptr<const T> result;
+        std::exception_ptr exception;
+        try {
+            result = std::make_shared<const T>(co_await std::move(operation));
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        {
+            std::lock_guard guard(mutex);
+            // The flight may have been forgotten, and the key may belong to a newer flight by now.
+            auto currentFlight = flights.find(key);
+            if (currentFlight != flights.end() && currentFlight->second == flight) {
+                flights.erase(currentFlight);
+            }
+            flight->isDone = true;
+            flight->result = result;
+            flight->exception = exception;
+            for (const std::shared_ptr<boost::asio::steady_timer>& waiter : flight->waiters) {
+                boost::asio::post(waiter->get_executor(), [waiter] {
+                    waiter->cancel();  // Equivalent to notify_all() for a condition variable.
+                });
+            }
+        }
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        co_return result;
+    }
+
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<Flight>> flights;
+};
@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "SourcePool.h"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "Log.h"
+
+// Set by RewardRedemptionQueue before every play, so they differ between the instances on purpose.
+static constexpr std::array MANAGED_SETTINGS = {
+    "loop",
+    "shuffle",
+    "playback_behavior",
+    "looping",
+    "clear_on_media_end",
+    "restart_on_activate",
+    "speed_percent",
+    "is_local_file",
+    "local_file",
+};
+
+SourcePool::SourcePool(ObsApi& obsApi, Settings& settings) : obsApi(obsApi), settings(settings) {}
+
+SourcePool::~SourcePool() {
+    for (auto& [uuid, instances] : instancesBySourceUuid) {
+        for (const std::shared_ptr<Instance>& duplicate : instances.duplicates) {
+            // Leased duplicates remove their scene items when the lease ends.
+            if (duplicate->leaseCount == 0) {
+                removeSceneItems(obsApi, *duplicate);
+            }
+        }
+    }
+}
+
+SourcePool::Lease::Lease(ObsApi& obsApi, std::shared_ptr<Instance> instance, obs_source_t* source)
+    : obsApi(obsApi), instance(std::move(instance)), source(source) {}
+
+SourcePool::Lease::~Lease() {
+    instance->leaseCount--;
+    if (instance->leaseCount == 0 && instance->duplicate) {
+        removeSceneItems(obsApi, *instance);
+    }
+}
+
+obs_source_t* SourcePool::Lease::getSource() const {
+    return source;
+}
+
+SourcePool::Lease SourcePool::acquire(obs_source_t* source, bool loopVideoEnabled, bool duplicateOnly) {
+    SourceInstances& instances = instancesBySourceUuid[obsApi.getSourceUuid(source)];
+    if (!duplicateOnly && instances.original->leaseCount == 0 && isLoopEnabled(source) == loopVideoEnabled) {
+        return lease(instances.original, source);
+    }
+    for (const std::shared_ptr<Instance>& duplicate : instances.duplicates) {
+        if (duplicate->leaseCount == 0 && isLoopEnabled(duplicate->duplicate.get()) == loopVideoEnabled) {
+            return lease(duplicate, source);
+        }
+    }
+
+    if (instances.duplicates.size() + 1 < getMaxInstances(duplicateOnly)) {
+        std::shared_ptr<Instance> duplicate = createDuplicate(source, instances.duplicates.size());
+        if (duplicate) {
+            instances.duplicates.push_back(duplicate);
+            return lease(duplicate, source);
+        }
+    }
+
+    if (!duplicateOnly && instances.original->leaseCount == 0) {
+        return lease(instances.original, source);
+    }
+    for (const std::shared_ptr<Instance>& duplicate : instances.duplicates) {
+        if (duplicate->leaseCount == 0) {
+            return lease(duplicate, source);
+        }
+    }
+    if (duplicateOnly && !instances.duplicates.empty()) {
+        return lease(instances.duplicates.front(), source);
+    }
+    return lease(instances.original, source);
+}
+
+void SourcePool::prewarm(obs_source_t* source, bool loopVideoEnabled, bool duplicateOnly) {
+    SourceInstances& instances = instancesBySourceUuid[obsApi.getSourceUuid(source)];
+    if (!duplicateOnly && isLoopEnabled(source) == loopVideoEnabled) {
+        return;
+    }
+    for (const std::shared_ptr<Instance>& duplicate : instances.duplicates) {
+        if (isLoopEnabled(duplicate->duplicate.get()) == loopVideoEnabled) {
+            return;
+        }
+    }
+    if (instances.duplicates.size() + 1 >= getMaxInstances(duplicateOnly)) {
+        return;
+    }
+    std::shared_ptr<Instance> duplicate = createDuplicate(source, instances.duplicates.size());
+    if (!duplicate) {
+        return;
+    }
+    obsApi.updateSourceSettings(duplicate->duplicate.get(), {{getLoopSettingName(source), loopVideoEnabled}});
+    instances.duplicates.push_back(std::move(duplicate));
+}
+
+bool SourcePool::hasFreeInstance(obs_source_t* source, bool duplicateOnly) {
+    auto it = instancesBySourceUuid.find(obsApi.getSourceUuid(source));
+    if (it == instancesBySourceUuid.end()) {
+        return true;
+    }
+    const SourceInstances& instances = it->second;
+    if (!duplicateOnly && instances.original->leaseCount == 0) {
+        return true;
+    }
+    if (instances.duplicates.size() + 1 < getMaxInstances(duplicateOnly)) {
+        return true;
+    }
+    return std::ranges::any_of(instances.duplicates, [](const std::shared_ptr<Instance>& duplicate) {
+        return duplicate->leaseCount == 0;
+    });
+}
+
+SourcePool::Lease SourcePool::lease(const std::shared_ptr<Instance>& instance, obs_source_t* originalSource) {
+    if (!instance->duplicate) {
+        instance->leaseCount++;
+        return Lease(obsApi, instance, originalSource);
+    }
+    if (instance->leaseCount == 0) {
+        copySettings(originalSource, *instance);
+        addSceneItems(originalSource, *instance);
+    }
+    instance->leaseCount++;
+    return Lease(obsApi, instance, instance->duplicate.get());
+}
+
+std::shared_ptr<SourcePool::Instance> SourcePool::createDuplicate(obs_source_t* source, std::size_t index) {
+    std::string sourceName = obsApi.getSourceName(source);
+    std::string name = fmt::format("{} (RewardsTheater {})", sourceName, index + 2);
+    ObsSourceRef duplicate = obsApi.duplicateSource(source, name);
+    if (!duplicate || duplicate.get() == source) {
+        log(LOG_ERROR, "Could not duplicate source {}", sourceName);
+        return nullptr;
+    }
+    log(LOG_INFO, "Created instance {} of source {}", index + 2, sourceName);
+    auto instance = std::make_shared<Instance>();
+    instance->duplicate = std::move(duplicate);
+    instance->copiedSettings = getUnmanagedSettings(source);
+    return instance;
+}
+
+void SourcePool::copySettings(obs_source_t* source, Instance& instance) {
+    // The user may have changed the file or other settings of the original source since the duplicate was created.
+    boost::json::object unmanagedSettings = getUnmanagedSettings(source);
+    if (unmanagedSettings == instance.copiedSettings) {
+        return;
+    }
+    obsApi.updateSourceSettings(instance.duplicate.get(), unmanagedSettings);
+    instance.copiedSettings = std::move(unmanagedSettings);
+}
+
+boost::json::object SourcePool::getUnmanagedSettings(obs_source_t* source) {
+    boost::json::object unmanagedSettings = obsApi.getSourceSettings(source);
+    for (const char* name : MANAGED_SETTINGS) {
+        unmanagedSettings.erase(name);
+    }
+    return unmanagedSettings;
+}
+
+void SourcePool::addSceneItems(obs_source_t* source, Instance& instance) {
+    for (const ObsApi::SceneItem& originalItem : obsApi.findSceneItems(source)) {
+        ObsSceneItemRef item = obsApi.addSceneItemCopy(originalItem.sceneItem.get(), instance.duplicate.get());
+        if (item) {
+            instance.sceneItems.push_back(std::move(item));
+        }
+    }
+}
+
+void SourcePool::removeSceneItems(ObsApi& obsApi, Instance& instance) {
+    for (const ObsSceneItemRef& item : instance.sceneItems) {
+        obsApi.removeSceneItem(item.get());
+    }
+    instance.sceneItems.clear();
+}
+
+bool SourcePool::isLoopEnabled(obs_source_t* source) {
+    boost::json::object sourceSettings = obsApi.getSourceSettings(source);
+    const boost::json::value* loop = sourceSettings.if_contains(getLoopSettingName(source));
+    return loop && loop->is_bool() && loop->get_bool();
+}
+
+const char* SourcePool::getLoopSettingName(obs_source_t* source) {
+    return obsApi.getSourceId(source) == "vlc_source" ? "loop" : "looping";
+}
+
+std::size_t SourcePool::getMaxInstances(bool duplicateOnly) {
+    return std::max(duplicateOnly ? 2u : 1u, settings.getMaxSourceInstances());
+}
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <boost/json.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ObsApi.h"
+#include "Settings.h"
+
+/// Keeps private duplicates of OBS sources, so that one source can play for several redemptions at once, and so that
+/// redemptions with different loop settings don't reconfigure a source (which restarts its decoder) every time.
+///
+/// A duplicate keeps its decoder between plays, but is only added to the scenes of the original source while it's
+/// played. Must only be used from one strand.
+class SourcePool {
+    struct Instance;
+
+public:
+    SourcePool(ObsApi& obsApi, Settings& settings);
+    ~SourcePool();
+
+    /// Marks the instance as playing until destructed. Doesn't need the pool to be alive, only the ObsApi.
+    class Lease {
+    public:
+        Lease(ObsApi& obsApi, std::shared_ptr<Instance> instance, obs_source_t* source);
+        ~Lease();
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        obs_source_t* getSource() const;
+
+    private:
+        ObsApi& obsApi;
+        std::shared_ptr<Instance> instance;
+        obs_source_t* source;
+    };
+
+    /// Prefers a free instance whose loop setting already matches `loopVideoEnabled`, then a new duplicate, then any
+    /// free instance. If Settings::getMaxSourceInstances() instances are playing already, returns `source` itself, so
+    /// it's restarted. The caller must hold a reference to `source` while the lease exists.
+    ///
+    /// With `duplicateOnly`, the original is never leased, so that the caller may change the settings that the user
+    /// chose, like the file. One duplicate is allowed then even if the limit is 1, and a playing duplicate is restarted
+    /// when the pool is full. Returns `source` only if it couldn't be duplicated.
+    Lease acquire(obs_source_t* source, bool loopVideoEnabled, bool duplicateOnly = false);
+
+    /// Creates a duplicate with the loop setting `loopVideoEnabled` ahead of the first play, unless an instance that
+    /// acquire() would pick for it exists already or the pool is full, so that the first play doesn't have to create
+    /// and configure one.
+    void prewarm(obs_source_t* source, bool loopVideoEnabled, bool duplicateOnly = false);
+
+    /// Returns true if acquire() won't restart an instance of `source` that is still playing.
+    bool hasFreeInstance(obs_source_t* source, bool duplicateOnly = false);
+
+private:
+    struct Instance {
+        /// Null for the original source, which the pool doesn't hold a reference to.
+        ObsSourceRef duplicate;
+        unsigned leaseCount = 0;
+        /// Settings of the original source (without the ones that RewardRedemptionQueue manages) that were last
+        /// copied to the duplicate.
+        boost::json::object copiedSettings;
+        std::vector<ObsSceneItemRef> sceneItems;
+    };
+
+    struct SourceInstances {
+        std::shared_ptr<Instance> original = std::make_shared<Instance>();
+        std::vector<std::shared_ptr<Instance>> duplicates;
+    };
+
+    Lease lease(const std::shared_ptr<Instance>& instance, obs_source_t* originalSource);
+    std::shared_ptr<Instance> createDuplicate(obs_source_t* source, std::size_t index);
+    void copySettings(obs_source_t* source, Instance& instance);
+    boost::json::object getUnmanagedSettings(obs_source_t* source);
+    void addSceneItems(obs_source_t* source, Instance& instance);
+    static void removeSceneItems(ObsApi& obsApi, Instance& instance);
+    bool isLoopEnabled(obs_source_t* source);
+    const char* getLoopSettingName(obs_source_t* source);
+    std::size_t getMaxInstances(bool duplicateOnly);
+
+    ObsApi& obsApi;
+    Settings& settings;
+    std::map<std::string, SourceInstances> instancesBySourceUuid;
+};
@@ -4,7 +4,6 @@
 #include "TwitchAuth.h"
 
 #include <fmt/core.h>
-#include <obs-module.h>
 
 #include <QDesktopServices>
 #include <QUrl>
@@ -27,21 +26,24 @@ static const auto TOKEN_VALIDATE_PERIOD = 30min;
 static const auto MINIMUM_TOKEN_TIME_LEFT = 48h;
 
 TwitchAuth::TwitchAuth(
+    ObsApi& obsApi,
     Settings& settings,
     const std::string& clientId,
     const std::set<std::string>& scopes,
     std::uint16_t authServerPort,
     HttpClient& httpClient,
-    asio::io_context& ioContext
+    const PrometheusExporter& prometheusExporter,
+    IoThreadPool::Strand executor
 )
-    : settings(settings), clientId(clientId), scopes(scopes), authServerPort(authServerPort), httpClient(httpClient),
-      ioContext(ioContext), randomEngine(std::random_device()()) {}
+    : obsApi(obsApi), settings(settings), clientId(clientId), scopes(scopes), authServerPort(authServerPort),
+      httpClient(httpClient), prometheusExporter(prometheusExporter), executor(executor),
+      randomEngine(std::random_device()()) {}
 
 TwitchAuth::~TwitchAuth() = default;
 
 void TwitchAuth::startService() {
-    asio::co_spawn(ioContext, asyncRunAuthServer(), asio::detached);
-    asio::co_spawn(ioContext, asyncValidateTokenPeriodically(), asio::detached);
+    asio::co_spawn(executor, asyncRunAuthServer(), asio::detached);
+    asio::co_spawn(executor, asyncValidateTokenPeriodically(), asio::detached);
     authenticateWithSavedToken();
 }
 
@@ -90,7 +92,13 @@ const std::string& TwitchAuth::getClientId() const {
 static void openUrl(const std::string& url);
 
 void TwitchAuth::authenticate() {
-    openUrl(getDoNotShowOnStreamPageUrl());
+    // The CSRF states are only accessed on the executor, like in the auth server.
+    asio::post(executor, [this]() {
+        std::string url = getDoNotShowOnStreamPageUrl();
+        QMetaObject::invokeMethod(this, [url]() {
+            openUrl(url);
+        });
+    });
 }
 
 void openUrl(const std::string& url) {
@@ -99,7 +107,7 @@ void openUrl(const std::string& url) {
 }
 
 void TwitchAuth::authenticateWithToken(const std::string& token) {
-    asio::co_spawn(ioContext, asyncAuthenticateWithToken(token), asio::detached);
+    asio::co_spawn(executor, asyncAuthenticateWithToken(token), asio::detached);
 }
 
 void TwitchAuth::logOut() {
@@ -110,6 +118,8 @@ void TwitchAuth::logOut() {
         username = {};
     }
     settings.setTwitchAccessToken({});
+    settings.setTwitchUserId({});
+    settings.setTwitchUsername({});
     emit onUserChanged();
     emit onUsernameChanged({});
 }
@@ -129,9 +139,26 @@ const char* TwitchAuth::EmptyAccessTokenException::what() const noexcept {
 
 void TwitchAuth::authenticateWithSavedToken() {
     std::optional<std::string> savedAccessToken = settings.getTwitchAccessToken();
-    if (savedAccessToken) {
-        authenticateWithToken(savedAccessToken.value());
+    if (!savedAccessToken) {
+        return;
+    }
+
+    std::optional<std::string> savedUserId = settings.getTwitchUserId();
+    std::optional<std::string> savedUsername = settings.getTwitchUsername();
+    if (savedUserId && savedUsername) {
+        // Connect to EventSub and load the rewards right away instead of waiting for the token validation.
+        // asyncAuthenticateWithToken rolls this back if the token turns out to be invalid.
+        log(LOG_INFO, "Using the saved Twitch user {} until the token is validated", savedUsername.value());
+        {
+            std::lock_guard guard(userMutex);
+            accessToken = savedAccessToken;
+            userId = savedUserId;
+            username = savedUsername;
+        }
+        emit onUserChanged();
+        emit onUsernameChanged(savedUsername);
     }
+    authenticateWithToken(savedAccessToken.value());
 }
 
 asio::awaitable<void> TwitchAuth::asyncAuthenticateWithToken(std::string token) {
@@ -149,20 +176,37 @@ asio::awaitable<void> TwitchAuth::asyncAuthenticateWithToken(std::string token)
         if (failureReason == nullptr) {
             logOut();
             failureReason = std::make_exception_ptr(UnauthenticatedException());
+        } else if (getAccessToken() == token) {
+            // The saved user is already in use. The token couldn't be checked, but it hasn't been rejected either, so
+            // keep the user. asyncValidateTokenPeriodically will check the token again.
+            co_return;
         }
         emit onAuthenticationFailure(failureReason);
         co_return;
     }
 
+    bool isSameUser;
+    bool hadUsername;
     {
         std::lock_guard guard(userMutex);
+        isSameUser = accessToken == token && userId == validateTokenResponse.userId;
+        hadUsername = username.has_value();
         accessToken = token;
         userId = validateTokenResponse.userId;
+        if (!isSameUser) {
+            username = {};
+        }
     }
     settings.setTwitchAccessToken(token);
+    settings.setTwitchUserId(validateTokenResponse.userId);
     emit onAuthenticationSuccess();
     emitAccessTokenAboutToExpireIfNeeded(validateTokenResponse.expiresIn);
-    emit onUserChanged();
+    if (!isSameUser) {
+        emit onUserChanged();
+        if (hadUsername) {
+            emit onUsernameChanged({});
+        }
+    }
     co_await asyncUpdateUsername();
 }
 
@@ -171,21 +215,21 @@ asio::awaitable<TwitchAuth::ValidateTokenResponse> TwitchAuth::asyncValidateToke
         throw EmptyAccessTokenException();
     }
 
-    HttpClient::Response validateTokenResponse =
+    std::shared_ptr<const HttpClient::Response> validateTokenResponse =
         co_await httpClient.request("id.twitch.tv", "/oauth2/validate", token, clientId);
 
-    if (validateTokenResponse.status == http::status::unauthorized) {
+    if (validateTokenResponse->status == http::status::unauthorized) {
         co_return TwitchAuth::ValidateTokenResponse{};
     }
 
     // Check that the token has the necessary scopes.
-    if (!tokenHasNeededScopes(validateTokenResponse.json)) {
+    if (!tokenHasNeededScopes(validateTokenResponse->json)) {
         log(LOG_ERROR, "Error: Token is missing necessary scopes.");
         co_return TwitchAuth::ValidateTokenResponse{};
     }
     co_return TwitchAuth::ValidateTokenResponse{
-        std::chrono::seconds{value_to<int>(validateTokenResponse.json.at("expires_in"))},
-        value_to<std::string>(validateTokenResponse.json.at("user_id")),
+        std::chrono::seconds{value_to<int>(validateTokenResponse->json.at("expires_in"))},
+        value_to<std::string>(validateTokenResponse->json.at("user_id")),
     };
 }
 
@@ -206,16 +250,20 @@ asio::awaitable<void> TwitchAuth::asyncUpdateUsername() {
         }
         username = newUsername;
     }
+    if (newUsername) {
+        settings.setTwitchUsername(newUsername);
+    }
     emit onUsernameChanged(newUsername);
 }
 
 asio::awaitable<std::optional<std::string>> TwitchAuth::asyncGetUsername() {
     try {
-        HttpClient::Response response = co_await httpClient.request("api.twitch.tv", "/helix/users", *this);
-        if (response.status != http::status::ok) {
+        std::shared_ptr<const HttpClient::Response> response =
+            co_await httpClient.request("api.twitch.tv", "/helix/users", *this);
+        if (response->status != http::status::ok) {
             co_return std::nullopt;
         }
-        co_return value_to<std::string>(response.json.at("data").at(0).at("display_name"));
+        co_return value_to<std::string>(response->json.at("data").at(0).at("display_name"));
     } catch (const std::exception& exception) {
         log(LOG_ERROR, "Exception in asyncGetUsername: {}", exception.what());
         co_return std::nullopt;
@@ -223,7 +271,7 @@ asio::awaitable<std::optional<std::string>> TwitchAuth::asyncGetUsername() {
 }
 
 asio::awaitable<void> TwitchAuth::asyncValidateTokenPeriodically() {
-    for (;; co_await asio::steady_timer(ioContext, TOKEN_VALIDATE_PERIOD).async_wait(asio::use_awaitable)) {
+    for (;; co_await asio::steady_timer(executor, TOKEN_VALIDATE_PERIOD).async_wait(asio::use_awaitable)) {
         try {
             std::optional<std::string> tokenOptional = getAccessToken();
             if (!tokenOptional) {
@@ -249,12 +297,12 @@ void TwitchAuth::emitAccessTokenAboutToExpireIfNeeded(std::chrono::seconds expir
 }
 
 asio::awaitable<void> TwitchAuth::asyncRunAuthServer() {
-    tcp::acceptor acceptor{ioContext, {tcp::v4(), authServerPort}};
+    tcp::acceptor acceptor{executor, {tcp::v4(), authServerPort}};
     while (true) {
         bool exceptionThrown = false;
         try {
             tcp::socket socket = co_await acceptor.async_accept(asio::use_awaitable);
-            asio::co_spawn(ioContext, asyncProcessRequest(std::move(socket)), asio::detached);
+            asio::co_spawn(executor, asyncProcessRequest(std::move(socket)), asio::detached);
         } catch (const std::exception& exception) {
             log(LOG_ERROR, "Error: {}", exception.what());
             exceptionThrown = true;
@@ -263,7 +311,7 @@ asio::awaitable<void> TwitchAuth::asyncRunAuthServer() {
         if (exceptionThrown) {
             // co_await isn't allowed in a catch clause.
             // Wait in order to avoid a busy while loop.
-            co_await asio::steady_timer(ioContext, 1s).async_wait(asio::use_awaitable);
+            co_await asio::steady_timer(executor, 1s).async_wait(asio::use_awaitable);
         }
     }
 }
@@ -306,7 +354,15 @@ http::response<http::string_body> TwitchAuth::getResponse(const http::request<ht
             response.result(http::status::bad_request);
             return response;
         }
-        asio::co_spawn(ioContext, asyncAuthenticateWithToken(responseAccessToken), asio::detached);
+        asio::co_spawn(executor, asyncAuthenticateWithToken(responseAccessToken), asio::detached);
+    } else if (path == "/metrics") {
+        response.set(http::field::content_type, "text/plain; version=0.0.4");
+        response.body() = prometheusExporter.getMetricsText();
+        response.prepare_payload();
+    } else if (path == "/healthz") {
+        response.set(http::field::content_type, "text/plain");
+        response.body() = "ok\n";
+        response.prepare_payload();
     } else {
         response.body() = "RewardsTheater auth server";
         response.prepare_payload();
@@ -359,10 +415,10 @@ std::string TwitchAuth::getDoNotShowOnStreamPageHtml(const std::string& csrfStat
     )";
     return fmt::format(
         doNotShowOnStreamTemplate,
-        obs_module_text("RewardsTheater"),
-        obs_module_text("DoNotShowOnStream"),
+        obsApi.getLocaleText("RewardsTheater"),
+        obsApi.getLocaleText("DoNotShowOnStream"),
         getAuthPageUrl(csrfState),
-        obs_module_text("AuthenticateWithTwitch")
+        obsApi.getLocaleText("AuthenticateWithTwitch")
     );
 }
 
@@ -442,19 +498,17 @@ std::string TwitchAuth::getAuthRedirectPageHtml() {
     )";
     return fmt::format(
         authRedirectPageTemplate,
-        obs_module_text("RewardsTheater"),
-        obs_module_text("TwitchAuthenticationFailedNoAccessToken"),
-        obs_module_text("TwitchAuthenticationSuccessful"),
-        obs_module_text("TwitchAuthenticationFailedTryAgain"),
-        obs_module_text("PleasePasteThisToken"),
-        obs_module_text("RewardsTheater"),
-        obs_module_text("TwitchAuthenticationInProgress")
+        obsApi.getLocaleText("RewardsTheater"),
+        obsApi.getLocaleText("TwitchAuthenticationFailedNoAccessToken"),
+        obsApi.getLocaleText("TwitchAuthenticationSuccessful"),
+        obsApi.getLocaleText("TwitchAuthenticationFailedTryAgain"),
+        obsApi.getLocaleText("PleasePasteThisToken"),
+        obsApi.getLocaleText("RewardsTheater"),
+        obsApi.getLocaleText("TwitchAuthenticationInProgress")
     );
 }
 
 std::string TwitchAuth::generateCsrfState() {
-    std::lock_guard guard(csrfStatesMutex);
-
     std::string csrfState;
     auto inserter = std::back_inserter(csrfState);
     std::string allowedChars = "0123456789abcdefghijklmnopqrstuvwxyz";
@@ -468,7 +522,6 @@ std::string TwitchAuth::generateCsrfState() {
 }
 
 bool TwitchAuth::isValidCsrfState(const std::string& csrfState) {
-    std::lock_guard guard(csrfStatesMutex);
     if (csrfStates.contains(csrfState)) {
         csrfStates.erase(csrfState);
         return true;
@@ -16,6 +16,9 @@
 
 #include "BoostAsio.h"
 #include "HttpClient.h"
+#include "IoThreadPool.h"
+#include "ObsApi.h"
+#include "PrometheusExporter.h"
 #include "Settings.h"
 
 /// A class for Twitch authentication using the Implicit grant flow.
@@ -25,12 +28,14 @@ class TwitchAuth : public QObject {
 
 public:
     TwitchAuth(
+        ObsApi& obsApi,
         Settings& settings,
         const std::string& clientId,
         const std::set<std::string>& scopes,
         std::uint16_t authServerPort,
         HttpClient& httpClient,
-        boost::asio::io_context& ioContext
+        const PrometheusExporter& prometheusExporter,
+        IoThreadPool::Strand executor
     );
     ~TwitchAuth() override;
     void startService();
@@ -97,19 +102,21 @@ private:
     std::string generateCsrfState();
     bool isValidCsrfState(const std::string& csrfState);
 
+    ObsApi& obsApi;
     Settings& settings;
     std::string clientId;
     std::set<std::string> scopes;
     std::uint16_t authServerPort;
     HttpClient& httpClient;
-    boost::asio::io_context& ioContext;
+    const PrometheusExporter& prometheusExporter;
+    IoThreadPool::Strand executor;
 
     std::optional<std::string> accessToken;
     std::optional<std::string> userId;
     std::optional<std::string> username;
     mutable std::mutex userMutex;
 
+    // Only accessed on the executor.
     std::set<std::string> csrfStates;
     std::default_random_engine randomEngine;
-    std::mutex csrfStatesMutex;
 };
@@ -23,11 +23,13 @@ public:
 
     ~TwitchAuthDialog() override;
 
-private slots:
-    void authenticateWithAccessToken();
+public slots:
     void showAuthenticationFailureMessage(std::exception_ptr reason);
     void showAccessTokenAboutToExpireMessage(std::chrono::seconds expiresIn);
 
+private slots:
+    void authenticateWithAccessToken();
+
 private:
     void showAuthenticationMessage(const std::string& message);
     void showOurselvesAfterAuthMessageBox();
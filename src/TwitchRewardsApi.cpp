@@ -6,7 +6,9 @@
 #include <fmt/core.h>
 
 #include <QMetaType>
+#include <algorithm>
 #include <boost/url.hpp>
+#include <chrono>
 #include <iomanip>
 #include <ranges>
 #include <set>
@@ -21,48 +23,95 @@ namespace asio = boost::asio;
 namespace http = boost::beast::http;
 namespace json = boost::json;
 
+using namespace std::chrono_literals;
+
+/// Requests that the settings dialog waits for, like reloading or changing the rewards.
+static constexpr HttpRequestTimeouts USER_REQUEST_TIMEOUTS{
+    .connect = 5s,
+    .handshake = 5s,
+    .firstByte = 10s,
+    .total = 20s,
+};
+/// Redemption status updates and reward pauses. A late update is still better than none, so they're given longer.
+static constexpr HttpRequestTimeouts STATUS_UPDATE_TIMEOUTS{.total = 30s};
+static constexpr HttpRequestTimeouts IMAGE_DOWNLOAD_TIMEOUTS{.total = 30s};
+
 TwitchRewardsApi::TwitchRewardsApi(
     TwitchAuth& twitchAuth,
     HttpClient& httpClient,
     Settings& settings,
-    asio::io_context& ioContext
+    RewardRegistry& rewardRegistry,
+    IoThreadPool::Strand executor
 )
-    : twitchAuth(twitchAuth), httpClient(httpClient), settings(settings), ioContext(ioContext) {
+    : twitchAuth(twitchAuth), httpClient(httpClient), settings(settings), rewardRegistry(rewardRegistry),
+      executor(executor) {
     connect(&twitchAuth, &TwitchAuth::onUserChanged, this, &TwitchRewardsApi::reloadRewards);
 }
 
 TwitchRewardsApi::~TwitchRewardsApi() = default;
 
+void TwitchRewardsApi::createReward(const RewardData& rewardData, RewardCallback callback) {
+    asio::co_spawn(executor, asyncCreateReward(rewardData, std::move(callback)), asio::detached);
+}
+
 void TwitchRewardsApi::createReward(const RewardData& rewardData, QObject* receiver, const char* member) {
-    asio::co_spawn(
-        ioContext, asyncCreateReward(rewardData, *(new QObjectCallback(this, receiver, member))), asio::detached
-    );
+    createReward(rewardData, RewardCallback(receiver, member, "std::variant<std::exception_ptr, Reward>"));
+}
+
+void TwitchRewardsApi::updateReward(const Reward& reward, RewardCallback callback) {
+    asio::co_spawn(executor, asyncUpdateReward(reward, std::move(callback)), asio::detached);
 }
 
 void TwitchRewardsApi::updateReward(const Reward& reward, QObject* receiver, const char* member) {
-    asio::co_spawn(
-        ioContext, asyncUpdateReward(reward, *(new QObjectCallback(this, receiver, member))), asio::detached
-    );
+    updateReward(reward, RewardCallback(receiver, member, "std::variant<std::exception_ptr, Reward>"));
 }
 
 void TwitchRewardsApi::reloadRewards() {
-    asio::co_spawn(ioContext, asyncReloadRewards(), asio::detached);
+    asio::co_spawn(executor, asyncReloadRewards(), asio::detached);
+}
+
+void TwitchRewardsApi::deleteReward(const Reward& reward, ExceptionCallback callback) {
+    asio::co_spawn(executor, asyncDeleteReward(reward, std::move(callback)), asio::detached);
 }
 
 void TwitchRewardsApi::deleteReward(const Reward& reward, QObject* receiver, const char* member) {
-    asio::co_spawn(
-        ioContext, asyncDeleteReward(reward, *(new QObjectCallback(this, receiver, member))), asio::detached
-    );
+    deleteReward(reward, ExceptionCallback(receiver, member, "std::exception_ptr"));
+}
+
+void TwitchRewardsApi::downloadImage(const Reward& reward, DownloadCallback callback) {
+    asio::co_spawn(executor, asyncDownloadImage(reward.imageUrl, std::move(callback)), asio::detached);
 }
 
 void TwitchRewardsApi::downloadImage(const Reward& reward, QObject* receiver, const char* member) {
-    asio::co_spawn(
-        ioContext, asyncDownloadImage(reward.imageUrl, *(new QObjectCallback(this, receiver, member))), asio::detached
-    );
+    downloadImage(reward, DownloadCallback(receiver, member, "std::string"));
 }
 
 void TwitchRewardsApi::updateRedemptionStatus(const RewardRedemption& rewardRedemption, RedemptionStatus status) {
-    asio::co_spawn(ioContext, asyncUpdateRedemptionStatus(rewardRedemption, status), asio::detached);
+    updateRedemptionStatus(std::vector{rewardRedemption}, status);
+}
+
+void TwitchRewardsApi::updateRedemptionStatus(
+    const std::vector<RewardRedemption>& rewardRedemptions,
+    RedemptionStatus status
+) {
+    for (std::size_t i = 0; i < rewardRedemptions.size(); i += MAX_REDEMPTIONS_PER_STATUS_UPDATE) {
+        std::size_t end = std::min(rewardRedemptions.size(), i + MAX_REDEMPTIONS_PER_STATUS_UPDATE);
+        std::vector<RewardRedemption> batch(rewardRedemptions.begin() + i, rewardRedemptions.begin() + end);
+        asio::co_spawn(executor, asyncUpdateRedemptionStatus(std::move(batch), status), asio::detached);
+    }
+}
+
+void TwitchRewardsApi::setRewardsPaused(const std::vector<std::string>& rewardIds, bool paused) {
+    asio::post(executor, [this, rewardIds, paused]() {
+        for (const std::string& rewardId : rewardIds) {
+            RewardPauseState& rewardPauseState = rewardPauseStates[rewardId];
+            rewardPauseState.pendingPaused = paused;
+            if (!rewardPauseState.requestInFlight) {
+                rewardPauseState.requestInFlight = true;
+                asio::co_spawn(executor, asyncSendRewardPausedStates(rewardId), asio::detached);
+            }
+        }
+    });
 }
 
 Reward TwitchRewardsApi::parseEventsubReward(const json::value& reward) {
@@ -113,7 +162,7 @@ const char* TwitchRewardsApi::UnexpectedHttpStatusException::what() const noexce
     return message.c_str();
 }
 
-asio::awaitable<void> TwitchRewardsApi::asyncCreateReward(RewardData rewardData, QObjectCallback& callback) {
+asio::awaitable<void> TwitchRewardsApi::asyncCreateReward(RewardData rewardData, RewardCallback callback) {
     std::variant<std::exception_ptr, Reward> reward;
     try {
         reward = co_await asyncCreateReward(rewardData);
@@ -121,10 +170,10 @@ asio::awaitable<void> TwitchRewardsApi::asyncCreateReward(RewardData rewardData,
         log(LOG_ERROR, "Exception in asyncCreateReward: {}", exception.what());
         reward = std::current_exception();
     }
-    callback("std::variant<std::exception_ptr, Reward>", reward);
+    callback(std::move(reward));
 }
 
-asio::awaitable<void> TwitchRewardsApi::asyncUpdateReward(Reward reward, QObjectCallback& callback) {
+asio::awaitable<void> TwitchRewardsApi::asyncUpdateReward(Reward reward, RewardCallback callback) {
     std::variant<std::exception_ptr, Reward> result;
     try {
         result = co_await asyncUpdateReward(reward);
@@ -132,7 +181,7 @@ asio::awaitable<void> TwitchRewardsApi::asyncUpdateReward(Reward reward, QObject
         log(LOG_ERROR, "Exception in asyncUpdateReward: {}", exception.what());
         result = std::current_exception();
     }
-    callback("std::variant<std::exception_ptr, Reward>", result);
+    callback(std::move(result));
 }
 
 asio::awaitable<void> TwitchRewardsApi::asyncReloadRewards() {
@@ -146,7 +195,7 @@ asio::awaitable<void> TwitchRewardsApi::asyncReloadRewards() {
     emit onRewardsUpdated(rewards);
 }
 
-asio::awaitable<void> TwitchRewardsApi::asyncDeleteReward(Reward reward, QObjectCallback& callback) {
+asio::awaitable<void> TwitchRewardsApi::asyncDeleteReward(Reward reward, ExceptionCallback callback) {
     std::exception_ptr result;
     try {
         co_await asyncDeleteReward(reward);
@@ -154,19 +203,20 @@ asio::awaitable<void> TwitchRewardsApi::asyncDeleteReward(Reward reward, QObject
         log(LOG_ERROR, "Exception in asyncDeleteReward: {}", exception.what());
         result = std::current_exception();
     }
-    callback("std::exception_ptr", result);
+    callback(result);
 }
 
-asio::awaitable<void> TwitchRewardsApi::asyncDownloadImage(boost::urls::url url, QObjectCallback& callback) {
+asio::awaitable<void> TwitchRewardsApi::asyncDownloadImage(boost::urls::url url, DownloadCallback callback) {
     try {
-        callback("std::string", co_await asyncDownloadImage(url));
+        callback(co_await asyncDownloadImage(url));
     } catch (const std::exception& exception) {
         log(LOG_ERROR, "Exception in asyncDownloadImage: {}", exception.what());
     }
 }
 
+// https://dev.twitch.tv/docs/api/reference/#update-redemption-status
 boost::asio::awaitable<void> TwitchRewardsApi::asyncUpdateRedemptionStatus(
-    RewardRedemption rewardRedemption,
+    std::vector<RewardRedemption> rewardRedemptions,
     RedemptionStatus status
 ) {
     try {
@@ -177,50 +227,112 @@ boost::asio::awaitable<void> TwitchRewardsApi::asyncUpdateRedemptionStatus(
         }
 
         std::string userId = twitchAuth.getUserIdOrThrow();
+        // The id parameter is repeated for every redemption, so it's put into the path.
+        boost::urls::url path("/helix/channel_points/custom_rewards/redemptions");
+        for (const RewardRedemption& rewardRedemption : rewardRedemptions) {
+            path.params().append({"id", rewardRedemption.redemptionId});
+        }
         std::initializer_list<boost::urls::param_view> requestParams{
-            {"id", rewardRedemption.redemptionId},
             {"broadcaster_id", userId},
-            {"reward_id", rewardRedemption.reward.id},
+            {"reward_id", rewardRedemptions.front().reward->id},
         };
         json::value requestBody{{"status", statusString}};
-        HttpClient::Response response = co_await httpClient.request(
+        std::shared_ptr<const HttpClient::Response> response = co_await httpClient.request(
             "api.twitch.tv",
-            "/helix/channel_points/custom_rewards/redemptions",
+            std::string(path.buffer()),
             twitchAuth,
             requestParams,
             http::verb::patch,
-            requestBody
+            requestBody,
+            HttpRequestPriority::HIGH,
+            STATUS_UPDATE_TIMEOUTS
         );
-        if (response.status != http::status::ok) {
-            throw UnexpectedHttpStatusException(response.json);
+        if (response->status != http::status::ok) {
+            throw UnexpectedHttpStatusException(response->json);
+        }
+        log(LOG_DEBUG,
+            "Successfully updated the status of {} redemptions to {}",
+            rewardRedemptions.size(),
+            statusString);
+        for (const RewardRedemption& rewardRedemption : rewardRedemptions) {
+            if (rewardRedemption.trace) {
+                rewardRedemption.trace->stamp(RedemptionTrace::Stage::STATUS_ACKNOWLEDGED);
+            }
         }
-        log(LOG_DEBUG, "Successfully updated redemption status to {}", statusString);
     } catch (const std::exception& exception) {
         log(LOG_ERROR, "Exception in asyncUpdateRedemptionStatus: {}", exception.what());
     }
+    for (const RewardRedemption& rewardRedemption : rewardRedemptions) {
+        if (rewardRedemption.trace) {
+            rewardRedemption.trace->finish();
+        }
+    }
+}
+
+asio::awaitable<void> TwitchRewardsApi::asyncSendRewardPausedStates(std::string rewardId) {
+    while (true) {
+        // References to map elements stay valid, and the elements are never erased.
+        RewardPauseState& rewardPauseState = rewardPauseStates[rewardId];
+        if (!rewardPauseState.pendingPaused.has_value()) {
+            rewardPauseState.requestInFlight = false;
+            co_return;
+        }
+        bool paused = rewardPauseState.pendingPaused.value();
+        rewardPauseState.pendingPaused.reset();
+        try {
+            co_await asyncSetRewardPaused(rewardId, paused);
+            log(LOG_INFO, "{} reward {} on Twitch", paused ? "Paused" : "Resumed", rewardId);
+        } catch (const std::exception& exception) {
+            log(LOG_ERROR, "Exception in asyncSetRewardPaused: {}", exception.what());
+        }
+    }
+}
+
+// https://dev.twitch.tv/docs/api/reference/#update-custom-reward
+asio::awaitable<void> TwitchRewardsApi::asyncSetRewardPaused(const std::string& rewardId, bool paused) {
+    std::string userId = twitchAuth.getUserIdOrThrow();
+    std::initializer_list<boost::urls::param_view> requestParams{{"broadcaster_id", userId}, {"id", rewardId}};
+    json::value requestBody{{"is_paused", paused}};
+    std::shared_ptr<const HttpClient::Response> response = co_await httpClient.request(
+        "api.twitch.tv",
+        "/helix/channel_points/custom_rewards",
+        twitchAuth,
+        requestParams,
+        http::verb::patch,
+        requestBody,
+        HttpRequestPriority::HIGH,
+        STATUS_UPDATE_TIMEOUTS
+    );
+    if (response->status != http::status::ok) {
+        throw UnexpectedHttpStatusException(response->json);
+    }
 }
 
 // https://dev.twitch.tv/docs/api/reference/#create-custom-rewards
 asio::awaitable<Reward> TwitchRewardsApi::asyncCreateReward(const RewardData& rewardData) {
     std::string userId = twitchAuth.getUserIdOrThrow();
     std::initializer_list<boost::urls::param_view> requestParams{{"broadcaster_id", userId}};
-    HttpClient::Response response = co_await httpClient.request(
+    std::shared_ptr<const HttpClient::Response> response = co_await httpClient.request(
         "api.twitch.tv",
         "/helix/channel_points/custom_rewards",
         twitchAuth,
         requestParams,
         http::verb::post,
-        rewardDataToJson(rewardData)
+        rewardDataToJson(rewardData),
+        HttpRequestPriority::NORMAL,
+        USER_REQUEST_TIMEOUTS
     );
 
-    checkForSameRewardTitleException(response.json);
-    switch (response.status) {
+    checkForSameRewardTitleException(response->json);
+    switch (response->status) {
     case http::status::ok: break;
     case http::status::forbidden: throw NotAffiliateException();
-    default: throw UnexpectedHttpStatusException(response.json);
+    default: throw UnexpectedHttpStatusException(response->json);
     }
 
-    co_return parseReward(response.json.at("data").at(0), true);
+    Reward createdReward = parseReward(response->json.at("data").at(0), true);
+    rewardRegistry.intern(createdReward);
+    co_return createdReward;
 }
 
 boost::asio::awaitable<Reward> TwitchRewardsApi::asyncUpdateReward(const Reward& reward) {
@@ -230,24 +342,27 @@ boost::asio::awaitable<Reward> TwitchRewardsApi::asyncUpdateReward(const Reward&
 
     std::string userId = twitchAuth.getUserIdOrThrow();
     std::initializer_list<boost::urls::param_view> requestParams{{"broadcaster_id", userId}, {"id", reward.id}};
-    HttpClient::Response response = co_await httpClient.request(
+    std::shared_ptr<const HttpClient::Response> response = co_await httpClient.request(
         "api.twitch.tv",
         "/helix/channel_points/custom_rewards",
         twitchAuth,
         requestParams,
         http::verb::patch,
-        rewardDataToJson(reward)
+        rewardDataToJson(reward),
+        HttpRequestPriority::NORMAL,
+        USER_REQUEST_TIMEOUTS
     );
 
-    checkForSameRewardTitleException(response.json);
-    if (response.status != http::status::ok) {
-        throw UnexpectedHttpStatusException(response.json);
+    checkForSameRewardTitleException(response->json);
+    if (response->status != http::status::ok) {
+        throw UnexpectedHttpStatusException(response->json);
     }
 
-    Reward updatedReward = parseReward(response.json.at("data").at(0), true);
+    Reward updatedReward = parseReward(response->json.at("data").at(0), true);
     if (updatedReward != reward) {
         throw RewardNotUpdatedException();
     }
+    rewardRegistry.intern(reward);
     co_return reward;
 }
 
@@ -295,44 +410,58 @@ void TwitchRewardsApi::checkForSameRewardTitleException(const boost::json::value
 
 // https://dev.twitch.tv/docs/api/reference/#get-custom-reward
 asio::awaitable<std::vector<Reward>> TwitchRewardsApi::asyncGetRewards() {
-    json::value manageableRewardsJson = co_await asyncGetRewardsRequest(true);
+    std::shared_ptr<const HttpClient::Response> manageableRewardsResponse = co_await asyncGetRewardsRequest(true);
     auto manageableRewardIdsView =
-        manageableRewardsJson.at("data").as_array() | std::views::transform([](const auto& reward) {
+        manageableRewardsResponse->json.at("data").as_array() | std::views::transform([](const auto& reward) {
             return value_to<std::string>(reward.at("id"));
         });
     std::set<std::string> manageableRewardIds(manageableRewardIdsView.begin(), manageableRewardIdsView.end());
 
-    auto allRewardsJson = co_await asyncGetRewardsRequest(false);
-    auto rewards =
-        allRewardsJson.at("data").as_array() | std::views::transform([&manageableRewardIds](const auto& reward) {
-            std::string id = value_to<std::string>(reward.at("id"));
-            bool isManageable = manageableRewardIds.contains(id);
-            return parseReward(reward, isManageable);
-        });
-    co_return std::vector<Reward>(rewards.begin(), rewards.end());
+    std::shared_ptr<const HttpClient::Response> allRewardsResponse = co_await asyncGetRewardsRequest(false);
+    const json::array& allRewardsJson = allRewardsResponse->json.at("data").as_array();
+    auto rewards = allRewardsJson | std::views::transform([&manageableRewardIds](const auto& reward) {
+        std::string id = value_to<std::string>(reward.at("id"));
+        bool isManageable = manageableRewardIds.contains(id);
+        return parseReward(reward, isManageable);
+    });
+    std::vector<Reward> result(rewards.begin(), rewards.end());
+    for (const Reward& reward : result) {
+        rewardRegistry.intern(reward);
+    }
+    co_return result;
 }
 
-asio::awaitable<json::value> TwitchRewardsApi::asyncGetRewardsRequest(bool onlyManageableRewards) {
+asio::awaitable<std::shared_ptr<const HttpClient::Response>> TwitchRewardsApi::asyncGetRewardsRequest(
+    bool onlyManageableRewards
+) {
     std::string userId = twitchAuth.getUserIdOrThrow();
     std::string onlyManageableRewardsString = fmt::format("{}", onlyManageableRewards);
     std::initializer_list<boost::urls::param_view> requestParams{
         {"broadcaster_id", userId},
         {"only_manageable_rewards", onlyManageableRewardsString},
     };
-    HttpClient::Response response =
-        co_await httpClient.request("api.twitch.tv", "/helix/channel_points/custom_rewards", twitchAuth, requestParams);
+    std::shared_ptr<const HttpClient::Response> response = co_await httpClient.request(
+        "api.twitch.tv",
+        "/helix/channel_points/custom_rewards",
+        twitchAuth,
+        requestParams,
+        http::verb::get,
+        {},
+        HttpRequestPriority::NORMAL,
+        USER_REQUEST_TIMEOUTS
+    );
 
-    switch (response.status) {
+    switch (response->status) {
     case http::status::ok: break;
     case http::status::forbidden: throw NotAffiliateException();
-    default: throw UnexpectedHttpStatusException(response.json);
+    default: throw UnexpectedHttpStatusException(response->json);
     }
 
-    co_return response.json;
+    co_return response;
 }
 
 Reward TwitchRewardsApi::parseReward(const json::value& reward, bool isManageable) {
-    return Reward{
+    Reward parsedReward{
         value_to<std::string>(reward.at("id")),
         value_to<std::string>(reward.at("title")),
         value_to<std::string>(reward.at("prompt")),
@@ -345,6 +474,8 @@ Reward TwitchRewardsApi::parseReward(const json::value& reward, bool isManageabl
         getOptionalSetting(reward.at("global_cooldown_setting"), "global_cooldown_seconds"),
         isManageable,
     };
+    parsedReward.isPaused = reward.at("is_paused").as_bool();
+    return parsedReward;
 }
 
 boost::urls::url TwitchRewardsApi::getImageUrl(const json::value& reward) {
@@ -371,17 +502,30 @@ asio::awaitable<void> TwitchRewardsApi::asyncDeleteReward(const Reward& reward)
 
     std::string userId = twitchAuth.getUserIdOrThrow();
     std::initializer_list<boost::urls::param_view> requestParams{{"broadcaster_id", userId}, {"id", reward.id}};
-    HttpClient::Response response = co_await httpClient.request(
-        "api.twitch.tv", "/helix/channel_points/custom_rewards", twitchAuth, requestParams, http::verb::delete_
+    std::shared_ptr<const HttpClient::Response> response = co_await httpClient.request(
+        "api.twitch.tv",
+        "/helix/channel_points/custom_rewards",
+        twitchAuth,
+        requestParams,
+        http::verb::delete_,
+        {},
+        HttpRequestPriority::NORMAL,
+        USER_REQUEST_TIMEOUTS
     );
 
-    if (response.status != http::status::no_content) {
-        throw UnexpectedHttpStatusException(response.json);
+    if (response->status != http::status::no_content) {
+        throw UnexpectedHttpStatusException(response->json);
     }
 
     settings.deleteReward(reward.id);
+    rewardRegistry.remove(reward.id);
 }
 
 asio::awaitable<std::string> TwitchRewardsApi::asyncDownloadImage(const boost::urls::url& url) {
-    co_return co_await httpClient.downloadFile(url.host(), url.path());
+    co_return co_await httpClient.downloadFile(
+        url.host(),
+        url.path(),
+        HttpRequestPriority::BELOW_NORMAL,
+        IMAGE_DOWNLOAD_TIMEOUTS
+    );
 }
@@ -6,8 +6,10 @@
 #include <boost/json.hpp>
 #include <exception>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <utility>
 #include <variant>
@@ -15,11 +17,14 @@
 
 #include "BoostAsio.h"
 #include "HttpClient.h"
+#include "IoThreadPool.h"
 #include "QObjectCallback.h"
+#include "RedemptionStatusApi.h"
 #include "Reward.h"
+#include "RewardRegistry.h"
 #include "TwitchAuth.h"
 
-class TwitchRewardsApi : public QObject {
+class TwitchRewardsApi : public QObject, public RedemptionStatusApi {
     Q_OBJECT
 
 public:
@@ -27,31 +32,43 @@ public:
         TwitchAuth& twitchAuth,
         HttpClient& httpClient,
         Settings& settings,
-        boost::asio::io_context& ioContext
+        RewardRegistry& rewardRegistry,
+        IoThreadPool::Strand executor
     );
     ~TwitchRewardsApi() override;
 
-    // Calls the receiver with the created reward as std::variant<std::exception_ptr, Reward>.
+    using RewardCallback = QObjectCallback<std::variant<std::exception_ptr, Reward>>;
+    using ExceptionCallback = QObjectCallback<std::exception_ptr>;
+    using DownloadCallback = QObjectCallback<std::string>;
+
+    // Calls the callback with the created reward.
+    void createReward(const RewardData& rewardData, RewardCallback callback);
     void createReward(const RewardData& rewardData, QObject* receiver, const char* member);
 
-    // Calls the receiver with the reward passed as std::variant<std::exception_ptr, Reward>.
+    // Calls the callback with the updated reward.
+    void updateReward(const Reward& reward, RewardCallback callback);
     void updateReward(const Reward& reward, QObject* receiver, const char* member);
 
     /// Loads the rewards and emits onRewardsUpdated.
     void reloadRewards();
 
-    /// Calls the receiver with std::exception_ptr.
+    /// Calls the callback with nullptr upon success.
+    void deleteReward(const Reward& reward, ExceptionCallback callback);
     void deleteReward(const Reward& reward, QObject* receiver, const char* member);
 
-    /// Calls the receiver with the downloaded bytes as std::string upon success.
+    /// Calls the callback with the downloaded bytes upon success.
+    void downloadImage(const Reward& reward, DownloadCallback callback);
     void downloadImage(const Reward& reward, QObject* receiver, const char* member);
 
-    enum class RedemptionStatus {
-        CANCELED,
-        FULFILLED,
-    };
-    void updateRedemptionStatus(const RewardRedemption& rewardRedemption, RedemptionStatus status);
+    void updateRedemptionStatus(const RewardRedemption& rewardRedemption, RedemptionStatus status) override;
+    void updateRedemptionStatus(
+        const std::vector<RewardRedemption>& rewardRedemptions,
+        RedemptionStatus status
+    ) override;
+    void setRewardsPaused(const std::vector<std::string>& rewardIds, bool paused) override;
 
+    /// Parses a reward from the Helix custom rewards response.
+    static Reward parseReward(const boost::json::value& reward, bool isManageable);
     static Reward parseEventsubReward(const boost::json::value& reward);
 
     class EmptyRewardTitleException : public std::exception {
@@ -96,15 +113,27 @@ signals:
     void onRewardsUpdated(const std::variant<std::exception_ptr, std::vector<Reward>>& newRewards);
 
 private:
-    boost::asio::awaitable<void> asyncCreateReward(RewardData rewardData, QObjectCallback& callback);
-    boost::asio::awaitable<void> asyncUpdateReward(Reward rewardData, QObjectCallback& callback);
+    /// Helix limit for the redemptions updated in one request.
+    static constexpr std::size_t MAX_REDEMPTIONS_PER_STATUS_UPDATE = 50;
+
+    struct RewardPauseState {
+        bool requestInFlight = false;
+        /// The state to send once the request in flight finishes.
+        std::optional<bool> pendingPaused;
+    };
+
+    boost::asio::awaitable<void> asyncCreateReward(RewardData rewardData, RewardCallback callback);
+    boost::asio::awaitable<void> asyncUpdateReward(Reward rewardData, RewardCallback callback);
     boost::asio::awaitable<void> asyncReloadRewards();
-    boost::asio::awaitable<void> asyncDeleteReward(Reward reward, QObjectCallback& callback);
-    boost::asio::awaitable<void> asyncDownloadImage(boost::urls::url url, QObjectCallback& callback);
+    boost::asio::awaitable<void> asyncDeleteReward(Reward reward, ExceptionCallback callback);
+    boost::asio::awaitable<void> asyncDownloadImage(boost::urls::url url, DownloadCallback callback);
     boost::asio::awaitable<void> asyncUpdateRedemptionStatus(
-        RewardRedemption rewardRedemption,
+        std::vector<RewardRedemption> rewardRedemptions,
         RedemptionStatus status
     );
+    /// Sends the pending states of the reward until there are none.
+    boost::asio::awaitable<void> asyncSendRewardPausedStates(std::string rewardId);
+    boost::asio::awaitable<void> asyncSetRewardPaused(const std::string& rewardId, bool paused);
 
     boost::asio::awaitable<Reward> asyncCreateReward(const RewardData& rewardData);
     boost::asio::awaitable<Reward> asyncUpdateReward(const Reward& reward);
@@ -112,8 +141,9 @@ private:
     void checkForSameRewardTitleException(const boost::json::value& response);
 
     boost::asio::awaitable<std::vector<Reward>> asyncGetRewards();
-    boost::asio::awaitable<boost::json::value> asyncGetRewardsRequest(bool onlyManageableRewards);
-    static Reward parseReward(const boost::json::value& reward, bool isManageable);
+    boost::asio::awaitable<std::shared_ptr<const HttpClient::Response>> asyncGetRewardsRequest(
+        bool onlyManageableRewards
+    );
     static boost::urls::url getImageUrl(const boost::json::value& reward);
     static std::optional<std::int64_t> getOptionalSetting(const boost::json::value& setting, const std::string& key);
 
@@ -123,5 +153,8 @@ private:
     TwitchAuth& twitchAuth;
     HttpClient& httpClient;
     Settings& settings;
-    boost::asio::io_context& ioContext;
+    RewardRegistry& rewardRegistry;
+    IoThreadPool::Strand executor;
+    /// Only accessed on the executor.
+    std::map<std::string, RewardPauseState> rewardPauseStates;
 };
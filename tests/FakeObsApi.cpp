@@ -0,0 +1,480 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "FakeObsApi.h"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <string_view>
+
+namespace asio = boost::asio;
+
+static const std::pair<std::uint32_t, std::uint32_t> VIDEO_SIZE = {1280, 720};
+
+class FakeObsApi::FakeSignalConnection : public ObsApi::SignalConnection {
+public:
+    FakeSignalConnection(FakeObsApi& obsApi, obs_source_t* source, std::string signal, std::uint64_t id)
+        : obsApi(obsApi), source(source), signal(std::move(signal)), id(id) {}
+
+    ~FakeSignalConnection() override {
+        obsApi.disconnectSignal(source, signal, id);
+    }
+
+private:
+    FakeObsApi& obsApi;
+    obs_source_t* source;
+    std::string signal;
+    std::uint64_t id;
+};
+
+FakeObsApi::FakeObsApi()
+    : scene(std::make_unique<obs_scene>("scene-uuid")), nextSignalId(0), timerWorkGuard(timerContext.get_executor()),
+      timerThread([this]() {
+          timerContext.run();
+      }) {}
+
+FakeObsApi::~FakeObsApi() {
+    timerWorkGuard.reset();
+    timerContext.stop();
+    timerThread.join();
+}
+
+void FakeObsApi::addMediaSource(const std::string& name, std::chrono::milliseconds duration) {
+    boost::json::object settings = {
+        {"is_local_file", true},
+        {"local_file", fmt::format("/videos/{}.mp4", name)},
+        {"looping", false},
+        {"restart_on_activate", true},
+        {"clear_on_media_end", true},
+        {"speed_percent", 100},
+    };
+    std::lock_guard guard(mutex);
+    obs_source_t* source = addSource(name, "ffmpeg_source", settings, duration, false);
+    sceneItems.push_back({scene.get(), source});
+}
+
+void FakeObsApi::addTextSource(const std::string& name) {
+    std::lock_guard guard(mutex);
+    addSource(name, "text_ft2_source_v2", {{"text", ""}}, std::chrono::milliseconds(0), false);
+}
+
+void FakeObsApi::setSourceSetting(
+    const std::string& name,
+    const std::string& setting,
+    const boost::json::value& value
+) {
+    std::lock_guard guard(mutex);
+    findSource(name)->settings[setting] = value;
+}
+
+boost::json::object FakeObsApi::getSourceSettingsByName(const std::string& name) {
+    std::lock_guard guard(mutex);
+    for (const obs_source& source : sources) {
+        if (source.name == name) {
+            return source.settings;
+        }
+    }
+    return {};
+}
+
+void FakeObsApi::setHideTransitionDuration(const std::string& name, std::chrono::milliseconds duration) {
+    std::lock_guard guard(mutex);
+    obs_source_t* source = findSource(name);
+    for (obs_scene_item& sceneItem : sceneItems) {
+        if (sceneItem.source == source) {
+            sceneItem.hideTransitionDuration = duration;
+        }
+    }
+}
+
+std::vector<std::string> FakeObsApi::getEvents() {
+    std::lock_guard guard(mutex);
+    return events;
+}
+
+std::vector<std::string> FakeObsApi::getPlayingSources() {
+    std::lock_guard guard(mutex);
+    std::vector<std::string> playingSources;
+    for (const obs_source& source : sources) {
+        if (source.playing) {
+            playingSources.push_back(source.name);
+        }
+    }
+    return playingSources;
+}
+
+bool FakeObsApi::getConfigBool(const char* section, const char* name) {
+    std::lock_guard guard(mutex);
+    return getConfigValue(section, name) == "true";
+}
+
+std::int64_t FakeObsApi::getConfigInt(const char* section, const char* name) {
+    std::lock_guard guard(mutex);
+    std::string value = getConfigValue(section, name);
+    return value.empty() ? 0 : std::stoll(value);
+}
+
+std::uint64_t FakeObsApi::getConfigUint(const char* section, const char* name) {
+    std::lock_guard guard(mutex);
+    std::string value = getConfigValue(section, name);
+    return value.empty() ? 0 : std::stoull(value);
+}
+
+double FakeObsApi::getConfigDouble(const char* section, const char* name) {
+    std::lock_guard guard(mutex);
+    std::string value = getConfigValue(section, name);
+    return value.empty() ? 0 : std::stod(value);
+}
+
+std::string FakeObsApi::getConfigString(const char* section, const char* name) {
+    std::lock_guard guard(mutex);
+    return getConfigValue(section, name);
+}
+
+void FakeObsApi::setConfigBool(const char* section, const char* name, bool value) {
+    setConfigString(section, name, value ? "true" : "false");
+}
+
+void FakeObsApi::setConfigInt(const char* section, const char* name, std::int64_t value) {
+    setConfigString(section, name, std::to_string(value).c_str());
+}
+
+void FakeObsApi::setConfigUint(const char* section, const char* name, std::uint64_t value) {
+    setConfigString(section, name, std::to_string(value).c_str());
+}
+
+void FakeObsApi::setConfigDouble(const char* section, const char* name, double value) {
+    setConfigString(section, name, fmt::format("{}", value).c_str());
+}
+
+void FakeObsApi::setConfigString(const char* section, const char* name, const char* value) {
+    std::lock_guard guard(mutex);
+    configValues[{section, name}] = value;
+}
+
+void FakeObsApi::setConfigDefaultBool(const char* section, const char* name, bool value) {
+    setConfigDefaultString(section, name, value ? "true" : "false");
+}
+
+void FakeObsApi::setConfigDefaultInt(const char* section, const char* name, std::int64_t value) {
+    setConfigDefaultString(section, name, std::to_string(value).c_str());
+}
+
+void FakeObsApi::setConfigDefaultUint(const char* section, const char* name, std::uint64_t value) {
+    setConfigDefaultString(section, name, std::to_string(value).c_str());
+}
+
+void FakeObsApi::setConfigDefaultDouble(const char* section, const char* name, double value) {
+    setConfigDefaultString(section, name, fmt::format("{}", value).c_str());
+}
+
+void FakeObsApi::setConfigDefaultString(const char* section, const char* name, const char* value) {
+    std::lock_guard guard(mutex);
+    configDefaults[{section, name}] = value;
+}
+
+bool FakeObsApi::hasConfigUserValue(const char* section, const char* name) {
+    std::lock_guard guard(mutex);
+    return configValues.contains({section, name});
+}
+
+void FakeObsApi::removeConfigValue(const char* section, const char* name) {
+    std::lock_guard guard(mutex);
+    configValues.erase({section, name});
+}
+
+std::string FakeObsApi::getLocaleText(const char* key) {
+    if (std::string_view(key) == "RedemptionCount") {
+        return "×{}";
+    }
+    return key;
+}
+
+ObsSourceRef FakeObsApi::getSourceByName(const std::string& name) {
+    std::lock_guard guard(mutex);
+    return makeSourceRef(findSource(name));
+}
+
+std::vector<ObsSourceRef> FakeObsApi::enumSources() {
+    std::lock_guard guard(mutex);
+    std::vector<ObsSourceRef> result;
+    for (obs_source& source : sources) {
+        if (!source.isPrivate) {
+            result.push_back(makeSourceRef(&source));
+        }
+    }
+    return result;
+}
+
+std::string FakeObsApi::getSourceName(obs_source_t* source) {
+    std::lock_guard guard(mutex);
+    return source->name;
+}
+
+std::string FakeObsApi::getSourceUuid(obs_source_t* source) {
+    std::lock_guard guard(mutex);
+    return source->uuid;
+}
+
+std::string FakeObsApi::getSourceId(obs_source_t* source) {
+    std::lock_guard guard(mutex);
+    return source->id;
+}
+
+boost::json::object FakeObsApi::getSourceSettings(obs_source_t* source) {
+    std::lock_guard guard(mutex);
+    return source->settings;
+}
+
+void FakeObsApi::updateSourceSettings(obs_source_t* source, const boost::json::object& settings) {
+    std::lock_guard guard(mutex);
+    for (const auto& [name, value] : settings) {
+        source->settings[name] = value;
+    }
+}
+
+ObsSourceRef FakeObsApi::duplicateSource(obs_source_t* source, const std::string& name) {
+    std::lock_guard guard(mutex);
+    return makeSourceRef(addSource(name, source->id, source->settings, source->duration, true));
+}
+
+ObsSourceRef FakeObsApi::createPrivateSource(
+    const std::string& id,
+    const std::string& name,
+    const boost::json::object& settings
+) {
+    std::lock_guard guard(mutex);
+    return makeSourceRef(addSource(name, id, settings, std::chrono::milliseconds(0), true));
+}
+
+void FakeObsApi::setSourceMuted([[maybe_unused]] obs_source_t* source, [[maybe_unused]] bool muted) {}
+
+bool FakeObsApi::isSourceActive(obs_source_t* source) {
+    std::lock_guard guard(mutex);
+    return std::ranges::any_of(sceneItems, [source](const obs_scene_item& sceneItem) {
+        return sceneItem.source == source && !sceneItem.removed && sceneItem.visible;
+    });
+}
+
+std::pair<std::uint32_t, std::uint32_t> FakeObsApi::getSourceSize(obs_source_t* source) {
+    std::lock_guard guard(mutex);
+    return source->playing ? VIDEO_SIZE : std::make_pair(0u, 0u);
+}
+
+std::optional<std::pair<std::uint32_t, std::uint32_t>> FakeObsApi::getSourceFrameSize(obs_source_t* source) {
+    std::lock_guard guard(mutex);
+    if (!source->playing) {
+        return std::nullopt;
+    }
+    return VIDEO_SIZE;
+}
+
+void FakeObsApi::restartMedia(obs_source_t* source) {
+    std::uint64_t playCount;
+    std::chrono::milliseconds duration;
+    bool looping;
+    {
+        std::lock_guard guard(mutex);
+        source->playing = true;
+        playCount = ++source->playCount;
+        duration = source->duration;
+        const boost::json::value* loopingSetting = source->settings.if_contains("looping");
+        looping = loopingSetting && loopingSetting->is_bool() && loopingSetting->get_bool();
+        events.push_back("start " + source->name);
+    }
+    emitSignal(source, "media_started");
+    if (looping) {
+        return;
+    }
+
+    auto timer = std::make_shared<asio::steady_timer>(timerContext, duration);
+    timer->async_wait([this, source, playCount, timer](const boost::system::error_code& error) {
+        if (error) {
+            return;
+        }
+        {
+            std::lock_guard guard(mutex);
+            if (source->playCount != playCount) {
+                return;
+            }
+            source->playing = false;
+        }
+        emitSignal(source, "media_ended");
+    });
+}
+
+void FakeObsApi::stopMedia(obs_source_t* source) {
+    {
+        std::lock_guard guard(mutex);
+        source->playing = false;
+        source->playCount++;
+        events.push_back("stop " + source->name);
+    }
+    emitSignal(source, "media_stopped");
+}
+
+std::int64_t FakeObsApi::getMediaDurationMilliseconds(obs_source_t* source) {
+    std::lock_guard guard(mutex);
+    return source->duration.count() > 0 ? source->duration.count() : -1;
+}
+
+std::unique_ptr<ObsApi::SignalConnection> FakeObsApi::connectSourceSignal(
+    obs_source_t* source,
+    const std::string& signal,
+    std::function<void()> callback
+) {
+    std::lock_guard guard(signalMutex);
+    std::uint64_t id = nextSignalId++;
+    source->signalHandlers[signal][id] = std::move(callback);
+    return std::make_unique<FakeSignalConnection>(*this, source, signal, id);
+}
+
+bool FakeObsApi::isVlcAvailable() {
+    return false;
+}
+
+std::size_t FakeObsApi::getVlcPlaylistSize([[maybe_unused]] obs_source_t* source) {
+    return 0;
+}
+
+void FakeObsApi::playVlcPlaylistItem([[maybe_unused]] obs_source_t* source, [[maybe_unused]] std::size_t index) {}
+
+std::pair<std::uint32_t, std::uint32_t> FakeObsApi::getBaseVideoSize() {
+    return {1920, 1080};
+}
+
+std::vector<ObsApi::SceneItem> FakeObsApi::findSceneItems(obs_source_t* source) {
+    std::lock_guard guard(mutex);
+    std::vector<SceneItem> result;
+    for (obs_scene_item& sceneItem : sceneItems) {
+        if (sceneItem.source == source && !sceneItem.removed) {
+            result.push_back({
+                ObsSceneRef(sceneItem.scene, [](obs_scene_t*) {}),
+                sceneItem.scene->uuid,
+                ObsSceneItemRef(&sceneItem, [](obs_sceneitem_t*) {}),
+            });
+        }
+    }
+    return result;
+}
+
+ObsApi::Vec2 FakeObsApi::getSceneItemPosition(const SceneItem& sceneItem) {
+    std::lock_guard guard(mutex);
+    return sceneItem.sceneItem->position;
+}
+
+ObsApi::Vec2 FakeObsApi::getSceneItemScale([[maybe_unused]] const SceneItem& sceneItem) {
+    return {1, 1};
+}
+
+ObsApi::Crop FakeObsApi::getSceneItemCrop([[maybe_unused]] obs_sceneitem_t* sceneItem) {
+    return {0, 0, 0, 0};
+}
+
+std::optional<std::chrono::milliseconds> FakeObsApi::getSceneItemTransitionDuration(
+    obs_sceneitem_t* sceneItem,
+    bool show
+) {
+    std::lock_guard guard(mutex);
+    if (show) {
+        return std::nullopt;
+    }
+    return sceneItem->hideTransitionDuration;
+}
+
+void FakeObsApi::updateSceneItems([[maybe_unused]] obs_scene_t* scene, const std::vector<SceneItemUpdate>& updates) {
+    std::vector<obs_source_t*> activatedSources;
+    {
+        std::lock_guard guard(mutex);
+        for (const SceneItemUpdate& update : updates) {
+            obs_sceneitem_t* sceneItem = update.sceneItem.get();
+            if (update.removeHideTransition) {
+                sceneItem->hideTransitionDuration.reset();
+            }
+            if (update.position.has_value()) {
+                sceneItem->position = update.position.value();
+            }
+            if (update.visible.has_value() && update.visible.value() != sceneItem->visible) {
+                sceneItem->visible = update.visible.value();
+                events.push_back((sceneItem->visible ? "show " : "hide ") + sceneItem->source->name);
+                if (sceneItem->visible) {
+                    activatedSources.push_back(sceneItem->source);
+                }
+            }
+        }
+    }
+    for (obs_source_t* source : activatedSources) {
+        emitSignal(source, "activate");
+    }
+}
+
+ObsSceneItemRef FakeObsApi::addSceneItemCopy(obs_sceneitem_t* sceneItem, obs_source_t* source) {
+    std::lock_guard guard(mutex);
+    for (const obs_scene_item& otherItem : sceneItems) {
+        if (otherItem.scene == sceneItem->scene && otherItem.source == source && !otherItem.removed) {
+            return {};
+        }
+    }
+    obs_scene_item& copy = sceneItems.emplace_back(*sceneItem);
+    copy.source = source;
+    copy.visible = false;
+    return ObsSceneItemRef(&copy, [](obs_sceneitem_t*) {});
+}
+
+void FakeObsApi::removeSceneItem(obs_sceneitem_t* sceneItem) {
+    std::lock_guard guard(mutex);
+    sceneItem->removed = true;
+}
+
+obs_source_t* FakeObsApi::addSource(
+    const std::string& name,
+    const std::string& id,
+    const boost::json::object& settings,
+    std::chrono::milliseconds duration,
+    bool isPrivate
+) {
+    std::string uuid = fmt::format("source-uuid-{}", sources.size());
+    return &sources.emplace_back(name, uuid, id, settings, duration, isPrivate);
+}
+
+obs_source_t* FakeObsApi::findSource(const std::string& name) {
+    for (obs_source& source : sources) {
+        if (source.name == name && !source.isPrivate) {
+            return &source;
+        }
+    }
+    return nullptr;
+}
+
+std::string FakeObsApi::getConfigValue(const char* section, const char* name) {
+    if (auto value = configValues.find({section, name}); value != configValues.end()) {
+        return value->second;
+    }
+    if (auto value = configDefaults.find({section, name}); value != configDefaults.end()) {
+        return value->second;
+    }
+    return "";
+}
+
+void FakeObsApi::emitSignal(obs_source_t* source, const std::string& signal) {
+    std::lock_guard guard(signalMutex);
+    // Copied, so that a callback may disconnect itself.
+    std::map<std::uint64_t, std::function<void()>> handlers = source->signalHandlers[signal];
+    for (const auto& [id, handler] : handlers) {
+        handler();
+    }
+}
+
+void FakeObsApi::disconnectSignal(obs_source_t* source, const std::string& signal, std::uint64_t id) {
+    std::lock_guard guard(signalMutex);
+    source->signalHandlers[signal].erase(id);
+}
+
+ObsSourceRef FakeObsApi::makeSourceRef(obs_source_t* source) {
+    if (!source) {
+        return {};
+    }
+    // The sources live as long as FakeObsApi, so there's no reference to release.
+    return ObsSourceRef(source, [](obs_source_t*) {});
+}
@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "BoostAsio.h"
+#include "ObsApi.h"
+
+struct obs_source {
+    std::string name;
+    std::string uuid;
+    std::string id;
+    boost::json::object settings;
+    std::chrono::milliseconds duration;
+    /// Not returned by getSourceByName and enumSources, like the sources that libobs creates as private.
+    bool isPrivate;
+    bool playing = false;
+    /// Incremented every time the media is restarted or stopped, so that a stale media_ended isn't emitted.
+    std::uint64_t playCount = 0;
+    /// Guarded by FakeObsApi::signalMutex.
+    std::map<std::string, std::map<std::uint64_t, std::function<void()>>> signalHandlers;
+};
+
+struct obs_scene {
+    std::string uuid;
+};
+
+struct obs_scene_item {
+    obs_scene_t* scene;
+    obs_source_t* source;
+    bool visible = false;
+    bool removed = false;
+    ObsApi::Vec2 position = {0, 0};
+    std::optional<std::chrono::milliseconds> hideTransitionDuration;
+};
+
+/// ObsApi in memory. The media sources "play" on a timer: restartMedia emits media_started right away and media_ended
+/// once the duration of the source has passed. What the plugin does to the sources is recorded as events, e.g.
+/// "start A", "show A", "hide A", "stop A".
+class FakeObsApi : public ObsApi {
+public:
+    FakeObsApi();
+    ~FakeObsApi() override;
+
+    /// Adds a Media Source that plays for the duration, with a hidden item in the scene.
+    void addMediaSource(const std::string& name, std::chrono::milliseconds duration);
+    void addTextSource(const std::string& name);
+    /// Changes a setting of the source like the user would in the source properties.
+    void setSourceSetting(const std::string& name, const std::string& setting, const boost::json::value& value);
+    /// Also finds the private duplicates, unlike getSourceByName.
+    boost::json::object getSourceSettingsByName(const std::string& name);
+    /// Gives the scene items of the source a hide transition, which the items copied from them get as well.
+    void setHideTransitionDuration(const std::string& name, std::chrono::milliseconds duration);
+    std::vector<std::string> getEvents();
+    /// The names of the sources that are playing right now, including the private duplicates.
+    std::vector<std::string> getPlayingSources();
+
+    bool getConfigBool(const char* section, const char* name) override;
+    std::int64_t getConfigInt(const char* section, const char* name) override;
+    std::uint64_t getConfigUint(const char* section, const char* name) override;
+    double getConfigDouble(const char* section, const char* name) override;
+    std::string getConfigString(const char* section, const char* name) override;
+    void setConfigBool(const char* section, const char* name, bool value) override;
+    void setConfigInt(const char* section, const char* name, std::int64_t value) override;
+    void setConfigUint(const char* section, const char* name, std::uint64_t value) override;
+    void setConfigDouble(const char* section, const char* name, double value) override;
+    void setConfigString(const char* section, const char* name, const char* value) override;
+    void setConfigDefaultBool(const char* section, const char* name, bool value) override;
+    void setConfigDefaultInt(const char* section, const char* name, std::int64_t value) override;
+    void setConfigDefaultUint(const char* section, const char* name, std::uint64_t value) override;
+    void setConfigDefaultDouble(const char* section, const char* name, double value) override;
+    void setConfigDefaultString(const char* section, const char* name, const char* value) override;
+    bool hasConfigUserValue(const char* section, const char* name) override;
+    void removeConfigValue(const char* section, const char* name) override;
+
+    std::string getLocaleText(const char* key) override;
+
+    ObsSourceRef getSourceByName(const std::string& name) override;
+    std::vector<ObsSourceRef> enumSources() override;
+    std::string getSourceName(obs_source_t* source) override;
+    std::string getSourceUuid(obs_source_t* source) override;
+    std::string getSourceId(obs_source_t* source) override;
+    boost::json::object getSourceSettings(obs_source_t* source) override;
+    void updateSourceSettings(obs_source_t* source, const boost::json::object& settings) override;
+    ObsSourceRef duplicateSource(obs_source_t* source, const std::string& name) override;
+    ObsSourceRef createPrivateSource(
+        const std::string& id,
+        const std::string& name,
+        const boost::json::object& settings
+    ) override;
+    void setSourceMuted(obs_source_t* source, bool muted) override;
+    bool isSourceActive(obs_source_t* source) override;
+    std::pair<std::uint32_t, std::uint32_t> getSourceSize(obs_source_t* source) override;
+    std::optional<std::pair<std::uint32_t, std::uint32_t>> getSourceFrameSize(obs_source_t* source) override;
+
+    void restartMedia(obs_source_t* source) override;
+    void stopMedia(obs_source_t* source) override;
+    std::int64_t getMediaDurationMilliseconds(obs_source_t* source) override;
+
+    std::unique_ptr<SignalConnection> connectSourceSignal(
+        obs_source_t* source,
+        const std::string& signal,
+        std::function<void()> callback
+    ) override;
+
+    bool isVlcAvailable() override;
+    std::size_t getVlcPlaylistSize(obs_source_t* source) override;
+    void playVlcPlaylistItem(obs_source_t* source, std::size_t index) override;
+
+    std::pair<std::uint32_t, std::uint32_t> getBaseVideoSize() override;
+    std::vector<SceneItem> findSceneItems(obs_source_t* source) override;
+    Vec2 getSceneItemPosition(const SceneItem& sceneItem) override;
+    Vec2 getSceneItemScale(const SceneItem& sceneItem) override;
+    Crop getSceneItemCrop(obs_sceneitem_t* sceneItem) override;
+    std::optional<std::chrono::milliseconds> getSceneItemTransitionDuration(
+        obs_sceneitem_t* sceneItem,
+        bool show
+    ) override;
+    void updateSceneItems(obs_scene_t* scene, const std::vector<SceneItemUpdate>& updates) override;
+    ObsSceneItemRef addSceneItemCopy(obs_sceneitem_t* sceneItem, obs_source_t* source) override;
+    void removeSceneItem(obs_sceneitem_t* sceneItem) override;
+
+private:
+    class FakeSignalConnection;
+
+    /// Must be called with mutex held.
+    obs_source_t* addSource(
+        const std::string& name,
+        const std::string& id,
+        const boost::json::object& settings,
+        std::chrono::milliseconds duration,
+        bool isPrivate
+    );
+    /// Ignores the private sources. Must be called with mutex held.
+    obs_source_t* findSource(const std::string& name);
+    /// The user value, or the default if there's none. Must be called with mutex held.
+    std::string getConfigValue(const char* section, const char* name);
+    /// Calls the callbacks without holding mutex, so that they can call the other methods.
+    void emitSignal(obs_source_t* source, const std::string& signal);
+    void disconnectSignal(obs_source_t* source, const std::string& signal, std::uint64_t id);
+
+    static ObsSourceRef makeSourceRef(obs_source_t* source);
+
+    std::mutex mutex;
+    std::map<std::pair<std::string, std::string>, std::string> configValues;
+    std::map<std::pair<std::string, std::string>, std::string> configDefaults;
+    // std::list, because the plugin keeps pointers to the elements. Nothing is freed before the destructor.
+    std::list<obs_source> sources;
+    std::unique_ptr<obs_scene> scene;
+    std::list<obs_scene_item> sceneItems;
+    std::vector<std::string> events;
+    std::uint64_t nextSignalId;
+
+    // Held while the callbacks are called, so that disconnecting waits for them, as in libobs.
+    std::recursive_mutex signalMutex;
+
+    boost::asio::io_context timerContext;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> timerWorkGuard;
+    std::thread timerThread;
+};
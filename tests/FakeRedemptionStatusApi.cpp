@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "FakeRedemptionStatusApi.h"
+
+void FakeRedemptionStatusApi::updateRedemptionStatus(
+    const RewardRedemption& rewardRedemption,
+    RedemptionStatus status
+) {
+    std::lock_guard guard(mutex);
+    redemptionStatusUpdates.emplace_back(rewardRedemption.redemptionId, status);
+}
+
+void FakeRedemptionStatusApi::updateRedemptionStatus(
+    const std::vector<RewardRedemption>& rewardRedemptions,
+    RedemptionStatus status
+) {
+    std::lock_guard guard(mutex);
+    for (const RewardRedemption& rewardRedemption : rewardRedemptions) {
+        redemptionStatusUpdates.emplace_back(rewardRedemption.redemptionId, status);
+    }
+}
+
+void FakeRedemptionStatusApi::setRewardsPaused(const std::vector<std::string>& rewardIds, bool paused) {
+    std::lock_guard guard(mutex);
+    rewardsPausedUpdates.emplace_back(rewardIds, paused);
+}
+
+std::vector<std::pair<std::string, RedemptionStatusApi::RedemptionStatus>> FakeRedemptionStatusApi::
+    getRedemptionStatusUpdates() {
+    std::lock_guard guard(mutex);
+    return redemptionStatusUpdates;
+}
+
+std::vector<std::pair<std::vector<std::string>, bool>> FakeRedemptionStatusApi::getRewardsPausedUpdates() {
+    std::lock_guard guard(mutex);
+    return rewardsPausedUpdates;
+}
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "RedemptionStatusApi.h"
+
+/// Records the requests instead of sending them to Twitch.
+class FakeRedemptionStatusApi : public RedemptionStatusApi {
+public:
+    void updateRedemptionStatus(const RewardRedemption& rewardRedemption, RedemptionStatus status) override;
+    void updateRedemptionStatus(const std::vector<RewardRedemption>& rewardRedemptions, RedemptionStatus status)
+        override;
+    void setRewardsPaused(const std::vector<std::string>& rewardIds, bool paused) override;
+
+    /// The IDs of the redemptions, in the order in which their statuses were updated.
+    std::vector<std::pair<std::string, RedemptionStatus>> getRedemptionStatusUpdates();
+    std::vector<std::pair<std::vector<std::string>, bool>> getRewardsPausedUpdates();
+
+private:
+    std::mutex mutex;
+    std::vector<std::pair<std::string, RedemptionStatus>> redemptionStatusUpdates;
+    std::vector<std::pair<std::vector<std::string>, bool>> rewardsPausedUpdates;
+};
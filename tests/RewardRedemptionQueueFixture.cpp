@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "RewardRedemptionQueueFixture.h"
+
+#include <chrono>
+#include <optional>
+#include <utility>
+
+RewardRedemptionQueueFixture::RewardRedemptionQueueFixture()
+    : settings(obsApi), ioThreadPool(1), mediaIndex("", ioThreadPool.makeDedicatedStrand("MediaIndex")),
+      mediaProber(obsApi, mediaIndex, ioThreadPool.makeDedicatedStrand("MediaProber")),
+      rewardRedemptionQueue(
+          obsApi,
+          settings,
+          redemptionStatusApi,
+          pluginMetrics,
+          mediaIndex,
+          mediaProber,
+          ioThreadPool.makeDedicatedStrand("RewardRedemptionQueue")
+      ) {}
+
+RewardRedemptionQueueFixture::~RewardRedemptionQueueFixture() {
+    // Stop the threads before destructing the objects that they use, like RewardsTheaterPlugin does.
+    ioThreadPool.stop();
+}
+
+RewardRedemption RewardRedemptionQueueFixture::makeRewardRedemption(
+    const std::string& rewardId,
+    const std::string& redemptionId
+) {
+    auto reward = std::make_shared<Reward>(
+        rewardId, rewardId, "", 1, boost::urls::url(), true, Color(), std::nullopt, std::nullopt, std::nullopt, true
+    );
+    return makeRewardRedemption(std::move(reward), redemptionId);
+}
+
+RewardRedemption RewardRedemptionQueueFixture::makeRewardRedemption(
+    std::shared_ptr<const Reward> reward,
+    std::string redemptionId
+) {
+    return {std::move(reward), std::move(redemptionId), nullptr, std::chrono::steady_clock::now()};
+}
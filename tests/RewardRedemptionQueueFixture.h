@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "FakeObsApi.h"
+#include "FakeRedemptionStatusApi.h"
+#include "IoThreadPool.h"
+#include "MediaIndex.h"
+#include "MediaProber.h"
+#include "PluginMetrics.h"
+#include "Reward.h"
+#include "RewardRedemptionQueue.h"
+#include "Settings.h"
+
+/// The queue with everything it needs, wired like in RewardsTheaterPlugin, but with the fakes instead of OBS and
+/// Twitch. Shared by the tests and the benchmarks.
+struct RewardRedemptionQueueFixture {
+    RewardRedemptionQueueFixture();
+    ~RewardRedemptionQueueFixture();
+
+    /// A redemption of a reward that has only an ID, which is also its title.
+    static RewardRedemption makeRewardRedemption(const std::string& rewardId, const std::string& redemptionId);
+    static RewardRedemption makeRewardRedemption(std::shared_ptr<const Reward> reward, std::string redemptionId);
+
+    FakeObsApi obsApi;
+    FakeRedemptionStatusApi redemptionStatusApi;
+    Settings settings;
+    IoThreadPool ioThreadPool;
+    PluginMetrics pluginMetrics;
+    MediaIndex mediaIndex;
+    MediaProber mediaProber;
+    RewardRedemptionQueue rewardRedemptionQueue;
+};
@@ -0,0 +1,316 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "RedemptionTracer.h"
+#include "RewardRedemptionQueueFixture.h"
+
+using namespace std::chrono_literals;
+using RedemptionStatus = RedemptionStatusApi::RedemptionStatus;
+
+/// Polls the condition, because the queue plays the rewards on its own thread.
+static bool waitUntil(const std::function<bool()>& condition, std::chrono::milliseconds timeout = 10s) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(10ms);
+    }
+    return true;
+}
+
+class RewardRedemptionQueueTest : public testing::Test, protected RewardRedemptionQueueFixture {};
+
+TEST_F(RewardRedemptionQueueTest, PlaysRedemptionsOneByOneAndFulfillsThem) {
+    obsApi.addMediaSource("A", 700ms);
+    obsApi.addMediaSource("B", 700ms);
+    settings.setObsSourceName("reward-a", "A");
+    settings.setObsSourceName("reward-b", "B");
+
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "1"));
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-b", "2"));
+
+    ASSERT_TRUE(waitUntil([this]() {
+        return redemptionStatusApi.getRedemptionStatusUpdates().size() == 2 && obsApi.getEvents().size() == 8;
+    }));
+    std::vector<std::pair<std::string, RedemptionStatus>> expectedStatusUpdates = {
+        {"1", RedemptionStatus::FULFILLED},
+        {"2", RedemptionStatus::FULFILLED},
+    };
+    EXPECT_EQ(redemptionStatusApi.getRedemptionStatusUpdates(), expectedStatusUpdates);
+    std::vector<std::string> expectedEvents = {
+        "start A", "show A", "hide A", "stop A", "start B", "show B", "hide B", "stop B"
+    };
+    EXPECT_EQ(obsApi.getEvents(), expectedEvents);
+    EXPECT_TRUE(rewardRedemptionQueue.getRewardRedemptionQueue().empty());
+}
+
+TEST_F(RewardRedemptionQueueTest, RemovingThePlayedRedemptionCancelsItAndStopsTheSource) {
+    obsApi.addMediaSource("A", 10s);
+    settings.setObsSourceName("reward-a", "A");
+    RewardRedemption rewardRedemption = makeRewardRedemption("reward-a", "1");
+
+    rewardRedemptionQueue.queueRewardRedemption(rewardRedemption);
+    ASSERT_TRUE(waitUntil([this]() {
+        return obsApi.getPlayingSources() == std::vector<std::string>{"A"};
+    }));
+    rewardRedemptionQueue.removeRewardRedemption(rewardRedemption);
+
+    ASSERT_TRUE(waitUntil([this]() {
+        return obsApi.getPlayingSources().empty();
+    }));
+    std::vector<std::pair<std::string, RedemptionStatus>> expectedStatusUpdates = {
+        {"1", RedemptionStatus::CANCELED},
+    };
+    EXPECT_EQ(redemptionStatusApi.getRedemptionStatusUpdates(), expectedStatusUpdates);
+    EXPECT_TRUE(rewardRedemptionQueue.getRewardRedemptionQueue().empty());
+}
+
+TEST_F(RewardRedemptionQueueTest, IgnoresRedemptionsOfUnmappedRewards) {
+    obsApi.addMediaSource("A", 700ms);
+    settings.setObsSourceName("reward-a", "A");
+
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-b", "1"));
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "2"));
+
+    ASSERT_TRUE(waitUntil([this]() {
+        return !redemptionStatusApi.getRedemptionStatusUpdates().empty();
+    }));
+    std::vector<std::pair<std::string, RedemptionStatus>> expectedStatusUpdates = {
+        {"2", RedemptionStatus::FULFILLED},
+    };
+    EXPECT_EQ(redemptionStatusApi.getRedemptionStatusUpdates(), expectedStatusUpdates);
+}
+
+TEST_F(RewardRedemptionQueueTest, PrewarmsAnInstanceWithTheLoopSettingOfTheReward) {
+    obsApi.addMediaSource("A", 700ms);
+    settings.setObsSourceName("reward-a", "A");
+    settings.setLoopVideoEnabled("reward-a", true);
+
+    rewardRedemptionQueue.probeMediaInBackground("reward-a");
+
+    ASSERT_TRUE(waitUntil([this]() {
+        return obsApi.getSourceSettingsByName("A (RewardsTheater 2)")["looping"] == true;
+    }));
+    EXPECT_EQ(obsApi.getSourceSettingsByName("A")["looping"], false);
+    EXPECT_TRUE(obsApi.getEvents().empty());
+}
+
+TEST_F(RewardRedemptionQueueTest, PipelinedPlaybackShowsAnotherInstanceDuringTheHideTransition) {
+    obsApi.addMediaSource("A", 300ms);
+    obsApi.setHideTransitionDuration("A", 500ms);
+    settings.setPipelinedPlaybackEnabled(true);
+    settings.setObsSourceName("reward-a", "A");
+    settings.setObsSourceName("reward-a2", "A");
+
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "1"));
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a2", "2"));
+
+    ASSERT_TRUE(waitUntil([this]() {
+        return redemptionStatusApi.getRedemptionStatusUpdates().size() == 2 && obsApi.getEvents().size() == 8;
+    }));
+    std::vector<std::string> events = obsApi.getEvents();
+    auto duplicateStart = std::ranges::find(events, "start A (RewardsTheater 2)");
+    ASSERT_NE(duplicateStart, events.end());
+    EXPECT_LT(std::ranges::find(events, "hide A"), duplicateStart);
+    EXPECT_GT(std::ranges::find(events, "stop A"), duplicateStart);
+    EXPECT_EQ(std::ranges::count(events, "start A"), 1);
+}
+
+TEST_F(RewardRedemptionQueueTest, PipelinedPlaybackDoesNotRestartTheOnlyInstanceDuringTheHideTransition) {
+    obsApi.addMediaSource("A", 300ms);
+    obsApi.setHideTransitionDuration("A", 500ms);
+    settings.setPipelinedPlaybackEnabled(true);
+    settings.setMaxSourceInstances(1);
+    settings.setObsSourceName("reward-a", "A");
+    settings.setObsSourceName("reward-a2", "A");
+
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "1"));
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a2", "2"));
+
+    ASSERT_TRUE(waitUntil([this]() {
+        return redemptionStatusApi.getRedemptionStatusUpdates().size() == 2 && obsApi.getEvents().size() == 8;
+    }));
+    std::vector<std::string> expectedEvents = {
+        "start A", "show A", "hide A", "stop A", "start A", "show A", "hide A", "stop A"
+    };
+    EXPECT_EQ(obsApi.getEvents(), expectedEvents);
+}
+
+TEST_F(RewardRedemptionQueueTest, RemovingAWaitingPipelinedRedemptionDoesNotStopTheHideTransition) {
+    obsApi.addMediaSource("A", 300ms);
+    obsApi.setHideTransitionDuration("A", 1s);
+    settings.setPipelinedPlaybackEnabled(true);
+    settings.setMaxSourceInstances(1);
+    settings.setObsSourceName("reward-a", "A");
+    RewardRedemption waitingRewardRedemption = makeRewardRedemption("reward-a", "2");
+
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "1"));
+    rewardRedemptionQueue.queueRewardRedemption(waitingRewardRedemption);
+    ASSERT_TRUE(waitUntil([this]() {
+        return redemptionStatusApi.getRedemptionStatusUpdates().size() == 1;
+    }));
+    rewardRedemptionQueue.removeRewardRedemption(waitingRewardRedemption);
+
+    ASSERT_TRUE(waitUntil([this]() {
+        return obsApi.getEvents().size() == 4;
+    }));
+    // Let the hide transition end, in case the source was stopped before it.
+    std::this_thread::sleep_for(1s);
+    std::vector<std::pair<std::string, RedemptionStatus>> expectedStatusUpdates = {
+        {"1", RedemptionStatus::FULFILLED},
+        {"2", RedemptionStatus::CANCELED},
+    };
+    EXPECT_EQ(redemptionStatusApi.getRedemptionStatusUpdates(), expectedStatusUpdates);
+    std::vector<std::string> expectedEvents = {"start A", "show A", "hide A", "stop A"};
+    EXPECT_EQ(obsApi.getEvents(), expectedEvents);
+}
+
+TEST_F(RewardRedemptionQueueTest, CoalescedRedemptionsGetThePlaybackStagesOfThePlayedRedemption) {
+    obsApi.addMediaSource("A", 300ms);
+    obsApi.addMediaSource("B", 300ms);
+    settings.setObsSourceName("reward-a", "A");
+    settings.setObsSourceName("reward-b", "B");
+    settings.setRedemptionCoalescingWindowSeconds(10);
+    RedemptionTracer redemptionTracer;
+    RewardRedemption playedRewardRedemption = makeRewardRedemption("reward-a", "2");
+    playedRewardRedemption.trace =
+        redemptionTracer.startTrace("2", "reward-a", std::nullopt, playedRewardRedemption.receivedAt);
+    RewardRedemption coalescedRewardRedemption = makeRewardRedemption("reward-a", "3");
+    coalescedRewardRedemption.trace =
+        redemptionTracer.startTrace("3", "reward-a", std::nullopt, coalescedRewardRedemption.receivedAt);
+
+    // B plays first, so that both redemptions of A are in the queue when A is dequeued.
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-b", "1"));
+    rewardRedemptionQueue.queueRewardRedemption(playedRewardRedemption);
+    rewardRedemptionQueue.queueRewardRedemption(coalescedRewardRedemption);
+
+    ASSERT_TRUE(waitUntil([this]() {
+        return redemptionStatusApi.getRedemptionStatusUpdates().size() == 3 && obsApi.getEvents().size() == 8;
+    }));
+    for (RedemptionTrace::Stage stage : {RedemptionTrace::Stage::SOURCE_STARTED, RedemptionTrace::Stage::ENDED}) {
+        std::optional<std::chrono::steady_clock::time_point> time = playedRewardRedemption.trace->getStageTime(stage);
+        ASSERT_TRUE(time.has_value());
+        EXPECT_EQ(coalescedRewardRedemption.trace->getStageTime(stage), time);
+    }
+}
+
+TEST_F(RewardRedemptionQueueTest, PlaysVideosFromAFolderOnADuplicate) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "RewardsTheaterTest-videos";
+    std::filesystem::create_directories(directory);
+    std::ofstream(directory / "clip.mp4") << "video";
+    obsApi.addMediaSource("A", 300ms);
+    settings.setMaxSourceInstances(1);
+    settings.setObsSourceName("reward-a", "A");
+    settings.setMediaDirectory("reward-a", MediaIndex::pathToUtf8(directory));
+
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "1"));
+
+    ASSERT_TRUE(waitUntil([this]() {
+        return redemptionStatusApi.getRedemptionStatusUpdates().size() == 1 && obsApi.getEvents().size() == 4;
+    }));
+    std::vector<std::string> expectedEvents = {
+        "start A (RewardsTheater 2)",
+        "show A (RewardsTheater 2)",
+        "hide A (RewardsTheater 2)",
+        "stop A (RewardsTheater 2)",
+    };
+    EXPECT_EQ(obsApi.getEvents(), expectedEvents);
+    EXPECT_EQ(obsApi.getSourceSettingsByName("A")["local_file"], "/videos/A.mp4");
+    EXPECT_EQ(
+        obsApi.getSourceSettingsByName("A (RewardsTheater 2)")["local_file"],
+        MediaIndex::pathToUtf8(directory / "clip.mp4")
+    );
+    std::filesystem::remove_all(directory);
+}
+
+TEST_F(RewardRedemptionQueueTest, PipelinedPlaybackWaitsForEarlierPlaybacksOfTheSameSource) {
+    obsApi.addMediaSource("A", 300ms);
+    obsApi.addMediaSource("B", 100ms);
+    obsApi.setHideTransitionDuration("A", 500ms);
+    settings.setPipelinedPlaybackEnabled(true);
+    settings.setMaxSourceInstances(1);
+    settings.setObsSourceName("reward-a", "A");
+    settings.setObsSourceName("reward-b", "B");
+
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "1"));
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-b", "2"));
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "3"));
+
+    ASSERT_TRUE(waitUntil([this]() {
+        return redemptionStatusApi.getRedemptionStatusUpdates().size() == 3 && obsApi.getEvents().size() == 12;
+    }));
+    std::vector<std::string> events = obsApi.getEvents();
+    auto firstStop = std::ranges::find(events, "stop A");
+    auto secondStart = std::find(std::ranges::find(events, "start A") + 1, events.end(), "start A");
+    ASSERT_NE(secondStart, events.end());
+    // B is shown during the hide transition of A, but A isn't restarted until the transition ends.
+    EXPECT_LT(std::ranges::find(events, "start B"), firstStop);
+    EXPECT_LT(firstStop, secondStart);
+}
+
+TEST_F(RewardRedemptionQueueTest, PlaysFasterThanTheOwnSpeedOfTheSourceInStepsUnderLoad) {
+    obsApi.addMediaSource("A", 300ms);
+    obsApi.addMediaSource("B", 300ms);
+    obsApi.setSourceSetting("A", "speed_percent", 120);
+    settings.setAdaptiveDrainThreshold(1);
+    settings.setAdaptiveDrainMaxSpeedPercent(160);
+    settings.setMaxSourceInstances(1);
+    settings.setObsSourceName("reward-a", "A");
+    settings.setObsSourceName("reward-b", "B");
+
+    // B keeps the queue busy while the redemptions of A are queued.
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-b", "1"));
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "2"));
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "3"));
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "4"));
+
+    // With the full load, the speed is raised by 50% (two steps of 25%, not 60%) from the own speed of A.
+    ASSERT_TRUE(waitUntil([this]() {
+        return obsApi.getSourceSettingsByName("A")["speed_percent"] == 180;
+    }));
+    ASSERT_TRUE(waitUntil([this]() {
+        return redemptionStatusApi.getRedemptionStatusUpdates().size() == 4;
+    }));
+    ASSERT_TRUE(waitUntil([this]() {
+        return obsApi.getPlayingSources().empty();
+    }));
+    EXPECT_EQ(obsApi.getSourceSettingsByName("A")["speed_percent"], 120);
+}
+
+TEST_F(RewardRedemptionQueueTest, PausesOnlyTheRewardsThatAreNotPausedAlreadyAndSavesThem) {
+    obsApi.addMediaSource("A", 10s);
+    settings.setBackpressureHighWaterMark(1);
+    settings.setObsSourceName("reward-a", "A");
+    settings.setObsSourceName("reward-b", "A");
+    Reward pausedReward = *makeRewardRedemption("reward-b", "").reward;
+    pausedReward.isPaused = true;
+    std::vector<Reward> rewards = {*makeRewardRedemption("reward-a", "").reward, pausedReward};
+    rewardRedemptionQueue.saveManageableRewardIds(rewards);
+
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "1"));
+    rewardRedemptionQueue.queueRewardRedemption(makeRewardRedemption("reward-a", "2"));
+
+    ASSERT_TRUE(waitUntil([this]() {
+        return !redemptionStatusApi.getRewardsPausedUpdates().empty();
+    }));
+    std::vector<std::pair<std::vector<std::string>, bool>> expectedRewardsPausedUpdates = {
+        {{"reward-a"}, true},
+    };
+    EXPECT_EQ(redemptionStatusApi.getRewardsPausedUpdates(), expectedRewardsPausedUpdates);
+    EXPECT_EQ(settings.getRewardIdsPausedOnTwitch(), std::vector<std::string>{"reward-a"});
+}
@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include <gtest/gtest.h>
+
+#include <ios>
+
+#include "Reward.h"
+
+TEST(ColorTest, ParsesAndFormatsHexColors) {
+    EXPECT_EQ(Color("#9147FF"), Color(0x91, 0x47, 0xff));
+    EXPECT_EQ(Color(0x00, 0xc7, 0xac).toHex(), "#00c7ac");
+    EXPECT_EQ(Color(""), Color());
+}
+
+TEST(ColorTest, RejectsInvalidHexColors) {
+    EXPECT_THROW(Color("#"), std::ios_base::failure);
+    EXPECT_THROW(Color("#xyz"), std::ios_base::failure);
+    EXPECT_THROW(Color("#9147FFzz"), std::ios_base::failure);
+}
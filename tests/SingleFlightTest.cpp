@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "BoostAsio.h"
+#include "SingleFlight.h"
+
+namespace asio = boost::asio;
+using namespace asio::experimental::awaitable_operators;
+using namespace std::chrono_literals;
+
+static const std::string KEY = "api.twitch.tv/helix/channel_points/custom_rewards?broadcaster_id=1";
+
+static asio::awaitable<std::string> asyncSlowOperation(int& operationCount, std::string result) {
+    operationCount++;
+    asio::steady_timer timer(co_await asio::this_coro::executor, 100ms);
+    co_await timer.async_wait(asio::use_awaitable);
+    co_return result;
+}
+
+static asio::awaitable<std::shared_ptr<const std::string>> asyncRun(
+    SingleFlight<std::string>& singleFlight,
+    int& operationCount,
+    std::string result,
+    std::chrono::milliseconds delay = 0ms
+) {
+    asio::steady_timer timer(co_await asio::this_coro::executor, delay);
+    co_await timer.async_wait(asio::use_awaitable);
+    co_return co_await singleFlight.run(KEY, [&] { return asyncSlowOperation(operationCount, result); });
+}
+
+template <typename Awaitable>
+static auto runOnStrand(Awaitable awaitable) {
+    asio::io_context ioContext;
+    auto future = asio::co_spawn(asio::make_strand(ioContext), std::move(awaitable), asio::use_future);
+    ioContext.run();
+    return future.get();
+}
+
+TEST(SingleFlightTest, ConcurrentCallersShareOneResult) {
+    SingleFlight<std::string> singleFlight;
+    int operationCount = 0;
+    auto [first, second] = runOnStrand(
+        asyncRun(singleFlight, operationCount, "first") && asyncRun(singleFlight, operationCount, "second", 10ms)
+    );
+    EXPECT_EQ(operationCount, 1);
+    EXPECT_EQ(*first, "first");
+    EXPECT_EQ(first.get(), second.get());
+}
+
+TEST(SingleFlightTest, ForgottenFlightIsNotJoined) {
+    SingleFlight<std::string> singleFlight;
+    int operationCount = 0;
+    auto asyncForgetAndRun = [&]() -> asio::awaitable<std::shared_ptr<const std::string>> {
+        asio::steady_timer timer(co_await asio::this_coro::executor, 50ms);
+        co_await timer.async_wait(asio::use_awaitable);
+        singleFlight.forget("api.twitch.tv/helix/channel_points/custom_rewards");
+        co_return co_await asyncRun(singleFlight, operationCount, "after");
+    };
+    // "before" runs from 0 to 100 ms, "after" runs from 50 to 150 ms.
+    auto [before, joinedBefore, after, joinedAfter] = runOnStrand(
+        asyncRun(singleFlight, operationCount, "before") && asyncRun(singleFlight, operationCount, "unused", 10ms) &&
+        asyncForgetAndRun() && asyncRun(singleFlight, operationCount, "unused", 120ms)
+    );
+    EXPECT_EQ(operationCount, 2);
+    EXPECT_EQ(*before, "before");
+    EXPECT_EQ(before.get(), joinedBefore.get());
+    EXPECT_EQ(*after, "after");
+    // The forgotten flight mustn't have removed the newer one with the same key when it finished.
+    EXPECT_EQ(after.get(), joinedAfter.get());
+}
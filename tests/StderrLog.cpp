@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include <iostream>
+
+#include "Log.h"
+
+void logMessage(int logLevel, const std::string& message) {
+    if (logLevel <= LOG_INFO) {
+        std::cerr << "[RewardsTheater] " << message << std::endl;
+    }
+}
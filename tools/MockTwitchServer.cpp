@@ -0,0 +1,723 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include "MockTwitchServer.h"
+
+#include <fmt/chrono.h>
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Log.h"
+
+namespace asio = boost::asio;
+namespace ssl = asio::ssl;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+namespace json = boost::json;
+using tcp = asio::ip::tcp;
+
+using namespace boost::asio::experimental::awaitable_operators;
+using namespace std::chrono_literals;
+
+static const char* const CHANNEL_POINTS_SUBSCRIPTION_TYPE = "channel.channel_points_custom_reward_redemption.add";
+// Twitch closes the session if there's no subscription within 10 seconds after the welcome message.
+static constexpr auto SUBSCRIBE_DEADLINE = 10s;
+// Twitch keeps the old session for 30 seconds after session_reconnect.
+static constexpr auto RECONNECT_GRACE_PERIOD = 30s;
+static constexpr auto STATS_INTERVAL = 10s;
+static constexpr int RATE_LIMIT_POINTS = 800;
+static constexpr std::uint16_t CONNECTION_UNUSED_CLOSE_CODE = 4003;
+static constexpr std::uint16_t RECONNECT_GRACE_TIME_EXPIRED_CLOSE_CODE = 4004;
+
+MockTwitchServer::EventsubSession::EventsubSession(asio::io_context& ioContext, std::string id)
+    : id(std::move(id)), connectedAt(std::chrono::steady_clock::now()), outgoingMessagesCondVar(ioContext) {}
+
+MockTwitchServer::MockTwitchServer(asio::io_context& ioContext, MockTwitchServerOptions options)
+    : ioContext(ioContext), options(std::move(options)), sslContext(ssl::context::tls_server),
+      acceptor(ioContext, tcp::endpoint(tcp::v4(), this->options.port)), randomEngine(std::random_device{}()),
+      userId("141981764"), userLogin("mockstreamer"), rateLimitRemaining(RATE_LIMIT_POINTS),
+      rateLimitResetTime(std::chrono::system_clock::now() + 1min), stats{} {
+    sslContext.use_certificate_chain_file(this->options.certificateFile);
+    sslContext.use_private_key_file(this->options.privateKeyFile, ssl::context::pem);
+    for (int i = 1; i <= this->options.rewardCount; i++) {
+        addReward(makeReward(fmt::format("Mock reward {}", i), 100 * i));
+    }
+}
+
+MockTwitchServer::~MockTwitchServer() = default;
+
+void MockTwitchServer::start() {
+    log(LOG_INFO, "Listening on port {}", options.port);
+    asio::co_spawn(ioContext, asyncAccept(), asio::detached);
+    asio::co_spawn(ioContext, asyncGenerateRedemptions(), asio::detached);
+    asio::co_spawn(ioContext, asyncGenerateBursts(), asio::detached);
+    asio::co_spawn(ioContext, asyncLogStatsForever(), asio::detached);
+}
+
+asio::awaitable<void> MockTwitchServer::asyncAccept() {
+    while (true) {
+        tcp::socket socket = co_await acceptor.async_accept(asio::use_awaitable);
+        asio::co_spawn(ioContext, asyncHandleConnection(std::move(socket)), asio::detached);
+    }
+}
+
+asio::awaitable<void> MockTwitchServer::asyncHandleConnection(tcp::socket socket) {
+    try {
+        SslStream stream(std::move(socket), sslContext);
+        co_await stream.async_handshake(ssl::stream_base::server, asio::use_awaitable);
+        beast::flat_buffer buffer;
+        while (true) {
+            Request request;
+            co_await http::async_read(stream, buffer, request, asio::use_awaitable);
+            if (websocket::is_upgrade(request)) {
+                co_await asyncHandleWebsocket(std::move(stream), std::move(request));
+                co_return;
+            }
+            Response response = co_await asyncHandleHelixRequest(request);
+            co_await http::async_write(stream, response, asio::use_awaitable);
+            if (!response.keep_alive()) {
+                break;
+            }
+        }
+        co_await stream.async_shutdown(asio::use_awaitable);
+    } catch (const boost::system::system_error& e) {
+        // Clients closing the connection end up here too.
+        log(LOG_DEBUG, "Connection closed: {}", e.what());
+    } catch (const std::exception& e) {
+        log(LOG_ERROR, "Exception in asyncHandleConnection: {}", e.what());
+    }
+}
+
+asio::awaitable<MockTwitchServer::Response> MockTwitchServer::asyncHandleHelixRequest(const Request& request) {
+    auto latency = options.latency;
+    if (options.latencyJitter > 0ms) {
+        std::uniform_int_distribution<std::int64_t> jitter(0, options.latencyJitter.count());
+        latency += std::chrono::milliseconds(jitter(randomEngine));
+    }
+    if (latency > 0ms) {
+        co_await asio::steady_timer(ioContext, latency).async_wait(asio::use_awaitable);
+    }
+
+    stats.helixRequests++;
+    auto now = std::chrono::system_clock::now();
+    if (now >= rateLimitResetTime) {
+        rateLimitRemaining = RATE_LIMIT_POINTS;
+        rateLimitResetTime = now + 1min;
+    }
+
+    Response response;
+    auto resetTime = rateLimitResetTime;
+    double random = std::uniform_real_distribution<double>(0, 1)(randomEngine);
+    if (random < options.errorRate) {
+        stats.injectedErrors++;
+        response = makeErrorResponse(http::status::internal_server_error, "Internal Server Error");
+    } else if (random < options.errorRate + options.rateLimitRate || rateLimitRemaining <= 0) {
+        stats.injectedRateLimits++;
+        if (rateLimitRemaining > 0) {
+            // An injected 429 asks the client to wait a second rather than until the bucket refills.
+            resetTime = now + 1s;
+        }
+        response = makeErrorResponse(http::status::too_many_requests, "Too Many Requests");
+    } else {
+        rateLimitRemaining--;
+        try {
+            response = handleHelixRequest(request);
+        } catch (const std::exception& e) {
+            // E.g. a malformed JSON body.
+            response = makeErrorResponse(http::status::bad_request, e.what());
+        }
+    }
+
+    bool limited = response.result() == http::status::too_many_requests;
+    auto resetTimestamp = std::chrono::duration_cast<std::chrono::seconds>(resetTime.time_since_epoch()).count();
+    response.set("Ratelimit-Limit", std::to_string(RATE_LIMIT_POINTS));
+    response.set("Ratelimit-Remaining", std::to_string(limited ? 0 : rateLimitRemaining));
+    response.set("Ratelimit-Reset", std::to_string(resetTimestamp));
+    response.keep_alive(request.keep_alive());
+    response.prepare_payload();
+    co_return response;
+}
+
+MockTwitchServer::Response MockTwitchServer::handleHelixRequest(const Request& request) {
+    boost::urls::url_view url = boost::urls::parse_origin_form(request.target()).value();
+    std::string path = url.path();
+    if (request.method() == http::verb::get && path == "/oauth2/authorize") {
+        // Opened in the browser, so there's no access token yet.
+        return handleAuthorize(url);
+    }
+    if (request[http::field::authorization].empty()) {
+        return makeErrorResponse(http::status::unauthorized, "OAuth token is missing");
+    }
+    json::object body;
+    if (!request.body().empty()) {
+        body = json::parse(request.body()).as_object();
+    }
+
+    http::verb method = request.method();
+    if (method == http::verb::get && path == "/oauth2/validate") {
+        return handleValidateToken();
+    } else if (method == http::verb::get && path == "/helix/users") {
+        return handleGetUsers();
+    } else if (path == "/helix/channel_points/custom_rewards") {
+        switch (method) {
+        case http::verb::get: return handleGetRewards(url);
+        case http::verb::post: return handleCreateReward(body);
+        case http::verb::patch: return handleUpdateReward(url, body);
+        case http::verb::delete_: return handleDeleteReward(url);
+        default: break;
+        }
+    } else if (method == http::verb::patch && path == "/helix/channel_points/custom_rewards/redemptions") {
+        return handleUpdateRedemptionStatus(url, body);
+    } else if (method == http::verb::post && path == "/helix/eventsub/subscriptions") {
+        return handleCreateSubscription(body);
+    }
+    return makeErrorResponse(http::status::not_found, "Not Found");
+}
+
+// https://dev.twitch.tv/docs/authentication/getting-tokens-oauth/#implicit-grant-flow
+MockTwitchServer::Response MockTwitchServer::handleAuthorize(const boost::urls::url_view& url) {
+    auto params = url.params();
+    auto redirectUriParam = params.find("redirect_uri");
+    auto stateParam = params.find("state");
+    if (redirectUriParam == params.end() || stateParam == params.end()) {
+        return makeErrorResponse(http::status::bad_request, "Missing redirect_uri or state");
+    }
+    // Any token is accepted, the authorization only has to reach the plugin.
+    boost::urls::url fragmentParams;
+    fragmentParams.params().append({"access_token", generateId()});
+    fragmentParams.params().append({"scope", "channel:read:redemptions channel:manage:redemptions"});
+    fragmentParams.params().append({"state", (*stateParam).value});
+    fragmentParams.params().append({"token_type", "bearer"});
+    Response response{http::status::found, 11};
+    response.set(http::field::location, (*redirectUriParam).value + "#" + std::string(fragmentParams.encoded_query()));
+    return response;
+}
+
+// https://dev.twitch.tv/docs/authentication/validate-tokens/
+MockTwitchServer::Response MockTwitchServer::handleValidateToken() {
+    json::value responseBody{
+        {"client_id", "mock"},
+        {"login", userLogin},
+        {"scopes", json::array{"channel:read:redemptions", "channel:manage:redemptions"}},
+        {"user_id", userId},
+        {"expires_in", 60 * 60 * 24},
+    };
+    return makeJsonResponse(http::status::ok, responseBody);
+}
+
+// https://dev.twitch.tv/docs/api/reference/#get-users
+MockTwitchServer::Response MockTwitchServer::handleGetUsers() {
+    json::object user{
+        {"id", userId},
+        {"login", userLogin},
+        {"display_name", "MockStreamer"},
+        {"broadcaster_type", "affiliate"},
+    };
+    return makeJsonResponse(http::status::ok, json::object{{"data", json::array{user}}});
+}
+
+// https://dev.twitch.tv/docs/api/reference/#get-custom-reward
+MockTwitchServer::Response MockTwitchServer::handleGetRewards(const boost::urls::url_view& url) {
+    // All the rewards count as created by the client ID of the plugin, so only_manageable_rewards changes nothing.
+    std::vector<std::string> ids;
+    for (const auto& param : url.params()) {
+        if (param.key == "id") {
+            ids.push_back(param.value);
+        }
+    }
+    json::array data;
+    for (const auto& [id, reward] : rewards) {
+        if (ids.empty() || std::ranges::find(ids, id) != ids.end()) {
+            data.push_back(reward);
+        }
+    }
+    return makeJsonResponse(http::status::ok, json::object{{"data", std::move(data)}});
+}
+
+// https://dev.twitch.tv/docs/api/reference/#create-custom-rewards
+MockTwitchServer::Response MockTwitchServer::handleCreateReward(const json::object& body) {
+    std::string title = value_to<std::string>(body.at("title"));
+    for (const auto& [id, reward] : rewards) {
+        if (reward.at("title").as_string() == title) {
+            return makeErrorResponse(http::status::bad_request, "CREATE_CUSTOM_REWARD_DUPLICATE_REWARD");
+        }
+    }
+    json::object reward = makeReward(title, value_to<std::int64_t>(body.at("cost")));
+    applyRewardUpdate(reward, body);
+    addReward(reward);
+    return makeJsonResponse(http::status::ok, json::object{{"data", json::array{reward}}});
+}
+
+// https://dev.twitch.tv/docs/api/reference/#update-custom-reward
+MockTwitchServer::Response MockTwitchServer::handleUpdateReward(
+    const boost::urls::url_view& url,
+    const json::object& body
+) {
+    auto params = url.params();
+    auto idParam = params.find("id");
+    auto reward = idParam == params.end() ? rewards.end() : rewards.find((*idParam).value);
+    if (reward == rewards.end()) {
+        return makeErrorResponse(http::status::not_found, "Not Found");
+    }
+    if (const json::value* title = body.if_contains("title")) {
+        for (const auto& [id, otherReward] : rewards) {
+            if (id != reward->first && otherReward.at("title") == *title) {
+                return makeErrorResponse(http::status::bad_request, "UPDATE_CUSTOM_REWARD_DUPLICATE_REWARD");
+            }
+        }
+    }
+    applyRewardUpdate(reward->second, body);
+    return makeJsonResponse(http::status::ok, json::object{{"data", json::array{reward->second}}});
+}
+
+// https://dev.twitch.tv/docs/api/reference/#delete-custom-reward
+MockTwitchServer::Response MockTwitchServer::handleDeleteReward(const boost::urls::url_view& url) {
+    auto params = url.params();
+    auto idParam = params.find("id");
+    if (idParam == params.end() || rewards.erase((*idParam).value) == 0) {
+        return makeErrorResponse(http::status::not_found, "Not Found");
+    }
+    Response response{http::status::no_content, 11};
+    return response;
+}
+
+// https://dev.twitch.tv/docs/api/reference/#update-redemption-status
+MockTwitchServer::Response MockTwitchServer::handleUpdateRedemptionStatus(
+    const boost::urls::url_view& url,
+    const json::object& body
+) {
+    std::string status = value_to<std::string>(body.at("status"));
+    if (status != "FULFILLED" && status != "CANCELED") {
+        return makeErrorResponse(http::status::bad_request, "Invalid status");
+    }
+    auto params = url.params();
+    auto rewardIdParam = params.find("reward_id");
+    std::string rewardId = rewardIdParam == params.end() ? "" : (*rewardIdParam).value;
+    json::array data;
+    for (const auto& param : params) {
+        if (param.key != "id") {
+            continue;
+        }
+        (status == "FULFILLED" ? stats.redemptionsFulfilled : stats.redemptionsCanceled)++;
+        data.push_back(json::object{
+            {"id", param.value},
+            {"broadcaster_id", userId},
+            {"status", status},
+            {"reward", {{"id", rewardId}}},
+        });
+    }
+    if (data.empty() || data.size() > 50) {
+        return makeErrorResponse(http::status::bad_request, "Between 1 and 50 ids must be given");
+    }
+    return makeJsonResponse(http::status::ok, json::object{{"data", std::move(data)}});
+}
+
+// https://dev.twitch.tv/docs/api/reference/#create-eventsub-subscription
+MockTwitchServer::Response MockTwitchServer::handleCreateSubscription(const json::object& body) {
+    if (body.at("type").as_string() != CHANNEL_POINTS_SUBSCRIPTION_TYPE ||
+        body.at("transport").at("method").as_string() != "websocket") {
+        return makeErrorResponse(http::status::bad_request, "Unsupported subscription");
+    }
+    std::string sessionId = value_to<std::string>(body.at("transport").at("session_id"));
+    auto session = sessions.find(sessionId);
+    if (session == sessions.end()) {
+        return makeErrorResponse(
+            http::status::bad_request, "websocket transport session does not exist or has already disconnected"
+        );
+    }
+    if (session->second->subscribed) {
+        return makeErrorResponse(http::status::conflict, "subscription already exists");
+    }
+    session->second->subscribed = true;
+    session->second->subscriptionId = generateId();
+    session->second->outgoingMessagesCondVar.cancel();
+    log(LOG_INFO, "Session {} subscribed", sessionId);
+    json::object responseBody{
+        {"data", json::array{makeSubscription(*session->second)}},
+        {"total", 1},
+        {"total_cost", 0},
+        {"max_total_cost", 10},
+    };
+    return makeJsonResponse(http::status::accepted, responseBody);
+}
+
+MockTwitchServer::Response MockTwitchServer::makeJsonResponse(http::status status, const json::value& body) {
+    Response response{status, 11};
+    response.set(http::field::content_type, "application/json");
+    response.body() = json::serialize(body);
+    return response;
+}
+
+MockTwitchServer::Response MockTwitchServer::makeErrorResponse(http::status status, const std::string& message) {
+    json::value body{
+        {"error", std::string(http::obsolete_reason(status))},
+        {"status", static_cast<int>(status)},
+        {"message", message},
+    };
+    return makeJsonResponse(status, body);
+}
+
+asio::awaitable<void> MockTwitchServer::asyncHandleWebsocket(SslStream stream, Request request) {
+    WebsocketStream ws(std::move(stream));
+    co_await ws.async_accept(request, asio::use_awaitable);
+
+    auto session = std::make_shared<EventsubSession>(ioContext, generateId());
+    sessions[session->id] = session;
+    stats.sessionsOpened++;
+    // Subscriptions carry over to the session that the client opens with the reconnect URL.
+    boost::urls::url_view url = boost::urls::parse_origin_form(request.target()).value();
+    auto params = url.params();
+    if (auto reconnectParam = params.find("reconnect_session"); reconnectParam != params.end()) {
+        auto oldSession = sessions.find((*reconnectParam).value);
+        if (oldSession != sessions.end() && oldSession->second->subscribed) {
+            session->subscribed = true;
+            session->subscriptionId = oldSession->second->subscriptionId;
+            oldSession->second->subscribed = false;
+        }
+    }
+    log(LOG_INFO, "Session {} connected", session->id);
+
+    try {
+        co_await (asyncReadUntilClosed(ws) || asyncWriteSessionMessages(ws, session));
+    } catch (const std::exception& e) {
+        log(LOG_DEBUG, "Exception in asyncHandleWebsocket: {}", e.what());
+    }
+    sessions.erase(session->id);
+    log(LOG_INFO, "Session {} disconnected", session->id);
+}
+
+asio::awaitable<void> MockTwitchServer::asyncReadUntilClosed(WebsocketStream& ws) {
+    beast::flat_buffer buffer;
+    while (true) {
+        // Twitch ignores the messages from the client.
+        co_await ws.async_read(buffer, asio::use_awaitable);
+        buffer.clear();
+    }
+}
+
+asio::awaitable<void> MockTwitchServer::asyncWriteSessionMessages(
+    WebsocketStream& ws,
+    std::shared_ptr<EventsubSession> session
+) {
+    using TimePoint = std::chrono::steady_clock::time_point;
+    std::optional<TimePoint> subscribeDeadline = session->connectedAt + SUBSCRIBE_DEADLINE;
+    std::optional<TimePoint> reconnectTime, revokeTime, closeTime;
+    if (options.reconnectAfter) {
+        reconnectTime = session->connectedAt + *options.reconnectAfter;
+    }
+    if (options.revokeAfter) {
+        revokeTime = session->connectedAt + *options.revokeAfter;
+    }
+    auto keepaliveInterval = std::chrono::seconds(options.keepaliveTimeoutSeconds);
+
+    sendMessage(
+        *session,
+        "session_welcome",
+        {{"session",
+          {
+              {"id", session->id},
+              {"status", "connected"},
+              {"connected_at", formatTimestamp(std::chrono::system_clock::now())},
+              {"keepalive_timeout_seconds", options.keepaliveTimeoutSeconds},
+              {"reconnect_url", nullptr},
+          }}}
+    );
+    TimePoint lastMessageSentAt = std::chrono::steady_clock::now();
+
+    while (true) {
+        while (!session->outgoingMessages.empty()) {
+            std::string message = std::move(session->outgoingMessages.front());
+            session->outgoingMessages.pop_front();
+            co_await ws.async_write(asio::buffer(message), asio::use_awaitable);
+            lastMessageSentAt = std::chrono::steady_clock::now();
+        }
+
+        TimePoint now = std::chrono::steady_clock::now();
+        if (session->subscribed) {
+            subscribeDeadline.reset();
+        }
+        if (subscribeDeadline && now >= *subscribeDeadline) {
+            log(LOG_WARNING, "Closing session {}: no subscription in {} s", session->id, SUBSCRIBE_DEADLINE.count());
+            co_await ws.async_close({CONNECTION_UNUSED_CLOSE_CODE, "connection unused"}, asio::use_awaitable);
+            co_return;
+        }
+        if (closeTime && now >= *closeTime) {
+            co_await ws.async_close(
+                {RECONNECT_GRACE_TIME_EXPIRED_CLOSE_CODE, "reconnect grace time expired"}, asio::use_awaitable
+            );
+            co_return;
+        }
+        if (reconnectTime && now >= *reconnectTime) {
+            reconnectTime.reset();
+            session->reconnecting = true;
+            closeTime = now + RECONNECT_GRACE_PERIOD;
+            log(LOG_INFO, "Asking session {} to reconnect", session->id);
+            sendMessage(
+                *session,
+                "session_reconnect",
+                {{"session",
+                  {
+                      {"id", session->id},
+                      {"status", "reconnecting"},
+                      {"connected_at", formatTimestamp(std::chrono::system_clock::now())},
+                      {"keepalive_timeout_seconds", nullptr},
+                      {"reconnect_url",
+                       fmt::format("wss://eventsub.wss.twitch.tv/ws?reconnect_session={}", session->id)},
+                  }}}
+            );
+            continue;
+        }
+        if (revokeTime && now >= *revokeTime) {
+            revokeTime.reset();
+            if (session->subscribed) {
+                log(LOG_INFO, "Revoking the subscription of session {}", session->id);
+                json::object subscription = makeSubscription(*session);
+                subscription["status"] = "authorization_revoked";
+                session->subscribed = false;
+                sendMessage(*session, "revocation", {{"subscription", std::move(subscription)}});
+                continue;
+            }
+        }
+        if (now >= lastMessageSentAt + keepaliveInterval) {
+            sendMessage(*session, "session_keepalive", {});
+            continue;
+        }
+
+        TimePoint wakeUpTime = lastMessageSentAt + keepaliveInterval;
+        for (const std::optional<TimePoint>& time : {subscribeDeadline, closeTime, reconnectTime, revokeTime}) {
+            if (time) {
+                wakeUpTime = std::min(wakeUpTime, *time);
+            }
+        }
+        session->outgoingMessagesCondVar.expires_at(wakeUpTime);
+        try {
+            co_await session->outgoingMessagesCondVar.async_wait(asio::use_awaitable);
+        } catch (const boost::system::system_error&) {
+            // A message was added.
+        }
+    }
+}
+
+void MockTwitchServer::sendMessage(EventsubSession& session, const std::string& messageType, json::object payload) {
+    json::object metadata{
+        {"message_id", generateId()},
+        {"message_type", messageType},
+        {"message_timestamp", formatTimestamp(std::chrono::system_clock::now())},
+    };
+    if (messageType == "notification" || messageType == "revocation") {
+        metadata["subscription_type"] = CHANNEL_POINTS_SUBSCRIPTION_TYPE;
+        metadata["subscription_version"] = "1";
+    }
+    json::object message{{"metadata", std::move(metadata)}, {"payload", std::move(payload)}};
+    session.outgoingMessages.push_back(json::serialize(message));
+    session.outgoingMessagesCondVar.cancel();  // Equivalent to notify_all() for a condition variable.
+}
+
+asio::awaitable<void> MockTwitchServer::asyncGenerateRedemptions() {
+    if (options.redemptionsPerSecond <= 0) {
+        co_return;
+    }
+    // The intervals between the events of a Poisson process are exponentially distributed.
+    std::exponential_distribution<double> interval(options.redemptionsPerSecond);
+    asio::steady_timer timer(ioContext, std::chrono::steady_clock::now());
+    while (true) {
+        // expires_at, so that the time spent generating doesn't lower the rate.
+        timer.expires_at(
+            timer.expiry() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(interval(randomEngine))
+            )
+        );
+        co_await timer.async_wait(asio::use_awaitable);
+        generateRedemption();
+    }
+}
+
+asio::awaitable<void> MockTwitchServer::asyncGenerateBursts() {
+    if (options.burstsPerMinute <= 0 || options.meanBurstSize <= 0) {
+        co_return;
+    }
+    std::exponential_distribution<double> interval(options.burstsPerMinute / 60);
+    std::poisson_distribution<int> burstSize(options.meanBurstSize);
+    asio::steady_timer timer(ioContext, std::chrono::steady_clock::now());
+    while (true) {
+        timer.expires_at(
+            timer.expiry() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(interval(randomEngine))
+            )
+        );
+        co_await timer.async_wait(asio::use_awaitable);
+        int size = burstSize(randomEngine);
+        log(LOG_INFO, "Burst of {} redemptions", size);
+        for (int i = 0; i < size; i++) {
+            generateRedemption();
+        }
+    }
+}
+
+void MockTwitchServer::generateRedemption() {
+    // Like on Twitch, the viewers can only redeem the rewards that are enabled and not paused.
+    std::vector<const json::object*> redeemableRewards;
+    for (const auto& [id, reward] : rewards) {
+        if (reward.at("is_enabled").as_bool() && !reward.at("is_paused").as_bool()) {
+            redeemableRewards.push_back(&reward);
+        }
+    }
+    if (redeemableRewards.empty()) {
+        return;
+    }
+    std::uniform_int_distribution<std::size_t> rewardIndex(0, redeemableRewards.size() - 1);
+    const json::object& reward = *redeemableRewards[rewardIndex(randomEngine)];
+    std::uniform_int_distribution<int> viewerIndex(1, 1000);
+    std::string viewer = fmt::format("viewer{}", viewerIndex(randomEngine));
+
+    stats.redemptionsGenerated++;
+    json::object event{
+        {"id", generateId()},
+        {"broadcaster_user_id", userId},
+        {"broadcaster_user_login", userLogin},
+        {"broadcaster_user_name", "MockStreamer"},
+        {"user_id", std::to_string(viewerIndex(randomEngine))},
+        {"user_login", viewer},
+        {"user_name", viewer},
+        {"user_input", ""},
+        {"status", "unfulfilled"},
+        {"reward",
+         {
+             {"id", reward.at("id")},
+             {"title", reward.at("title")},
+             {"cost", reward.at("cost")},
+             {"prompt", reward.at("prompt")},
+         }},
+        {"redeemed_at", formatTimestamp(std::chrono::system_clock::now())},
+    };
+    for (const auto& [id, session] : sessions) {
+        if (session->subscribed && !session->reconnecting) {
+            stats.notificationsSent++;
+            sendMessage(*session, "notification", {{"subscription", makeSubscription(*session)}, {"event", event}});
+        }
+    }
+}
+
+asio::awaitable<void> MockTwitchServer::asyncLogStatsForever() {
+    asio::steady_timer timer(ioContext);
+    while (true) {
+        timer.expires_after(STATS_INTERVAL);
+        co_await timer.async_wait(asio::use_awaitable);
+        log(LOG_INFO,
+            "{} sessions, {} Helix requests ({} errors and {} rate limits injected), {} redemptions generated, "
+            "{} notifications sent, {} redemptions fulfilled, {} canceled",
+            sessions.size(),
+            stats.helixRequests,
+            stats.injectedErrors,
+            stats.injectedRateLimits,
+            stats.redemptionsGenerated,
+            stats.notificationsSent,
+            stats.redemptionsFulfilled,
+            stats.redemptionsCanceled);
+    }
+}
+
+void MockTwitchServer::addReward(json::object reward) {
+    std::string id = value_to<std::string>(reward.at("id"));
+    rewards[id] = std::move(reward);
+}
+
+json::object MockTwitchServer::makeReward(const std::string& title, std::int64_t cost) {
+    return json::object{
+        {"broadcaster_id", userId},
+        {"broadcaster_login", userLogin},
+        {"broadcaster_name", "MockStreamer"},
+        {"id", generateId()},
+        {"title", title},
+        {"prompt", ""},
+        {"cost", cost},
+        {"image", nullptr},
+        {"default_image",
+         {
+             {"url_1x", "https://static-cdn.jtvnw.net/custom-reward-images/default-1.png"},
+             {"url_2x", "https://static-cdn.jtvnw.net/custom-reward-images/default-2.png"},
+             {"url_4x", "https://static-cdn.jtvnw.net/custom-reward-images/default-4.png"},
+         }},
+        {"background_color", "#9147FF"},
+        {"is_enabled", true},
+        {"is_user_input_required", false},
+        {"max_per_stream_setting", {{"is_enabled", false}, {"max_per_stream", 0}}},
+        {"max_per_user_per_stream_setting", {{"is_enabled", false}, {"max_per_user_per_stream", 0}}},
+        {"global_cooldown_setting", {{"is_enabled", false}, {"global_cooldown_seconds", 0}}},
+        {"is_paused", false},
+        {"is_in_stock", true},
+        {"should_redemptions_skip_request_queue", false},
+        {"redemptions_redeemed_current_stream", nullptr},
+        {"cooldown_expires_at", nullptr},
+    };
+}
+
+void MockTwitchServer::applyRewardUpdate(json::object& reward, const json::object& update) {
+    // The request fields that are stored in the reward as is.
+    for (const char* key :
+         {"title", "prompt", "cost", "background_color", "is_enabled", "is_user_input_required", "is_paused",
+          "should_redemptions_skip_request_queue"}) {
+        if (const json::value* value = update.if_contains(key)) {
+            reward[key] = *value;
+        }
+    }
+    // The request fields that are stored in the nested settings.
+    struct NestedSetting {
+        const char* settingKey;
+        const char* isEnabledKey;
+        const char* valueKey;
+    };
+    for (const NestedSetting& setting : {
+             NestedSetting{"max_per_stream_setting", "is_max_per_stream_enabled", "max_per_stream"},
+             NestedSetting{
+                 "max_per_user_per_stream_setting", "is_max_per_user_per_stream_enabled", "max_per_user_per_stream"
+             },
+             NestedSetting{"global_cooldown_setting", "is_global_cooldown_enabled", "global_cooldown_seconds"},
+         }) {
+        json::object& rewardSetting = reward[setting.settingKey].as_object();
+        if (const json::value* isEnabled = update.if_contains(setting.isEnabledKey)) {
+            rewardSetting["is_enabled"] = *isEnabled;
+        }
+        if (const json::value* value = update.if_contains(setting.valueKey)) {
+            rewardSetting[setting.valueKey] = *value;
+        }
+    }
+}
+
+json::object MockTwitchServer::makeSubscription(const EventsubSession& session) {
+    return json::object{
+        {"id", session.subscriptionId},
+        {"status", "enabled"},
+        {"type", CHANNEL_POINTS_SUBSCRIPTION_TYPE},
+        {"version", "1"},
+        {"cost", 0},
+        {"condition", {{"broadcaster_user_id", userId}, {"reward_id", ""}}},
+        {"transport", {{"method", "websocket"}, {"session_id", session.id}}},
+        {"created_at", formatTimestamp(std::chrono::system_clock::now())},
+    };
+}
+
+std::string MockTwitchServer::generateId() {
+    // Formatted like a version 4 UUID.
+    std::uint64_t high = randomEngine();
+    std::uint64_t low = randomEngine();
+    return fmt::format(
+        "{:08x}-{:04x}-4{:03x}-{:04x}-{:012x}",
+        high >> 32,
+        (high >> 16) & 0xffff,
+        high & 0xfff,
+        ((low >> 48) & 0x3fff) | 0x8000,
+        low & 0xffffffffffff
+    );
+}
+
+std::string MockTwitchServer::formatTimestamp(std::chrono::system_clock::time_point time) {
+    auto seconds = std::chrono::floor<std::chrono::seconds>(time);
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(time - seconds).count();
+    return fmt::format("{:%Y-%m-%dT%H:%M:%S}.{:09}Z", seconds, nanoseconds);
+}
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#pragma once
+
+#include <boost/json.hpp>
+#include <boost/url.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "BoostAsio.h"
+
+struct MockTwitchServerOptions {
+    unsigned short port = 8443;
+    std::string certificateFile;
+    std::string privateKeyFile;
+
+    /// Every Helix response is delayed by latency plus a uniformly distributed value in [0, latencyJitter].
+    std::chrono::milliseconds latency{0};
+    std::chrono::milliseconds latencyJitter{0};
+    /// The fraction of Helix requests that are answered with 500 Internal Server Error.
+    double errorRate = 0;
+    /// The fraction of Helix requests that are answered with 429 Too Many Requests.
+    double rateLimitRate = 0;
+
+    /// The mean number of redemptions per second. The redemptions arrive as a Poisson process.
+    double redemptionsPerSecond = 1;
+    /// The mean number of bursts per minute. The bursts arrive as a Poisson process too, and the number of
+    /// redemptions in a burst is Poisson-distributed with the mean meanBurstSize.
+    double burstsPerMinute = 0;
+    double meanBurstSize = 20;
+    int rewardCount = 5;
+
+    int keepaliveTimeoutSeconds = 10;
+    /// If set, every EventSub session is asked to reconnect after this time.
+    std::optional<std::chrono::seconds> reconnectAfter;
+    /// If set, the subscription of every EventSub session is revoked after this time.
+    std::optional<std::chrono::seconds> revokeAfter;
+};
+
+/// A local stand-in for Twitch, for load testing the plugin offline. Serves the Helix endpoints that the plugin calls
+/// and the EventSub websocket on one TLS port, and generates channel points redemptions.
+///
+/// Everything runs on one thread, so the state isn't locked.
+class MockTwitchServer {
+public:
+    MockTwitchServer(boost::asio::io_context& ioContext, MockTwitchServerOptions options);
+    ~MockTwitchServer();
+
+    void start();
+
+private:
+    using SslStream = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
+    using WebsocketStream = boost::beast::websocket::stream<SslStream>;
+    using Request = boost::beast::http::request<boost::beast::http::string_body>;
+    using Response = boost::beast::http::response<boost::beast::http::string_body>;
+
+    struct EventsubSession {
+        EventsubSession(boost::asio::io_context& ioContext, std::string id);
+
+        std::string id;
+        std::chrono::steady_clock::time_point connectedAt;
+        bool subscribed = false;
+        std::string subscriptionId;
+        /// Set after session_reconnect is sent. No notifications are sent to the session after that.
+        bool reconnecting = false;
+        std::deque<std::string> outgoingMessages;
+        /// Cancelled when a message is added to outgoingMessages, like a condition variable.
+        boost::asio::steady_timer outgoingMessagesCondVar;
+    };
+
+    struct Stats {
+        std::uint64_t helixRequests = 0;
+        std::uint64_t injectedErrors = 0;
+        std::uint64_t injectedRateLimits = 0;
+        std::uint64_t redemptionsGenerated = 0;
+        std::uint64_t notificationsSent = 0;
+        std::uint64_t redemptionsFulfilled = 0;
+        std::uint64_t redemptionsCanceled = 0;
+        std::uint64_t sessionsOpened = 0;
+    };
+
+    boost::asio::awaitable<void> asyncAccept();
+    boost::asio::awaitable<void> asyncHandleConnection(boost::asio::ip::tcp::socket socket);
+
+    boost::asio::awaitable<Response> asyncHandleHelixRequest(const Request& request);
+    Response handleHelixRequest(const Request& request);
+    Response handleAuthorize(const boost::urls::url_view& url);
+    Response handleValidateToken();
+    Response handleGetUsers();
+    Response handleGetRewards(const boost::urls::url_view& url);
+    Response handleCreateReward(const boost::json::object& body);
+    Response handleUpdateReward(const boost::urls::url_view& url, const boost::json::object& body);
+    Response handleDeleteReward(const boost::urls::url_view& url);
+    Response handleUpdateRedemptionStatus(const boost::urls::url_view& url, const boost::json::object& body);
+    Response handleCreateSubscription(const boost::json::object& body);
+    Response makeJsonResponse(boost::beast::http::status status, const boost::json::value& body);
+    Response makeErrorResponse(boost::beast::http::status status, const std::string& message);
+
+    boost::asio::awaitable<void> asyncHandleWebsocket(SslStream stream, Request request);
+    boost::asio::awaitable<void> asyncReadUntilClosed(WebsocketStream& ws);
+    boost::asio::awaitable<void> asyncWriteSessionMessages(
+        WebsocketStream& ws,
+        std::shared_ptr<EventsubSession> session
+    );
+    void sendMessage(EventsubSession& session, const std::string& messageType, boost::json::object payload);
+
+    boost::asio::awaitable<void> asyncGenerateRedemptions();
+    boost::asio::awaitable<void> asyncGenerateBursts();
+    void generateRedemption();
+    boost::asio::awaitable<void> asyncLogStatsForever();
+
+    void addReward(boost::json::object reward);
+    boost::json::object makeReward(const std::string& title, std::int64_t cost);
+    static void applyRewardUpdate(boost::json::object& reward, const boost::json::object& update);
+    boost::json::object makeSubscription(const EventsubSession& session);
+    std::string generateId();
+    static std::string formatTimestamp(std::chrono::system_clock::time_point time);
+
+    boost::asio::io_context& ioContext;
+    MockTwitchServerOptions options;
+    boost::asio::ssl::context sslContext;
+    boost::asio::ip::tcp::acceptor acceptor;
+    std::mt19937_64 randomEngine;
+
+    const std::string userId;
+    const std::string userLogin;
+    // Rewards by id. std::map, so that GET returns them in a stable order.
+    std::map<std::string, boost::json::object> rewards;
+    std::map<std::string, std::shared_ptr<EventsubSession>> sessions;
+
+    // The rate limit bucket, refilled every minute like on Twitch.
+    int rateLimitRemaining;
+    std::chrono::system_clock::time_point rateLimitResetTime;
+
+    Stats stats;
+};
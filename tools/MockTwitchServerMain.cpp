@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: GPL-3.0-only
+// Copyright (c) 2026, Lev Leontev
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "BoostAsio.h"
+#include "Log.h"
+#include "MockTwitchServer.h"
+
+static const char* const USAGE = R"(Usage: rewards-theater-mock-twitch --cert <cert.pem> --key <key.pem> [options]
+
+Options:
+  --port <port>                   The port for HTTPS and EventSub (default: 8443)
+  --latency-ms <ms>               Delay of every Helix response (default: 0)
+  --latency-jitter-ms <ms>        Extra random delay of up to this value (default: 0)
+  --error-rate <fraction>         Fraction of Helix requests failing with 500 (default: 0)
+  --rate-limit-rate <fraction>    Fraction of Helix requests failing with 429 (default: 0)
+  --redemptions-per-second <n>    Mean rate of the redemptions (default: 1)
+  --bursts-per-minute <n>         Mean rate of the bursts of redemptions (default: 0)
+  --mean-burst-size <n>           Mean number of redemptions in a burst (default: 20)
+  --rewards <n>                   Number of rewards on the channel at startup (default: 5)
+  --keepalive-timeout <seconds>   keepalive_timeout_seconds of the sessions (default: 10)
+  --reconnect-after <seconds>     Send session_reconnect this long after a session connects
+  --revoke-after <seconds>        Revoke the subscription this long after a session connects
+  --verbose                       Also log every connection
+)";
+
+static bool verbose = false;
+
+void logMessage(int logLevel, const std::string& message) {
+    if (logLevel <= LOG_INFO || verbose) {
+        std::cerr << "[MockTwitch] " << message << std::endl;
+    }
+}
+
+static MockTwitchServerOptions parseOptions(int argc, char** argv) {
+    MockTwitchServerOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string_view name = argv[i];
+        if (name == "--help") {
+            std::cout << USAGE;
+            std::exit(EXIT_SUCCESS);
+        }
+        if (name == "--verbose") {
+            verbose = true;
+            continue;
+        }
+        if (i + 1 == argc) {
+            throw std::invalid_argument(std::string("Missing the value of ") + argv[i]);
+        }
+        std::string value = argv[++i];
+        if (name == "--cert") {
+            options.certificateFile = value;
+        } else if (name == "--key") {
+            options.privateKeyFile = value;
+        } else if (name == "--port") {
+            options.port = static_cast<unsigned short>(std::stoi(value));
+        } else if (name == "--latency-ms") {
+            options.latency = std::chrono::milliseconds(std::stoll(value));
+        } else if (name == "--latency-jitter-ms") {
+            options.latencyJitter = std::chrono::milliseconds(std::stoll(value));
+        } else if (name == "--error-rate") {
+            options.errorRate = std::stod(value);
+        } else if (name == "--rate-limit-rate") {
+            options.rateLimitRate = std::stod(value);
+        } else if (name == "--redemptions-per-second") {
+            options.redemptionsPerSecond = std::stod(value);
+        } else if (name == "--bursts-per-minute") {
+            options.burstsPerMinute = std::stod(value);
+        } else if (name == "--mean-burst-size") {
+            options.meanBurstSize = std::stod(value);
+        } else if (name == "--rewards") {
+            options.rewardCount = std::stoi(value);
+        } else if (name == "--keepalive-timeout") {
+            options.keepaliveTimeoutSeconds = std::stoi(value);
+        } else if (name == "--reconnect-after") {
+            options.reconnectAfter = std::chrono::seconds(std::stoll(value));
+        } else if (name == "--revoke-after") {
+            options.revokeAfter = std::chrono::seconds(std::stoll(value));
+        } else {
+            throw std::invalid_argument(std::string("Unknown option ") + std::string(name));
+        }
+    }
+    if (options.certificateFile.empty() || options.privateKeyFile.empty()) {
+        throw std::invalid_argument("--cert and --key are required");
+    }
+    return options;
+}
+
+int main(int argc, char** argv) {
+    MockTwitchServerOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n\n" << USAGE;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        boost::asio::io_context ioContext;
+        MockTwitchServer server(ioContext, options);
+        server.start();
+        boost::asio::signal_set signals(ioContext, SIGINT, SIGTERM);
+        signals.async_wait([&ioContext](const boost::system::error_code&, int) {
+            ioContext.stop();
+        });
+        ioContext.run();
+    } catch (const std::exception& e) {
+        log(LOG_ERROR, "Exception in main: {}", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}